@@ -188,14 +188,14 @@ ArgMatches Args::matches(int argc, const char *argv[]) {
                     std::string_view long_name = arg.substr(2, eq - 2);
                     auto const&& opt_found = root
                         .find_arg([long_name](Arg const& a) { return a.long_name == long_name; })
-                        .unwrap_except(std::runtime_error{fmt::format("Unknown command-line option {}", std::string{long_name})});
+                        .unwrap_or_else_throw([&]() { return std::runtime_error{fmt::format("Unknown command-line option {}", std::string{long_name})}; });
                     opt.emplace(opt_found);
                     optarg = arg.substr(eq + 1);
                 } else {
                     std::string_view long_name = arg.substr(2);
                     auto const&& opt_found = root
                         .find_arg([long_name](Arg const& a) { return a.long_name == long_name; })
-                        .unwrap_except(std::runtime_error{fmt::format("Unknown command-line option {}", std::string{long_name})});
+                        .unwrap_or_else_throw([&]() { return std::runtime_error{fmt::format("Unknown command-line option {}", std::string{long_name})}; });
                     if(opt_found.first.takes_arg) {
                         if(i + 1 < argc) {
                             i += 1;
@@ -217,7 +217,7 @@ ArgMatches Args::matches(int argc, const char *argv[]) {
                         return name == first;
                     }).unwrap_or(false);
                 })
-                .unwrap_except(std::runtime_error{fmt::format("Short command-line option {} not found", first)});
+                .unwrap_or_else_throw([&]() { return std::runtime_error{fmt::format("Short command-line option {} not found", first)}; });
 
                 if(opt.first.takes_arg) {
                     if(arg.length() > 2) {
@@ -233,7 +233,7 @@ ArgMatches Args::matches(int argc, const char *argv[]) {
                 for(char opt_flag : arg.substr(1)) {
                     auto flag = root
                         .find_arg([opt_flag](Arg const& a){ return a.short_name  == opt_flag;})
-                        .unwrap_except(std::runtime_error{fmt::format("Unknown short command-line option {}", opt_flag)});
+                        .unwrap_or_else_throw([&]() { return std::runtime_error{fmt::format("Unknown short command-line option {}", opt_flag)}; });
                     root.add_opt(flag.second, ArgMatch{});
                 }
             }
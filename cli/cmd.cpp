@@ -86,50 +86,31 @@ int BomCommand::run(BoardGraph &graph, const ArgMatches &args) {
 
     Map<Ref<Component>, PurchasedData> components{};
     Map<Ref<Connector>, PurchasedData> connectors{};
+    components.reserve(graph.component_counts().size());
+    connectors.reserve(graph.connector_counts().size());
     Optional<PriceRange> connector_price_range;
     Optional<PriceRange> component_price_range;
     bool all_component_purchasedata = true;
     bool all_connector_purchasedata = true;
-    std::for_each(
-        graph.nodes().begin(),
-        graph.nodes().end(),
-        [&](auto const& elem) mutable {
-            const auto& [_, node] = elem;
-            auto existing = components.find(node->type());
-            if(existing != components.end()) {
-                existing->second.num += 1;
-            } else {
-                components.emplace(
-                    node->type(),
-                    PurchasedData {
-                        .price_range = node->type()->purchase_data().map(get_range).flatten(),
-                        .num = 1
-                    }
-                );
+    //The graph keeps a live count of every placed type, so only distinct types are visited here
+    for(const auto& [component, num] : graph.component_counts()) {
+        components.emplace(
+            component,
+            PurchasedData {
+                .price_range = component->purchase_data().map(get_range).flatten(),
+                .num = num
             }
-        }
-    );
-    std::for_each(
-        graph.edges().begin(),
-        graph.edges().end(),
-        [&](auto const& elem) mutable {
-            const auto& [_, edge] = elem;
-            for(const auto& side : edge->connections()) {
-                auto existing = connectors.find(side.connector());
-                if(existing != connectors.end()) {
-                    existing->second.num += 1;
-                } else {
-                    connectors.emplace(
-                        side.connector(),
-                        PurchasedData {
-                            .price_range = side.connector()->purchase_data().map(get_range).flatten(),
-                            .num = 1
-                        }
-                    );
-                }
+        );
+    }
+    for(const auto& [connector, num] : graph.connector_counts()) {
+        connectors.emplace(
+            connector,
+            PurchasedData {
+                .price_range = connector->purchase_data().map(get_range).flatten(),
+                .num = num
             }
-        }
-    );
+        );
+    }
 
     std::for_each(
         components.begin(),
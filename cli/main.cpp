@@ -1,6 +1,7 @@
 
 #define DOCTEST_CONFIG_IMPLEMENT
 #include <iostream>
+#include <boardfile.hpp>
 #include <lib.hpp>
 #include <util/log.hpp>
 
@@ -37,7 +38,22 @@ int main(int argc, const char* argv[]) {
         .arg_name{"file"},
         .short_name{'i'},
         .long_name{"input"},
-        .short_help{"Specify a path to an input file containing electrical board JSON data"}
+        .short_help{"Specify a path to an input file containing electrical board JSON or binary data"}
+    });
+
+    auto output_file_opt = args.arg(Arg {
+        .takes_arg = true,
+        .arg_name{"file"},
+        .short_name{'o'},
+        .long_name{"output"},
+        .short_help{"Write the board to a file, in the binary format if it ends in .e1280b and as JSON otherwise"}
+    });
+
+    auto compact_flag = args.arg(Arg {
+        .takes_arg = false,
+        .short_name{'c'},
+        .long_name{"compact"},
+        .short_help{"Write the JSON output file without any whitespace instead of pretty printing it, requires a JSON --output file"}
     });
     
     try {
@@ -56,8 +72,15 @@ int main(int argc, const char* argv[]) {
         auto input_file = matches
             .get_arg(input_file_opt)
             .unwrap_except(std::runtime_error{"No input file given"});
+        auto output_file = matches.get_arg(output_file_opt);
+        if(matches.has(compact_flag) && (!output_file.has_value() || boardfile::is_binary(std::filesystem::path{output_file.unwrap()}))) {
+            throw std::runtime_error{"The --compact flag only applies when writing JSON to a file given with --output"};
+        }
 
         BoardGraph graph{input_file, false, false};
+        if(output_file.has_value()) {
+            graph.save(output_file.unwrap(), matches.has(compact_flag));
+        }
     } catch(const std::exception& e) {
         fmt::print(fmt::emphasis::bold | fmt::fg(fmt::color::red), "Error: ");
         fmt::print("{}\n", e.what());
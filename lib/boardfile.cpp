@@ -0,0 +1,368 @@
+#include "boardfile.hpp"
+#include "lib.hpp"
+#include "wire.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+
+#include <doctest.h>
+
+#include "testing.hpp"
+
+namespace boardfile {
+
+namespace {
+
+/** \brief Offsets of every section are rounded up to this so that the tables can be read in place */
+constexpr const std::size_t ALIGN = 8;
+
+constexpr inline std::size_t align(std::size_t pos) noexcept { return (pos + ALIGN - 1) & ~(ALIGN - 1); }
+
+/** \brief Get a section of the file as a table of records, checking that it lies inside the file */
+template<typename T>
+std::span<const T> section(std::span<const std::byte> bytes, std::uint64_t offset, std::uint64_t len, const char *name) {
+    if(offset % alignof(T) != 0 || offset > bytes.size() || len > (bytes.size() - offset) / sizeof(T)) {
+        throw std::runtime_error{fmt::format("The {} section of the board file is out of bounds", name)};
+    }
+    return std::span<const T>{reinterpret_cast<const T*>(bytes.data() + offset), static_cast<std::size_t>(len)};
+}
+
+/** \brief Check if a normalized length read from a file is finite and fits in a coordinate of this build */
+inline bool in_range(Length::Raw val) noexcept {
+    if(!std::isfinite(val)) {
+        return false;
+    }
+    if constexpr(BuildOpts::fixed_coords) {
+        return std::abs(static_cast<double>(val) * coord::PER_UNIT) < static_cast<double>(std::numeric_limits<std::int32_t>::max());
+    }
+    return true;
+}
+
+/** \throws std::runtime_error if a position has a display unit that does not exist or a coordinate out of range */
+void check(PackedPoint const& pos, const char *what) {
+    if(pos.x_unit >= LengthUnit::NUM || pos.y_unit >= LengthUnit::NUM) {
+        throw std::runtime_error{fmt::format("The position of {} in the board file has an unknown unit", what)};
+    }
+    if(!in_range(pos.x) || !in_range(pos.y)) {
+        throw std::runtime_error{fmt::format("The position of {} in the board file is out of range", what)};
+    }
+}
+
+/** \brief Convert a coordinate stored by a build with the other coordinate mode to this build's mode */
+inline Coord convert(Coord stored) noexcept {
+    if constexpr(BuildOpts::fixed_coords) {
+        return coord::from_normalized(std::bit_cast<Length::Raw>(stored));
+    } else {
+        return static_cast<Length::Raw>(static_cast<double>(std::bit_cast<std::int32_t>(stored)) / 1e6);
+    }
+}
+
+}
+
+bool is_binary(std::span<const std::byte> bytes) noexcept {
+    return bytes.size() >= MAGIC.size() && std::memcmp(bytes.data(), MAGIC.data(), MAGIC.size()) == 0;
+}
+
+View::View(std::span<const std::byte> bytes) {
+    if(!is_binary(bytes) || bytes.size() < sizeof(Header)) {
+        throw std::runtime_error{"Not a binary board file"};
+    }
+    if(reinterpret_cast<std::uintptr_t>(bytes.data()) % ALIGN != 0) {
+        throw std::runtime_error{"Binary board files must be read from an aligned buffer"};
+    }
+
+    Header header{};
+    std::memcpy(&header, bytes.data(), sizeof(Header));
+    if(header.byte_order != ENDIAN_CHECK) {
+        throw std::runtime_error{"The board file was written on a machine with a different byte order"};
+    }
+    if(header.version != VERSION) {
+        throw std::runtime_error{fmt::format(
+            "The board file is version {}, but only version {} can be read",
+            header.version,
+            VERSION
+        )};
+    }
+
+    this->m_nodes = section<Node>(bytes, header.nodes_offset, header.nodes_len, "node");
+    this->m_edges = section<Edge>(bytes, header.edges_offset, header.edges_len, "edge");
+    this->m_points = section<RawPoint>(bytes, header.points_offset, header.points_len, "point");
+    const std::span<const char> strings = section<char>(bytes, header.strings_offset, header.strings_len, "string");
+    this->m_strings = std::string_view{strings.data(), strings.size()};
+
+    //Units index conversion tables and fixed coordinates are converted with a cast, so every value is checked
+    //here before anything reads it
+    for(const Node& node : this->m_nodes) {
+        check(node.pos, "a node");
+    }
+    for(const Edge& edge : this->m_edges) {
+        check(edge.ends[0].pos, "a wire end");
+        check(edge.ends[1].pos, "a wire end");
+    }
+    if(!header.fixed_coords) {
+        for(const RawPoint& pt : this->m_points) {
+            if(!in_range(std::bit_cast<Length::Raw>(pt.x)) || !in_range(std::bit_cast<Length::Raw>(pt.y))) {
+                throw std::runtime_error{"A wire point in the board file is out of range"};
+            }
+        }
+    }
+
+    if(static_cast<bool>(header.fixed_coords) != BuildOpts::fixed_coords) {
+        this->m_converted.reserve(this->m_points.size());
+        for(const RawPoint& pt : this->m_points) {
+            this->m_converted.push_back(RawPoint{convert(pt.x), convert(pt.y)});
+        }
+        this->m_points = this->m_converted;
+    }
+}
+
+std::string_view View::str(Str ref) const {
+    if(ref.offset > this->m_strings.size() || ref.len > this->m_strings.size() - ref.offset) {
+        throw std::runtime_error{"A string in the board file is out of bounds"};
+    }
+    return this->m_strings.substr(ref.offset, ref.len);
+}
+
+std::span<const RawPoint> View::points(Edge const& edge) const {
+    if(edge.points_begin > this->m_points.size() || edge.points_len > this->m_points.size() - edge.points_begin) {
+        throw std::runtime_error{"The points of a wire in the board file are out of bounds"};
+    }
+    return this->m_points.subspan(edge.points_begin, edge.points_len);
+}
+
+}
+
+void BoardGraph::from_binary(BoardGraph& self, std::span<const std::byte> bytes) {
+    const boardfile::View view{bytes};
+
+    //Descriptions refer to strings and points in the file itself, which are only copied when the batch is inserted
+    std::vector<NodeDesc> nodes{};
+    nodes.reserve(view.nodes().size());
+    for(const boardfile::Node& node : view.nodes()) {
+        nodes.push_back(NodeDesc{
+            .id = view.str(node.id),
+            .type = view.str(node.type),
+            .pos = node.pos.unpack(),
+            .name = view.str(node.name),
+        });
+    }
+
+    std::vector<EdgeDesc> edges{};
+    edges.reserve(view.edges().size());
+    for(const boardfile::Edge& edge : view.edges()) {
+        EdgeDesc desc{.id = view.str(edge.id), .ends{}, .points = view.points(edge)};
+        for(std::size_t side = 0; side < 2; ++side) {
+            const boardfile::End& end = edge.ends[side];
+            desc.ends[side] = EdgeDesc::End{
+                .connector = view.str(end.connector),
+                .node = view.str(end.node),
+                .port = view.str(end.port),
+                .pos = end.pos.unpack(),
+            };
+        }
+        edges.push_back(desc);
+    }
+
+    self.insert(nodes, edges);
+}
+
+std::vector<std::byte> BoardGraph::to_binary() const {
+    using namespace boardfile;
+
+    std::string strings{};
+    std::unordered_map<std::string_view, Str> interned{};
+    //Views into the graph's symbols and resources, which outlive the writer
+    const auto intern = [&strings, &interned](std::string_view str) {
+        if(str.empty()) {
+            return Str{0, 0};
+        }
+        const auto [entry, added] = interned.try_emplace(str, Str{static_cast<std::uint32_t>(strings.size()), static_cast<std::uint32_t>(str.size())});
+        if(added) {
+            strings.append(str);
+            if(strings.size() > std::numeric_limits<std::uint32_t>::max()) {
+                throw std::length_error{"Too many strings to write to a binary board file"};
+            }
+        }
+        return entry->second;
+    };
+
+    const auto& nodes_store = std::as_const(this->m_storage->nodes);
+    const auto& edges_store = std::as_const(this->m_storage->edges);
+
+    std::vector<Node> nodes{};
+    nodes.reserve(nodes_store.size());
+    for(const ComponentNode& node : nodes_store) {
+        nodes.push_back(Node{
+            .id = intern(node.id()),
+            .type = intern(node.type()->id()),
+            .name = intern(node.name()),
+            .pos = PackedPoint::pack(node.pos()),
+        });
+    }
+
+    std::vector<Edge> edges{};
+    std::vector<RawPoint> points{};
+    edges.reserve(edges_store.size());
+    for(const WireEdge& edge : edges_store) {
+        Edge record{};
+        record.id = intern(edge.id());
+        for(std::size_t side = 0; side < 2; ++side) {
+            const WireEdge::Connection& conn = edge.connections()[side];
+            End& end = record.ends[side];
+            end.connector = intern(conn.connector()->id());
+            end.pos = PackedPoint::pack(conn.pos());
+            if(!conn.is_floating()) {
+                const ComponentNode& node = *nodes_store.get(conn.m_node);
+                end.node = intern(node.id());
+                end.port = intern(node.type()->get_port(conn.m_port).unwrap_unchecked().get().id());
+            }
+        }
+        const std::span<const RawPoint> pts = edge.points();
+        record.points_begin = static_cast<std::uint32_t>(points.size());
+        record.points_len = static_cast<std::uint32_t>(pts.size());
+        points.insert(points.end(), pts.begin(), pts.end());
+        edges.push_back(record);
+    }
+    if(points.size() > std::numeric_limits<std::uint32_t>::max()) {
+        throw std::length_error{"Too many wire points to write to a binary board file"};
+    }
+
+    Header header{
+        .magic = MAGIC,
+        .version = VERSION,
+        .byte_order = ENDIAN_CHECK,
+        .fixed_coords = BuildOpts::fixed_coords,
+        .pad{},
+        .nodes_offset = align(sizeof(Header)),
+        .nodes_len = nodes.size(),
+        .edges_offset = 0,
+        .edges_len = edges.size(),
+        .points_offset = 0,
+        .points_len = points.size(),
+        .strings_offset = 0,
+        .strings_len = strings.size(),
+    };
+    header.edges_offset = align(header.nodes_offset + nodes.size() * sizeof(Node));
+    header.points_offset = align(header.edges_offset + edges.size() * sizeof(Edge));
+    header.strings_offset = align(header.points_offset + points.size() * sizeof(RawPoint));
+
+    std::vector<std::byte> out(header.strings_offset + strings.size(), std::byte{0});
+    const auto copy = [&out](std::uint64_t offset, const void *data, std::size_t len) {
+        if(len != 0) {
+            std::memcpy(out.data() + offset, data, len);
+        }
+    };
+    copy(0, &header, sizeof(Header));
+    copy(header.nodes_offset, nodes.data(), nodes.size() * sizeof(Node));
+    copy(header.edges_offset, edges.data(), edges.size() * sizeof(Edge));
+    copy(header.points_offset, points.data(), points.size() * sizeof(RawPoint));
+    copy(header.strings_offset, strings.data(), strings.size());
+    return out;
+}
+
+void BoardGraph::save(std::filesystem::path const& path, bool compact) const {
+    //The board is written to a sibling file that replaces the save only once it is complete, so a failure in either
+    //format leaves an existing save untouched
+    std::filesystem::path temp = path;
+    temp += ".tmp";
+    try {
+        const bool binary = boardfile::is_binary(path);
+        std::ofstream file{temp, binary ? std::ios::out | std::ios::binary : std::ios::out};
+        if(!file.is_open()) {
+            throw std::runtime_error{fmt::format("Failed to open {} to save the board graph", temp.string())};
+        }
+        if(binary) {
+            const std::vector<std::byte> bytes = this->to_binary();
+            file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        } else {
+            this->write_json(file, compact);
+        }
+        file.close();
+        if(file.fail()) {
+            throw std::runtime_error{fmt::format("Failed to write the board graph to {}", temp.string())};
+        }
+        std::filesystem::rename(temp, path);
+    } catch(...) {
+        std::error_code err{};
+        std::filesystem::remove(temp, err);
+        throw;
+    }
+}
+
+TEST_CASE("boardfile") {
+    using namespace boardfile;
+
+    const testing::AssetDir assets{};
+    const BoardGraph graph = testing::asset_board();
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "boardfile_test.e1280b";
+    graph.save(path);
+    {
+        const BoardGraph loaded{std::filesystem::path{path}, false, false};
+        CHECK_EQ(loaded.to_json(), graph.to_json());
+    }
+    std::filesystem::remove(path);
+
+    //Saving into a directory that does not exist fails to open the file in either format
+    const std::filesystem::path missing = std::filesystem::temp_directory_path() / "boardfile_test_missing" / "board";
+    CHECK_THROWS_AS(graph.save(std::filesystem::path{missing}.replace_extension(EXTENSION)), std::runtime_error);
+    CHECK_THROWS_AS(graph.save(std::filesystem::path{missing}.replace_extension(".json")), std::runtime_error);
+
+    //A save that fails part way through the JSON leaves the previous save in place
+    {
+        const std::filesystem::path json_path = std::filesystem::temp_directory_path() / "boardfile_test.json";
+        graph.save(json_path);
+        BoardGraph unsaveable = testing::asset_board();
+        unsaveable.component(unsaveable.resources().try_get<Component>("1280.bus"), "boardfile.invalid", Point{}, "\xff");
+        CHECK_THROWS_AS(unsaveable.save(json_path), std::runtime_error);
+        CHECK_FALSE(std::filesystem::exists(std::filesystem::path{json_path} += ".tmp"));
+        const BoardGraph kept{std::filesystem::path{json_path}, false, false};
+        CHECK_EQ(kept.to_json(), graph.to_json());
+        std::filesystem::remove(json_path);
+    }
+
+    const std::vector<std::byte> bytes = graph.to_binary();
+    Header header{};
+    std::memcpy(&header, bytes.data(), sizeof(Header));
+    REQUIRE_EQ(header.nodes_len, 2);
+    //A copy of the file with its header or first node record changed
+    const auto patched = [&bytes, &header](auto edit) {
+        std::vector<std::byte> copy = bytes;
+        Header h = header;
+        Node node{};
+        std::memcpy(&node, copy.data() + header.nodes_offset, sizeof(Node));
+        edit(h, node);
+        std::memcpy(copy.data(), &h, sizeof(Header));
+        std::memcpy(copy.data() + header.nodes_offset, &node, sizeof(Node));
+        return copy;
+    };
+    const auto rejected = [](std::vector<std::byte> const& file) {
+        try {
+            const View view{file};
+        } catch(const std::runtime_error&) {
+            return true;
+        }
+        return false;
+    };
+
+    CHECK_FALSE(rejected(bytes));
+    CHECK(rejected(patched([](Header& h, Node&) { h.magic[0] = 'X'; })));
+    CHECK(rejected(patched([](Header& h, Node&) { h.version = VERSION + 1; })));
+    CHECK(rejected(patched([](Header& h, Node&) { h.byte_order = 0x04030201; })));
+    CHECK(rejected(std::vector<std::byte>{bytes.begin(), bytes.end() - 1}));
+    CHECK(rejected(patched([](Header& h, Node&) { h.edges_len += 1; })));
+    CHECK(rejected(patched([](Header&, Node& node) { node.pos.x_unit = static_cast<LengthUnit::UnitVal>(LengthUnit::NUM); })));
+    CHECK(rejected(patched([](Header&, Node& node) { node.pos.y = std::numeric_limits<Length::Raw>::quiet_NaN(); })));
+    CHECK(rejected(patched([](Header&, Node& node) { node.pos.x = std::numeric_limits<Length::Raw>::infinity(); })));
+
+    const View view{bytes};
+    CHECK_EQ(view.str(view.nodes()[0].type), "1280.test");
+    CHECK_THROWS_AS(view.str(Str{.offset = static_cast<std::uint32_t>(header.strings_len), .len = 1}), std::runtime_error);
+    CHECK_THROWS_AS(view.str(Str{.offset = 0, .len = std::numeric_limits<std::uint32_t>::max()}), std::runtime_error);
+}
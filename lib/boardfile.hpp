@@ -0,0 +1,139 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "geom.hpp"
+#include "unit.hpp"
+
+/**
+ * \brief Versioned binary save format for board graphs, stored alongside the JSON format.
+ *
+ * A file is a fixed size `Header` followed by four sections, each starting on an 8 byte boundary: a table of
+ * fixed size `Node` records, a table of fixed size `Edge` records, one packed array of the raw points of every
+ * wire, and every distinct string used by the records stored once, end to end. Records refer to strings by
+ * their offset and length in the string section and to wire points by their range in the point array, so a
+ * mapped file can be read in place with only a bounds check for each reference.
+ *
+ * Values are stored in the byte order of the machine that wrote them, which is recorded in the header so that
+ * a file from a machine of the other byte order is rejected instead of misread
+ */
+namespace boardfile {
+
+/** \brief First bytes of every binary board file */
+static constexpr const std::array<char, 8> MAGIC{'E', '1', '2', '8', '0', 'B', 'R', 'D'};
+/** \brief Version of the layout written by this build, bumped whenever any record changes */
+static constexpr const std::uint32_t VERSION = 1;
+/** \brief Written as a native integer to detect files written with a different byte order */
+static constexpr const std::uint32_t ENDIAN_CHECK = 0x01020304;
+/** \brief File extension that board graphs are saved in the binary format under */
+static constexpr const std::string_view EXTENSION = ".e1280b";
+
+/** \brief A string in the string section */
+struct Str {
+    std::uint32_t offset;
+    std::uint32_t len;
+};
+
+struct Node {
+    Str id;
+    /** \brief Resource ID of the node's component type */
+    Str type;
+    Str name;
+    PackedPoint pos;
+};
+
+/** \brief A single end of a wire */
+struct End {
+    /** \brief Resource ID of the end's connector */
+    Str connector;
+    /** \brief ID of the attached node, empty if the end is floating */
+    Str node;
+    /** \brief ID of the attached port on `node` */
+    Str port;
+    /** \brief Position of the end if it is floating */
+    PackedPoint pos;
+};
+
+struct Edge {
+    Str id;
+    /** \brief Both ends of the wire, indexed by `WireEdge::Side` */
+    End ends[2];
+    /** \brief Index of the wire's first point in the point array */
+    std::uint32_t points_begin;
+    std::uint32_t points_len;
+};
+
+struct Header {
+    std::array<char, 8> magic;
+    std::uint32_t version;
+    std::uint32_t byte_order;
+    /** \brief Nonzero if the point array holds fixed point coordinates, see `coord` */
+    std::uint8_t fixed_coords;
+    std::uint8_t pad[7];
+    std::uint64_t nodes_offset;
+    std::uint64_t nodes_len;
+    std::uint64_t edges_offset;
+    std::uint64_t edges_len;
+    std::uint64_t points_offset;
+    std::uint64_t points_len;
+    std::uint64_t strings_offset;
+    std::uint64_t strings_len;
+};
+
+static_assert(sizeof(Node) == 36 && sizeof(Edge) == 88 && sizeof(Header) == 88);
+static_assert(sizeof(RawPoint) == 8, "The point array must have the same layout in both coordinate modes");
+
+/** \brief Check if a buffer starts with the binary format's magic bytes */
+bool is_binary(std::span<const std::byte> bytes) noexcept;
+
+/** \brief Check if a path should be saved in the binary format, going by its extension */
+inline bool is_binary(std::filesystem::path const& path) { return path.extension() == EXTENSION; }
+
+/**
+ * \brief The sections of a binary board file, pointing into the buffer that the file was read or mapped into
+ */
+class View {
+public:
+    /**
+     * \brief Check the header of a binary board file and find its sections
+     * \throws std::runtime_error if the buffer is not a binary board file of this version and byte order, any
+     * section runs past the end of the buffer, or any position or wire point has an unknown display unit or a
+     * coordinate that is not finite or does not fit in this build's coordinates
+     */
+    explicit View(std::span<const std::byte> bytes);
+
+    View(View const&) = delete;
+    View& operator=(View const&) = delete;
+
+    inline std::span<const Node> nodes() const noexcept { return this->m_nodes; }
+    inline std::span<const Edge> edges() const noexcept { return this->m_edges; }
+    /**
+     * \brief Get a string from the string section
+     * \throws std::runtime_error if the string runs past the end of the section
+     */
+    std::string_view str(Str ref) const;
+
+    /**
+     * \brief Get the raw points of a wire in this build's coordinate mode
+     * \throws std::runtime_error if the range runs past the end of the point array
+     */
+    std::span<const RawPoint> points(Edge const& edge) const;
+private:
+    std::span<const Node> m_nodes;
+    std::span<const Edge> m_edges;
+    std::span<const RawPoint> m_points;
+    std::string_view m_strings;
+    /**
+     * \brief The point array converted to this build's coordinate mode when the file was written in the other,
+     * `m_points` points into this array instead of into the file
+     */
+    std::vector<RawPoint> m_converted{};
+};
+
+}
@@ -1,4 +1,3 @@
-#include <algorithm>
 #include <component.hpp>
 #include <exception>
 #include <fstream>
@@ -10,34 +9,20 @@
 
 
 Optional<std::reference_wrapper<const ConnectionPort>> Component::get_port(const std::string_view id) const {
-    const auto& port = std::find_if(
-        this->m_ports.cbegin(),
-        this->m_ports.cend(),
-        [&id](auto const& port) -> bool { return port.id() == id; }
-    );
-    if(port != this->m_ports.cend()) {
-        return std::cref(*port);
-    } else {
-        return Optional<std::reference_wrapper<const ConnectionPort>>{};
-    }
+    return this
+        ->get_port_idx(id)
+        .map([this](ConnectionPortIdx idx) { return std::cref(this->m_ports.at(idx)); });
 }
 
 Optional<ConnectionPortIdx> Component::get_port_idx(const std::string_view id) const {
-    const auto& port = std::find_if(
-        this->m_ports.cbegin(),
-        this->m_ports.cend(),
-        [&id](auto const& port) { return port.id() == id; }
-    );
-    if(port != this->m_ports.end()) {
-        return port.index();
-    } else {
-        return {};
-    }
+    return Symbol::find(id)
+        .map([this](Symbol sym) { return this->get_port_idx(sym); })
+        .flatten();
 }
 
 std::filesystem::path ComponentLoader::DIR = "./assets/components";
 
-Ref<Component> ComponentLoader::load(std::string_view id, const json &json_val, LazyResourceStore &store) {
+Ref<Component> ComponentLoader::load(Symbol id, const json &json_val, LazyResourceStore &store) {
     (void)store;
     Ref<Component> component{new Component{}};
     component->m_id = id;
@@ -50,12 +35,37 @@ Ref<Component> ComponentLoader::load(std::string_view id, const json &json_val,
     if(json_val.contains("purchase")) {
         json_val.at("purchase").get_to<Optional<PurchaseData>>(component->m_purchasedata);
     }
+    std::vector<std::pair<Symbol, ConnectionPortIdx>> port_ids{};
     for(const auto& [port_id, port_json] : json_val.at("ports").items()) {
         auto elem = component->m_ports.emplace(ConnectionPort{});
             
         port_json.at("name").get_to<std::string>(component->m_ports[elem].m_name);
         port_json.at("pos").get_to<Point>(component->m_ports[elem].m_pt);
-        component->m_ports[elem].m_id = port_id;
+        component->m_ports[elem].m_id = Symbol::intern(port_id);
+        port_ids.emplace_back(component->m_ports[elem].m_id, elem);
+    }
+    component->m_port_index = SymbolMap<ConnectionPortIdx>{port_ids};
+
+    component->m_port_bus.assign(component->m_ports.slots(), Component::NO_BUS);
+    if(json_val.contains("buses")) {
+        for(const auto& bus_json : json_val.at("buses")) {
+            std::vector<ConnectionPortIdx> bus{};
+            for(const auto& port_json : bus_json) {
+                const std::string_view port_id = port_json.get<std::string_view>();
+                const ConnectionPortIdx port = component->get_port_idx(port_id).unwrap_or_else_throw([&]() {
+                    return std::runtime_error{fmt::format("Bus of component {} refers to nonexistent port {}", id.str(), port_id)};
+                });
+                if(component->m_port_bus[port] != Component::NO_BUS) {
+                    throw std::runtime_error{fmt::format("Port {} of component {} belongs to more than one bus", port_id, id.str())};
+                }
+                component->m_port_bus[port] = static_cast<std::uint32_t>(component->m_buses.size());
+                bus.push_back(port);
+            }
+            if(bus.size() < 2) {
+                throw std::runtime_error{fmt::format("Bus of component {} must join at least two ports", id.str())};
+            }
+            component->m_buses.push_back(std::move(bus));
+        }
     }
 
     return component;
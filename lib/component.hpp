@@ -3,7 +3,9 @@
 #include <filesystem>
 #include <fstream>
 #include <functional>
+#include <limits>
 #include <optional>
+#include <vector>
 
 #include <ser/ser.hpp>
 #include <geom.hpp>
@@ -11,6 +13,7 @@
 #include "ser/store.hpp"
 #include "unit.hpp"
 #include "util/hash.hpp"
+#include "util/symmap.hpp"
 
 
 class Component;
@@ -23,7 +26,9 @@ public:
     /** Get this connection port's name */
     constexpr inline const std::string& name() const { return this->m_name; }
     /** Get this connection port's ID */
-    constexpr inline const std::string& id() const { return this->m_id; }
+    inline const std::string_view id() const { return this->m_id.str(); }
+    /** Get the interned ID of this connection port */
+    constexpr inline Symbol symbol() const noexcept { return this->m_id; }
     /** Get the offset from the component base of this connection port */
     constexpr inline const Point& pos() const { return this->m_pt; }
 
@@ -37,7 +42,7 @@ private:
     /** Name of the port */
     std::string m_name;
     /** Internal ID of this connection port */
-    std::string m_id;
+    Symbol m_id;
     
     friend class ComponentLoader;
     friend class Component;
@@ -57,7 +62,9 @@ public:
     /** Get the name of this component */
     inline const std::string_view name() const { return this->m_name; }
     /** Get the user-assigned ID of this component */
-    inline constexpr const std::string_view id() const { return this->m_id; }
+    inline const std::string_view id() const { return this->m_id.str(); }
+    /** Get the interned ID of this component */
+    inline constexpr Symbol symbol() const noexcept { return this->m_id; }
     /** Get a reference to this component's footprint */
     constexpr inline const Footprint& footprint() const { return this->m_fp; }
     /** Get the mass of this component, if it exists */
@@ -65,27 +72,52 @@ public:
     /** Get a list of places to purchase this component, if any */
     constexpr inline Optional<std::reference_wrapper<PurchaseData const>> purchase_data() const { return this->m_purchasedata; }
 
-    /** Get a port by name, O(1) lookup time */
+    /** Get a port by ID, O(1) lookup time */
     Optional<std::reference_wrapper<const ConnectionPort>> get_port(const std::string_view id) const;
     /** \brief Get the port at the given index into the `FreeList` containing all `ConnectionPort`s */
     inline constexpr Optional<std::reference_wrapper<const ConnectionPort>> get_port(ConnectionPortIdx idx) const {
         return this->m_ports.at(idx);
     }
-    /** Get a port pointer by name */
+    /** Get a port index by ID, O(1) lookup time */
     Optional<ConnectionPortIdx> get_port_idx(const std::string_view id) const;
+    /** Get a port index by interned ID, a single hash table probe */
+    inline Optional<ConnectionPortIdx> get_port_idx(Symbol id) const { return this->m_port_index.find(id); }
     
+    /** \brief Get an exclusive upper bound on the indices of this component's ports */
+    inline constexpr ConnectionPortIdx port_slots() const noexcept { return this->m_ports.slots(); }
+    /**
+     * \brief Get groups of ports that are electrically joined inside this component, like the terminals of a
+     * bus bar, every group contains at least two ports
+     */
+    inline constexpr std::vector<std::vector<ConnectionPortIdx>> const& buses() const noexcept { return this->m_buses; }
+    /** \brief Get the bus that the given port is a member of, if any */
+    inline Optional<std::reference_wrapper<const std::vector<ConnectionPortIdx>>> bus(ConnectionPortIdx port) const {
+        if(port >= this->m_port_bus.size() || this->m_port_bus[port] == NO_BUS) {
+            return {};
+        }
+        return std::cref(this->m_buses[this->m_port_bus[port]]);
+    }
+
     /** \brief Get an iterator over thte ports of this component type */
     FreeList<ConnectionPort>::const_iterator begin() const { return this->m_ports.begin(); }
     FreeList<ConnectionPort>::const_iterator end() const { return this->m_ports.end(); }
 private:
     /* User-facing name of the component type */
     std::string m_name;
-    /* ID string of this component, shared with the SharedResources */
-    std::string_view m_id;
+    /* ID of this component, shared with the SharedResources */
+    Symbol m_id;
     /* 
      * Map of IDs to connection points for this component 
      */
     FreeList<ConnectionPort> m_ports;
+    /** Immutable table of port IDs to indices into `m_ports`, built once when the component type is loaded */
+    SymbolMap<ConnectionPortIdx> m_port_index;
+    /** Groups of ports that are internally connected to each other */
+    std::vector<std::vector<ConnectionPortIdx>> m_buses;
+    /** Index into `m_buses` of the bus that each port belongs to, or `NO_BUS` */
+    std::vector<std::uint32_t> m_port_bus;
+    /** Marker for ports that are not part of any bus */
+    static constexpr const std::uint32_t NO_BUS = std::numeric_limits<std::uint32_t>::max();
     /* Shape of the component in the workspace */ 
     Footprint m_fp;
     /** Mass of the component, if any is given */
@@ -98,11 +130,11 @@ private:
 };
 
 /**
- * Class dedicated to deserializing `Component`s
+ * Class dedicated to deserializing `Component`s, the fields of a component file are listed in the README
  */
 class ComponentLoader : public LazyResourceLoader<Component> {
 public:
-    Ref<Component> load(std::string_view id, const json& json, LazyResourceStore& store) override;
+    Ref<Component> load(Symbol id, const json& json, LazyResourceStore& store) override;
     std::filesystem::path const& dir() const noexcept override { return DIR; }
 private:
     static std::filesystem::path DIR;
@@ -0,0 +1,212 @@
+#include "drc.hpp"
+#include "component.hpp"
+#include "kernel.hpp"
+
+#include <algorithm>
+#include <array>
+#include <thread>
+#include <utility>
+
+#include <doctest.h>
+
+#include "testing.hpp"
+
+namespace drc {
+
+namespace {
+
+using Vec = std::array<float, 2>;
+
+/** \brief Minimum number of candidate pairs given to each worker thread, below this threads cost more than they save */
+constexpr const std::size_t PAIRS_PER_THREAD = 2048;
+
+/** \brief Bounding box of a node in normalized coordinates along with its handle */
+struct Bounds {
+    BoardGraph::NodeHandle node;
+    Vec min;
+    Vec max;
+};
+
+/**
+ * \brief Run `fn(begin, end)` over `count` items split into contiguous ranges across up to `threads` threads, the
+ * calling thread takes the first range
+ */
+template<typename F>
+void parallel(std::size_t count, unsigned threads, F const& fn) {
+    const std::size_t workers = std::max<std::size_t>(1, std::min<std::size_t>(threads, count / PAIRS_PER_THREAD));
+    const std::size_t per = (count + workers - 1) / workers;
+    std::vector<std::thread> pool{};
+    pool.reserve(workers - 1);
+    for(std::size_t w = 1; w < workers; ++w) {
+        pool.emplace_back([&fn, begin = w * per, end = std::min(count, (w + 1) * per)]() { fn(begin, end); });
+    }
+    fn(0, std::min(count, per));
+    for(std::thread& thread : pool) {
+        thread.join();
+    }
+}
+
+}
+
+std::vector<Overlap> overlaps(BoardSnapshot const& board, unsigned threads) {
+    if(threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    const auto& nodes = board.nodes();
+    std::vector<Bounds> bounds{};
+    bounds.reserve(nodes.size());
+    for(auto it = nodes.begin(); it != nodes.end(); ++it) {
+        const AABB& aabb = it->aabb();
+        bounds.push_back(Bounds{
+            .node = it.index(),
+            .min = {coord::to_normalized(aabb.min.x), coord::to_normalized(aabb.min.y)},
+            .max = {coord::to_normalized(aabb.max.x), coord::to_normalized(aabb.max.y)},
+        });
+    }
+    std::sort(bounds.begin(), bounds.end(), [](Bounds const& a, Bounds const& b) { return a.min[0] < b.min[0]; });
+
+    //Every box is compared against the boxes that start before it ends on the x axis
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> candidates{};
+    for(std::uint32_t i = 0; i < bounds.size(); ++i) {
+        for(std::uint32_t j = i + 1; j < bounds.size() && bounds[j].min[0] <= bounds[i].max[0]; ++j) {
+            if(bounds[i].min[1] <= bounds[j].max[1] && bounds[j].min[1] <= bounds[i].max[1]) {
+                candidates.emplace_back(i, j);
+            }
+        }
+    }
+
+    //Outlines are built once up front for every node that is part of a candidate pair
+    std::vector<kernel::Outline> outlines(bounds.size());
+    std::vector<bool> needed(bounds.size(), false);
+    for(const auto& [i, j] : candidates) {
+        needed[i] = true;
+        needed[j] = true;
+    }
+    for(std::uint32_t i = 0; i < bounds.size(); ++i) {
+        if(needed[i]) {
+            outlines[i] = kernel::Outline::of(nodes.at(bounds[i].node));
+        }
+    }
+
+    //Stored as char rather than bool so that workers writing neighbouring results never share a byte
+    std::vector<char> hit(candidates.size(), false);
+    parallel(candidates.size(), threads, [&](std::size_t begin, std::size_t end) {
+        for(std::size_t c = begin; c < end; ++c) {
+            hit[c] = outlines[candidates[c].first].intersects(outlines[candidates[c].second]);
+        }
+    });
+
+    std::vector<Overlap> found{};
+    for(std::size_t c = 0; c < candidates.size(); ++c) {
+        if(hit[c]) {
+            const BoardGraph::NodeHandle a = bounds[candidates[c].first].node;
+            const BoardGraph::NodeHandle b = bounds[candidates[c].second].node;
+            found.push_back(Overlap{.a = std::min(a, b), .b = std::max(a, b)});
+        }
+    }
+    std::sort(found.begin(), found.end());
+    return found;
+}
+
+std::vector<BoardGraph::NodeHandle> overlaps(BoardGraph const& graph, SpatialIndex const& index, BoardGraph::NodeHandle node) {
+    const ComponentNode& target = graph.node_at(node);
+    const kernel::Outline outline = kernel::Outline::of(target);
+    std::vector<BoardGraph::NodeHandle> found{};
+    index.intersecting(target.aabb(), [&](BoardGraph::NodeHandle other) {
+        if(other != node && outline.intersects(kernel::Outline::of(graph.node_at(other)))) {
+            found.push_back(other);
+        }
+    });
+    return found;
+}
+
+}
+
+TEST_CASE("drc::overlaps") {
+    const testing::AssetDir assets{};
+    BoardGraph graph = testing::asset_board();
+    const Ref<Component> bus = graph.resources().try_get<Component>("1280.bus");
+    const Ref<Component> ell = graph.resources().try_get<Component>("1280.ell");
+    const Ref<Component> big = graph.resources().try_get<Component>("1280.test");
+    //Start from an empty board so that only the nodes placed here can overlap
+    std::vector<BoardGraph::NodeHandle> existing{};
+    for(const ComponentNode& node : graph.nodes()) {
+        existing.push_back(node.handle());
+    }
+    for(const BoardGraph::NodeHandle node : existing) {
+        graph.remove_node(node);
+    }
+    const auto at = [](float x, float y, float dx_in = 0, float dy_in = 0) {
+        return Point{Length{x} + Length{LengthUnit::Inches, dx_in}, Length{y} + Length{LengthUnit::Inches, dy_in}};
+    };
+    const auto place = [&graph](Ref<Component> const& type, std::string const& id, Point pos) {
+        return graph.component(type, id, pos)->handle();
+    };
+    const auto sorted = [](std::vector<BoardGraph::NodeHandle> nodes) {
+        std::sort(nodes.begin(), nodes.end());
+        return nodes;
+    };
+
+    SUBCASE("footprints") {
+        //Bus nodes are 4in squares and the L fills an 8in square except for a 4in notch in its upper right. Inside
+        //the L's bounds but clear of it in the notch, and reaching into the notch far enough to cross its edges
+        const auto notch_l = place(ell, "drc.notch.l", at(5, 5));
+        const auto notch_bus = place(bus, "drc.notch.bus", at(5, 5, 2.5, 2.5));
+        const auto reach_l = place(ell, "drc.reach.l", at(10, 5));
+        const auto reach_bus = place(bus, "drc.reach.bus", at(10, 5, 1.5, 1.5));
+        //Entirely inside a larger footprint with no edges crossing
+        const auto outer = place(big, "drc.outer", at(5, 10));
+        const auto inner = place(bus, "drc.inner", at(5, 10, 1, -1));
+        //Placed around the origin so that the touching edges land on exactly the same coordinates: left and right
+        //share an edge, above shares an edge with left and only a corner with right
+        const auto left = place(bus, "drc.left", at(0, 0, -2));
+        const auto right = place(bus, "drc.right", at(0, 0, 2));
+        const auto above = place(bus, "drc.above", at(0, 0, -2, 4));
+        const auto apart = place(bus, "drc.apart", at(0, 0, 6.5));
+
+        const auto ordered = [](BoardGraph::NodeHandle a, BoardGraph::NodeHandle b) {
+            return drc::Overlap{.a = std::min(a, b), .b = std::max(a, b)};
+        };
+        std::vector<drc::Overlap> expected{
+            ordered(reach_l, reach_bus),
+            ordered(outer, inner),
+            ordered(left, right),
+            ordered(left, above),
+            ordered(right, above),
+        };
+        std::sort(expected.begin(), expected.end());
+        CHECK_EQ(drc::overlaps(graph.snapshot(), 1), expected);
+
+        const SpatialIndex index{graph};
+        CHECK(drc::overlaps(graph, index, notch_l).empty());
+        CHECK(drc::overlaps(graph, index, notch_bus).empty());
+        CHECK(drc::overlaps(graph, index, apart).empty());
+        CHECK_EQ(drc::overlaps(graph, index, reach_bus), std::vector{reach_l});
+        CHECK_EQ(drc::overlaps(graph, index, inner), std::vector{outer});
+        CHECK_EQ(sorted(drc::overlaps(graph, index, right)), sorted({left, above}));
+    }
+
+    SUBCASE("threads") {
+        //A dense grid where every node overlaps its neighbours, giving each worker thread thousands of pairs
+        constexpr int SIDE = 40;
+        for(int i = 0; i < SIDE; ++i) {
+            for(int j = 0; j < SIDE; ++j) {
+                place(bus, fmt::format("drc.grid.{}.{}", i, j), at(0, 0, i * 1.5f, j * 1.5f));
+            }
+        }
+        const BoardSnapshot snapshot = graph.snapshot();
+        const std::vector<drc::Overlap> serial = drc::overlaps(snapshot, 1);
+        REQUIRE_GT(serial.size(), 4 * 2048);
+        CHECK_EQ(drc::overlaps(snapshot, 4), serial);
+        CHECK_EQ(drc::overlaps(snapshot, 0), serial);
+
+        //Every pair is found again from both of its nodes by the single node check
+        const SpatialIndex index{graph};
+        std::size_t found = 0;
+        for(const ComponentNode& node : graph.nodes()) {
+            found += drc::overlaps(graph, index, node.handle()).size();
+        }
+        CHECK_EQ(found, 2 * serial.size());
+    }
+}
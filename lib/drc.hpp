@@ -0,0 +1,40 @@
+#pragma once
+
+#include <span>
+#include <vector>
+
+#include "lib.hpp"
+#include "spatial.hpp"
+
+/**
+ * \brief Design rule checks run over a whole board or a single placed node
+ */
+namespace drc {
+
+/** \brief A pair of nodes whose footprints overlap, `a` is always the lower handle */
+struct Overlap {
+    BoardGraph::NodeHandle a;
+    BoardGraph::NodeHandle b;
+
+    constexpr inline bool operator==(Overlap const& other) const noexcept = default;
+    constexpr inline auto operator<=>(Overlap const& other) const noexcept = default;
+};
+
+/**
+ * \brief Find every pair of nodes in a board whose footprints overlap. Candidate pairs are found by sweeping the
+ * nodes' bounding boxes in order along the x axis, then each candidate's footprints are compared exactly, with the
+ * exact comparisons spread across worker threads on large boards
+ * \param board Snapshot of the board to check, which is only read so the board may be edited during the check
+ * \param threads Maximum number of threads to use, or 0 to use one for every hardware thread
+ * \return All overlapping pairs sorted by handle
+ */
+std::vector<Overlap> overlaps(BoardSnapshot const& board, unsigned threads = 0);
+
+/**
+ * \brief Find the nodes whose footprints overlap the footprint of one node, using a spatial index of the graph so
+ * that only nearby nodes are compared
+ * \return Handles of the overlapping nodes in no particular order
+ */
+std::vector<BoardGraph::NodeHandle> overlaps(BoardGraph const& graph, SpatialIndex const& index, BoardGraph::NodeHandle node);
+
+}
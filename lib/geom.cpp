@@ -1,24 +1,32 @@
 #include "geom.hpp"
+#include <array>
+#include <cmath>
 #include <cstddef>
+#include <cstdint>
 #include <limits>
+#include <random>
+#include <vector>
 #include <lib.hpp>
+#include <testing.hpp>
+
+#include <doctest.h>
 
 void Footprint::from_json(Footprint& self, const json& val) {
     for(const json& v : val) {
-        self.m_pts.push_back(v.get<Point>());
+        self.m_pts.push_back(v.get<Point>().raw());
     }
     self.get_minmax();
 }
 
 json Footprint::to_json() const {
     json::array_t arr{};
-    for(const Point& pt : this->m_pts) {
-        arr.push_back(pt.to_json());
+    for(const RawPoint& pt : this->m_pts) {
+        arr.push_back(Point{pt}.to_json());
     }
     return arr;
 }
 
-Footprint::Footprint(SingleVec<Point>&& pts) :
+Footprint::Footprint(SingleVec<RawPoint>&& pts) :
     m_pts{std::move(pts)},
     m_aabb{}
 {
@@ -44,13 +52,128 @@ json Point::to_json() const {
     });
 }
 
-constexpr Length Point::distance(const Point &other) const {
-    const LengthUnit units = this->x.unit();
-    return Length(
-        units,
-        std::sqrt(
-            std::pow(this->x.normalized() - other.x.normalized(), 2) +
-            std::pow(this->y.normalized() - other.y.normalized(), 2)
-        )
-    );
+PackedPoint PackedPoint::pack(Point const& pt) noexcept {
+    return PackedPoint{
+        .x = pt.x.normalized(),
+        .y = pt.y.normalized(),
+        .x_unit = static_cast<LengthUnit::UnitVal>(static_cast<std::size_t>(pt.x.unit())),
+        .y_unit = static_cast<LengthUnit::UnitVal>(static_cast<std::size_t>(pt.y.unit())),
+        .pad{0, 0},
+    };
+}
+
+Point PackedPoint::unpack() const {
+    Point pt{Length{this->x}, Length{this->y}};
+    pt.x.conv(this->x_unit);
+    pt.y.conv(this->y_unit);
+    return pt;
+}
+
+Length Point::distance(const Point& other) const {
+    const Length::Raw dx = this->x.normalized() - other.x.normalized();
+    const Length::Raw dy = this->y.normalized() - other.y.normalized();
+    Length dist{std::sqrt(dx * dx + dy * dy)};
+    dist.conv(this->x.unit());
+    return dist;
+}
+
+namespace {
+
+/** \brief Box with the same comparisons as `AABB` over float coordinates, the baseline that `AABB` is timed against */
+struct FloatBox {
+    float min_x, min_y, max_x, max_y;
+
+    constexpr inline bool contains(std::array<float, 2> const& pt) const noexcept {
+        return this->min_x <= pt[0] && this->min_y <= pt[1] && this->max_x >= pt[0] && this->max_y >= pt[1];
+    }
+    constexpr inline bool intersects(FloatBox const& other) const noexcept {
+        return this->min_x <= other.max_x && other.min_x <= this->max_x &&
+            this->min_y <= other.max_y && other.min_y <= this->max_y;
+    }
+};
+
+}
+
+TEST_CASE("AABB coordinate benchmark" * doctest::skip()) {
+    //Compare point-in-box and box overlap tests on `AABB`, over whichever `Coord` this build uses, against the same
+    //tests on float meters
+    constexpr std::size_t BOXES = 200000;
+    constexpr std::size_t POINTS = 256;
+    constexpr std::size_t QUERIES = 500;
+
+    //Coordinates are whole millimeters so that both representations order every pair of coordinates the same way
+    std::mt19937 rng{1280};
+    std::uniform_int_distribution<std::int32_t> pos{-10000, 10000};
+    std::uniform_int_distribution<std::int32_t> size{1, 500};
+    const auto box = [&]() {
+        const std::int32_t x = pos(rng);
+        const std::int32_t y = pos(rng);
+        return std::array<std::int32_t, 4>{x, y, x + size(rng), y + size(rng)};
+    };
+    const auto raw = [](std::int32_t x, std::int32_t y) {
+        return RawPoint{coord::from_normalized(x / 1000.f), coord::from_normalized(y / 1000.f)};
+    };
+    const auto aabb = [&raw](std::array<std::int32_t, 4> const& mm) {
+        return AABB{raw(mm[0], mm[1]), raw(mm[2], mm[3])};
+    };
+    const auto meters = [](std::array<std::int32_t, 4> const& mm) {
+        return FloatBox{mm[0] / 1000.f, mm[1] / 1000.f, mm[2] / 1000.f, mm[3] / 1000.f};
+    };
+
+    std::vector<AABB> aabb_boxes{};
+    std::vector<FloatBox> float_boxes{};
+    for(std::size_t i = 0; i < BOXES; ++i) {
+        const auto mm = box();
+        aabb_boxes.push_back(aabb(mm));
+        float_boxes.push_back(meters(mm));
+    }
+    std::vector<RawPoint> aabb_points{};
+    std::vector<std::array<float, 2>> float_points{};
+    for(std::size_t i = 0; i < POINTS; ++i) {
+        const std::int32_t x = pos(rng);
+        const std::int32_t y = pos(rng);
+        aabb_points.push_back(raw(x, y));
+        float_points.push_back({x / 1000.f, y / 1000.f});
+    }
+    std::vector<AABB> aabb_queries{};
+    std::vector<FloatBox> float_queries{};
+    for(std::size_t i = 0; i < QUERIES; ++i) {
+        const auto mm = box();
+        aabb_queries.push_back(aabb(mm));
+        float_queries.push_back(meters(mm));
+    }
+
+    const auto contained = [](auto const& boxes, auto const& points) {
+        return testing::timed([&]() {
+            std::uint64_t hits = 0;
+            for(const auto& pt : points) {
+                for(const auto& b : boxes) {
+                    hits += b.contains(pt);
+                }
+            }
+            return hits;
+        });
+    };
+    const auto overlapping = [](auto const& boxes, auto const& queries) {
+        return testing::timed([&]() {
+            std::uint64_t hits = 0;
+            for(const auto& query : queries) {
+                for(const auto& b : boxes) {
+                    hits += b.intersects(query);
+                }
+            }
+            return hits;
+        });
+    };
+
+    auto [float_contained, float_contains_us] = contained(float_boxes, float_points);
+    auto [aabb_contained, aabb_contains_us] = contained(aabb_boxes, aabb_points);
+    auto [float_overlaps, float_overlaps_us] = overlapping(float_boxes, float_queries);
+    auto [aabb_overlaps, aabb_overlaps_us] = overlapping(aabb_boxes, aabb_queries);
+
+    CHECK_EQ(float_contained, aabb_contained);
+    CHECK_EQ(float_overlaps, aabb_overlaps);
+    const char *coords = BuildOpts::fixed_coords ? "fixed" : "float";
+    MESSAGE("point in box: float baseline " << float_contains_us << "us, AABB with " << coords << " coordinates " << aabb_contains_us << "us");
+    MESSAGE("box overlap: float baseline " << float_overlaps_us << "us, AABB with " << coords << " coordinates " << aabb_overlaps_us << "us");
 }
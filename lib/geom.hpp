@@ -4,6 +4,9 @@
 #include "util/stackvec.hpp"
 #include "util/freelist.hpp"
 #include "util/singlevec.hpp"
+#include <algorithm>
+#include <buildopts.h>
+#include <cstdint>
 #include <limits>
 #include <type_traits>
 #include <unit.hpp>
@@ -12,15 +15,81 @@
 #include <variant>
 
 
+/**
+ * \brief Scalar type of raw workspace coordinates. By default these are normalized lengths, when the library is
+ * built with `FIXED_COORDS` they are whole micrometers, so that raw coordinates compare exactly and geometry on them
+ * gives the same result on every machine. Fixed coordinates cover about 2km either side of the origin
+ */
+using Coord = std::conditional_t<BuildOpts::fixed_coords, std::int32_t, Length::Raw>;
+
+/**
+ * \brief Conversions between raw coordinates and normalized lengths
+ */
+namespace coord {
+
+/** \brief Number of raw coordinate units in one normalized length unit */
+constexpr const double PER_UNIT = BuildOpts::fixed_coords ? 1e6 : 1.;
+
+/** \brief Convert a normalized length to a raw coordinate, rounding to the nearest unit for fixed coordinates */
+constexpr inline Coord from_normalized(Length::Raw val) noexcept {
+    if constexpr(BuildOpts::fixed_coords) {
+        const double scaled = static_cast<double>(val) * PER_UNIT;
+        return static_cast<Coord>(scaled < 0 ? scaled - 0.5 : scaled + 0.5);
+    } else {
+        return val;
+    }
+}
+
+/** \brief Convert a raw coordinate back to a normalized length */
+constexpr inline Length::Raw to_normalized(Coord val) noexcept {
+    if constexpr(BuildOpts::fixed_coords) {
+        return static_cast<Length::Raw>(static_cast<double>(val) / PER_UNIT);
+    } else {
+        return val;
+    }
+}
+
+}
+
+/**
+ * \brief A 2D point on the workspace plane stored as bare raw coordinates with no display units, half the size of a
+ * `Point`. Used wherever many points are stored or processed together, and converted to a `Point` only where
+ * coordinates are read from or shown to the user
+ */
+struct RawPoint {
+    Coord x;
+    Coord y;
+
+    constexpr bool operator==(const RawPoint& other) const = default;
+
+    constexpr inline RawPoint operator+(const RawPoint& other) const {
+        return RawPoint{this->x + other.x, this->y + other.y};
+    }
+    constexpr inline RawPoint operator-(const RawPoint& other) const {
+        return RawPoint{this->x - other.x, this->y - other.y};
+    }
+};
+
+static_assert(std::is_trivially_copyable_v<RawPoint> && sizeof(RawPoint) == 2 * sizeof(Coord));
+
 /**
  * \brief A 2D point on the workspace plane
  * \implements ser::FromJson
  */
 struct Point {
 public:
+    using Raw = RawPoint;
+
     /** Create a new point from x and y coordinate */
     constexpr Point(const Length x, const Length y) : x{x}, y{y} {}
     constexpr Point() = default; 
+    /** Create a new point in the default length unit from raw coordinates */
+    explicit constexpr Point(const RawPoint& raw) : x{coord::to_normalized(raw.x)}, y{coord::to_normalized(raw.y)} {}
+
+    /** Get the raw coordinates of this point, dropping its display units */
+    constexpr inline RawPoint raw() const noexcept {
+        return RawPoint{coord::from_normalized(this->x.normalized()), coord::from_normalized(this->y.normalized())};
+    }
 
     /** 
      * Deserialize a point from a JSON value
@@ -29,7 +98,8 @@ public:
     /** Convert this point into a JSON value */
     json to_json() const;
 
-    constexpr bool operator==(const Point& other) const = default;
+    /** Check if two points are at the same position, compared by raw coordinates so units are ignored */
+    constexpr bool operator==(const Point& other) const { return this->raw() == other.raw(); }
 
     constexpr inline Point operator*(const Point& other) const {
         return Point{this->x * other.x, this->y * other.y};
@@ -91,7 +161,7 @@ public:
      * \brief Get the distance between two points, returning a distance in the units
      * of this's x coordinate
      */
-    constexpr Length distance(const Point& other) const;
+    Length distance(const Point& other) const;
 
     Length x;
     Length y;
@@ -99,53 +169,77 @@ public:
 
 static_assert(ser::JsonSerializable<Point>);
 
+/**
+ * \brief A `Point` stored as its normalized coordinates and display units. Unlike `Point` this is trivially
+ * copyable, so binary formats store it byte for byte
+ */
+struct PackedPoint {
+    Length::Raw x;
+    Length::Raw y;
+    LengthUnit::UnitVal x_unit;
+    LengthUnit::UnitVal y_unit;
+    /** \brief Always zero, so that no uninitialized bytes are written out */
+    std::uint8_t pad[2];
+
+    static PackedPoint pack(Point const& pt) noexcept;
+    /** \brief Get the stored point, both units must be valid `LengthUnit` values */
+    Point unpack() const;
+};
+
+static_assert(std::is_trivially_copyable_v<PackedPoint> && sizeof(PackedPoint) == 12);
+
 /**
  * \brief Axis-aligned bounding box that contains a minimum and maximum point, required for storage in an 
- * R-Tree and for optimizing intersection queries
+ * R-Tree and for optimizing intersection queries. Stored in raw coordinates so that comparisons against the box
+ * are exact when the library is built with fixed coordinates
  */
 struct AABB {
     /**
      * Minimum x and y coordinate of the box
      * **MUST** be less than `max`
      */
-    Point min;
-    Point max;
+    RawPoint min;
+    RawPoint max;
 
+    /** \brief Create an empty box that contains nothing until it is expanded */
     AABB() : 
-        min{Length(std::numeric_limits<float>::max()), Length(std::numeric_limits<float>::max())},
-        max{Length(std::numeric_limits<float>::min()), Length(std::numeric_limits<float>::min())} {}
+        min{std::numeric_limits<Coord>::max(), std::numeric_limits<Coord>::max()},
+        max{std::numeric_limits<Coord>::lowest(), std::numeric_limits<Coord>::lowest()} {}
     
     /**
      * \brief Create a new axis-aligned bounding box from minimum and maximum points
      * \param min Minimum x and y coordinate, must be less than `max`
      */
-    AABB(Point&& min, Point&& max) : min{min}, max{max} {
-        assert(min.x < max.x && min.y < max.y);
+    AABB(Point const& min, Point const& max) : min{min.raw()}, max{max.raw()} {
+        assert(this->min.x < this->max.x && this->min.y < this->max.y);
     }
+    /** \brief Create a new axis-aligned bounding box from raw minimum and maximum points */
+    constexpr AABB(RawPoint const& min, RawPoint const& max) : min{min}, max{max} {}
         
     /**
      * \brief Create a new AABB with the minimum point at (0, 0) and the maximum at (width, height)
      */
-    AABB(const Length& width, const Length& height) : min{Point(0._m, 0._m)}, max{Point(width, height)} {}
+    AABB(const Length& width, const Length& height) : min{Point(0._m, 0._m).raw()}, max{Point(width, height).raw()} {}
     
     /**
      * \brief Expand this axis-aligned bounding box to contain the given point, modifyuing `min` and `max` respectively
      * \param p The point that we must be able to contain
      */
-    inline constexpr void expand(const Point& p) {
-        if(p.x > this->max.x) { this->max.x = p.x; }
-        else if(p.x < this->min.x) { this->min.x = p.x; }
-        if(p.y > this->max.y) { this->max.y = p.y; }
-        else if(p.y < this->min.y) { this->min.y = p.y; }
+    inline constexpr void expand(const RawPoint& p) {
+        this->min.x = std::min(this->min.x, p.x);
+        this->min.y = std::min(this->min.y, p.y);
+        this->max.x = std::max(this->max.x, p.x);
+        this->max.y = std::max(this->max.y, p.y);
     }
     
     /**
      * \brief Check if a point is contained inside this bounding box
      */
-    inline constexpr bool contains(const Point& point) const noexcept {
+    inline constexpr bool contains(const RawPoint& point) const noexcept {
         return this->min.x <= point.x && this->min.y <= point.y &&
             this->max.x >= point.x && this->max.y >= point.y;
     }
+    inline constexpr bool contains(const Point& point) const noexcept { return this->contains(point.raw()); }
     
     /** 
      * \brief Check if this AABB can contain another AABB
@@ -154,16 +248,20 @@ struct AABB {
         return this->min.x <= other.min.x && this->min.y <= other.min.y &&
             this->max.x >= other.max.x && this->max.y >= other.max.y;
     }
+
+    /** \brief Check if this AABB shares any point with another AABB */
+    inline constexpr bool intersects(const AABB& other) const noexcept {
+        return this->min.x <= other.max.x && other.min.x <= this->max.x &&
+            this->min.y <= other.max.y && other.min.y <= this->max.y;
+    }
     
     /**
      * \brief Offset this AABB by the given x and y values
      */
-    inline AABB operator+(const Point& offset) const noexcept {
-        return AABB{
-            Point(this->min.x + offset.x, this->min.y + offset.y),
-            Point(this->max.x + offset.x, this->max.y + offset.y)
-        };
+    inline constexpr AABB operator+(const RawPoint& offset) const noexcept {
+        return AABB{this->min + offset, this->max + offset};
     }
+    inline AABB operator+(const Point& offset) const noexcept { return *this + offset.raw(); }
 };
 
 /**
@@ -185,15 +283,15 @@ public:
      * \brief Get the first point in this footprint, guranteed to be 
      * available
      */
-    inline const Point& first() const { return this->m_pts[0]; }
+    inline const RawPoint& first() const { return this->m_pts[0]; }
 
     /**
      * \brief Create a new footprint from a list of connected points
      */
-    Footprint(const SingleVec<Point>& pts) : Footprint(SingleVec{pts}) {}
-    Footprint(SingleVec<Point>&& pts);
+    Footprint(const SingleVec<RawPoint>& pts) : Footprint(SingleVec{pts}) {}
+    Footprint(SingleVec<RawPoint>&& pts);
     
-    constexpr inline operator SingleVec<Point> const&() const noexcept {
+    constexpr inline operator SingleVec<RawPoint> const&() const noexcept {
         return this->m_pts;
     }
     
@@ -202,11 +300,11 @@ public:
      */
     inline constexpr AABB const& aabb() const noexcept { return this->m_aabb; }
 
-    SingleVec<Point>::const_iterator begin() const { return this->m_pts.begin(); }
-    SingleVec<Point>::const_iterator end() const { return this->m_pts.end(); }
+    SingleVec<RawPoint>::const_iterator begin() const { return this->m_pts.begin(); }
+    SingleVec<RawPoint>::const_iterator end() const { return this->m_pts.end(); }
 private:
     /** \brief A vector of points that each connect to the prior one */
-    SingleVec<Point> m_pts;
+    SingleVec<RawPoint> m_pts;
     /** \brief Axis-aligned bounding box for the footprint */
     AABB m_aabb;
     /** \brief Get the minimum and maximum x and y values of m_pts */
@@ -0,0 +1,443 @@
+#include "journal.hpp"
+#include "util/bytes.hpp"
+
+#include <algorithm>
+#include <array>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include <doctest.h>
+
+#include "testing.hpp"
+
+static_assert(std::is_trivially_copyable_v<Symbol>);
+
+struct Journal::Delta {
+    Op op;
+    /** \brief ID of the node or edge that was edited, for a wire end this is the node */
+    Symbol id{};
+    /** \brief Component type of an added or removed node, or the edge of an attached or detached wire end */
+    Symbol other{};
+    ConnectionPortIdx port{0};
+    WireEdge::Side side{WireEdge::LEFT};
+    /** \brief Position of a node, positions before and after a move, or positions of both ends of an edge */
+    std::array<Point, 2> pos{};
+    std::array<Symbol, 2> connectors{};
+    std::string_view name{};
+    /** \brief Points of an added or removed edge, or points of a rerouted edge after the edit */
+    std::vector<RawPoint> points{};
+    /** \brief Points of a rerouted edge before the edit */
+    std::vector<RawPoint> from{};
+};
+
+void Journal::commit() {
+    if(this->m_open.empty()) {
+        return;
+    }
+    this->m_open.shrink_to_fit();
+    this->m_bytes += this->m_open.size();
+    this->m_undo.push_back(std::move(this->m_open));
+    this->m_open = Step{};
+    this->trim();
+}
+
+bool Journal::undo() {
+    this->commit();
+    if(this->m_undo.empty()) {
+        return false;
+    }
+    Step step = std::move(this->m_undo.back());
+    this->m_undo.pop_back();
+    this->replay(step, false);
+    this->m_redo.push_back(std::move(step));
+    return true;
+}
+
+bool Journal::redo() {
+    this->commit();
+    if(this->m_redo.empty()) {
+        return false;
+    }
+    Step step = std::move(this->m_redo.back());
+    this->m_redo.pop_back();
+    this->replay(step, true);
+    this->m_undo.push_back(std::move(step));
+    return true;
+}
+
+void Journal::set_capacity(std::size_t capacity) {
+    this->m_capacity = capacity;
+    this->fit();
+}
+
+void Journal::clear() {
+    this->m_undo.clear();
+    this->m_redo.clear();
+    this->m_open.clear();
+    this->m_bytes = 0;
+}
+
+void Journal::node_added(ComponentNode const& node) {
+    this->record_node(Op::NODE_ADDED, node);
+}
+
+void Journal::node_removed(ComponentNode const& node) {
+    this->record_node(Op::NODE_REMOVED, node);
+}
+
+void Journal::edge_added(WireEdge const& edge) {
+    this->record_edge(Op::EDGE_ADDED, edge);
+}
+
+void Journal::edge_removed(WireEdge const& edge) {
+    this->record_edge(Op::EDGE_REMOVED, edge);
+}
+
+void Journal::connected(ComponentNode const& node, ConnectionPortIdx port, WireEdge const& edge, WireEdge::Side side) {
+    this->record_conn(Op::CONNECTED, node, port, edge, side);
+}
+
+void Journal::detached(ComponentNode const& node, ConnectionPortIdx port, WireEdge const& edge, WireEdge::Side side) {
+    this->record_conn(Op::DETACHED, node, port, edge, side);
+}
+
+void Journal::moved(ComponentNode const& node, Point from) {
+    if(this->m_replaying) {
+        return;
+    }
+    ByteWriter out{this->record(Op::MOVED)};
+    out.write(node.symbol());
+    out.write(PackedPoint::pack(from));
+    out.write(PackedPoint::pack(node.pos()));
+    this->fit();
+}
+
+void Journal::rerouted(WireEdge const& edge, std::span<const RawPoint> from) {
+    if(this->m_replaying) {
+        return;
+    }
+    ByteWriter out{this->record(Op::REROUTED)};
+    out.write(edge.symbol());
+    out.write(from);
+    out.write(edge.points());
+    this->fit();
+}
+
+std::vector<std::byte>& Journal::record(Op op) {
+    for(const Step& step : this->m_redo) {
+        this->m_bytes -= step.size();
+    }
+    this->m_redo.clear();
+    ByteWriter{this->m_open}.write(op);
+    return this->m_open;
+}
+
+void Journal::record_node(Op op, ComponentNode const& node) {
+    if(this->m_replaying) {
+        return;
+    }
+    ByteWriter out{this->record(op)};
+    out.write(node.symbol());
+    out.write(node.type()->symbol());
+    out.write(PackedPoint::pack(node.pos()));
+    out.write(std::string_view{node.name()});
+    this->fit();
+}
+
+void Journal::record_edge(Op op, WireEdge const& edge) {
+    if(this->m_replaying) {
+        return;
+    }
+    //Ends are always restored floating, attached ends are recorded as separate connections
+    ByteWriter out{this->record(op)};
+    out.write(edge.symbol());
+    for(const WireEdge::Connection& conn : edge.connections()) {
+        out.write(conn.connector()->symbol());
+        out.write(PackedPoint::pack(conn.pos()));
+    }
+    out.write(edge.points());
+    this->fit();
+}
+
+void Journal::record_conn(Op op, ComponentNode const& node, ConnectionPortIdx port, WireEdge const& edge, WireEdge::Side side) {
+    if(this->m_replaying) {
+        return;
+    }
+    ByteWriter out{this->record(op)};
+    out.write(node.symbol());
+    out.write(port);
+    out.write(edge.symbol());
+    out.write(side);
+    this->fit();
+}
+
+void Journal::replay(Step const& step, bool forward) {
+    std::vector<Delta> deltas{};
+    ByteReader in{step};
+    while(!in.done()) {
+        Delta& delta = deltas.emplace_back(Delta{.op = in.read<Op>()});
+        switch(delta.op) {
+            case Op::NODE_ADDED:
+            case Op::NODE_REMOVED:
+                delta.id = in.read<Symbol>();
+                delta.other = in.read<Symbol>();
+                delta.pos[0] = in.read<PackedPoint>().unpack();
+                delta.name = in.read_string();
+                break;
+            case Op::EDGE_ADDED:
+            case Op::EDGE_REMOVED:
+                delta.id = in.read<Symbol>();
+                for(std::size_t side = 0; side < delta.connectors.size(); ++side) {
+                    delta.connectors[side] = in.read<Symbol>();
+                    delta.pos[side] = in.read<PackedPoint>().unpack();
+                }
+                delta.points = in.read_array<RawPoint>();
+                break;
+            case Op::CONNECTED:
+            case Op::DETACHED:
+                delta.id = in.read<Symbol>();
+                delta.port = in.read<ConnectionPortIdx>();
+                delta.other = in.read<Symbol>();
+                delta.side = in.read<WireEdge::Side>();
+                break;
+            case Op::MOVED:
+                delta.id = in.read<Symbol>();
+                delta.pos[0] = in.read<PackedPoint>().unpack();
+                delta.pos[1] = in.read<PackedPoint>().unpack();
+                break;
+            case Op::REROUTED:
+                delta.id = in.read<Symbol>();
+                delta.from = in.read_array<RawPoint>();
+                delta.points = in.read_array<RawPoint>();
+                break;
+        }
+    }
+
+    this->m_replaying = true;
+    try {
+        const Ref<GraphStorage> storage = this->m_graph.lock();
+        if(storage == nullptr || storage->graph == nullptr) {
+            throw std::runtime_error{"The graph that the history was recorded for has been destroyed"};
+        }
+        BoardGraph& graph = *storage->graph;
+        if(forward) {
+            for(const Delta& delta : deltas) {
+                this->apply(graph, delta);
+            }
+        } else {
+            for(auto delta = deltas.rbegin(); delta != deltas.rend(); ++delta) {
+                //Every edit is undone by the edit of the opposite kind with the same operands
+                switch(delta->op) {
+                    case Op::NODE_ADDED: delta->op = Op::NODE_REMOVED; break;
+                    case Op::NODE_REMOVED: delta->op = Op::NODE_ADDED; break;
+                    case Op::EDGE_ADDED: delta->op = Op::EDGE_REMOVED; break;
+                    case Op::EDGE_REMOVED: delta->op = Op::EDGE_ADDED; break;
+                    case Op::CONNECTED: delta->op = Op::DETACHED; break;
+                    case Op::DETACHED: delta->op = Op::CONNECTED; break;
+                    case Op::MOVED: std::swap(delta->pos[0], delta->pos[1]); break;
+                    case Op::REROUTED: std::swap(delta->from, delta->points); break;
+                }
+                this->apply(graph, *delta);
+            }
+        }
+    } catch(const std::exception& e) {
+        this->m_replaying = false;
+        this->clear();
+        throw std::runtime_error{fmt::format("Failed to replay edit history, the history has been cleared: {}", e.what())};
+    }
+    this->m_replaying = false;
+}
+
+void Journal::apply(BoardGraph& graph, Delta const& delta) {
+    auto node = [&graph](Symbol id) {
+        auto handle = graph.node_handle(id);
+        if(!handle.has_value()) {
+            throw std::runtime_error{fmt::format("History refers to nonexistent node {}", id)};
+        }
+        return handle.unwrap_unchecked();
+    };
+    auto edge = [&graph](Symbol id) {
+        auto handle = graph.edge_handle(id);
+        if(!handle.has_value()) {
+            throw std::runtime_error{fmt::format("History refers to nonexistent edge {}", id)};
+        }
+        return handle.unwrap_unchecked();
+    };
+
+    switch(delta.op) {
+        case Op::NODE_ADDED:
+            graph.component(
+                graph.resources().try_get<Component>(delta.other),
+                std::string{delta.id.str()},
+                delta.pos[0],
+                delta.name
+            );
+            break;
+        case Op::NODE_REMOVED:
+            graph.remove_node(node(delta.id));
+            break;
+        case Op::EDGE_ADDED:
+            graph.edge(
+                std::string{delta.id.str()},
+                {graph.resources().try_get<Connector>(delta.connectors[0]), graph.resources().try_get<Connector>(delta.connectors[1])},
+                delta.pos,
+                delta.points
+            );
+            break;
+        case Op::EDGE_REMOVED:
+            graph.remove_edge(edge(delta.id));
+            break;
+        case Op::CONNECTED:
+            if(!graph.node_ref(node(delta.id))->connnect_port(delta.port, graph.edge_ref(edge(delta.other)), delta.side, false).has_value()) {
+                throw std::runtime_error{fmt::format("Failed to attach edge {} to node {}", delta.other, delta.id)};
+            }
+            break;
+        case Op::DETACHED:
+            graph.edge_ref(edge(delta.other))->side(delta.side).detach();
+            break;
+        case Op::MOVED:
+            graph.node_ref(node(delta.id))->move_to(delta.pos[1]);
+            break;
+        case Op::REROUTED:
+            graph.reroute(edge(delta.id), delta.points);
+            break;
+    }
+}
+
+void Journal::fit() {
+    //A step that outgrows the capacity on its own is closed early, which discards it along with every older step
+    if(this->m_open.size() > this->m_capacity) {
+        this->commit();
+    } else {
+        this->trim();
+    }
+}
+
+void Journal::trim() {
+    while(this->bytes() > this->m_capacity && !this->m_undo.empty()) {
+        this->m_bytes -= this->m_undo.front().size();
+        this->m_undo.pop_front();
+    }
+    //Steps that were undone are the next to go, starting from the one furthest from the current state
+    while(this->bytes() > this->m_capacity && !this->m_redo.empty()) {
+        this->m_bytes -= this->m_redo.front().size();
+        this->m_redo.erase(this->m_redo.begin());
+    }
+}
+
+TEST_CASE("Journal") {
+    const testing::AssetDir assets{};
+    BoardGraph graph = testing::asset_board();
+    const Ref<Component> bus = graph.resources().try_get<Component>("1280.bus");
+    const Ref<Connector> bare = graph.resources().try_get<Connector>("1280.bare");
+    const Ref<Journal> journal = graph.track<Journal>();
+
+    const Ref<ComponentNode> node = graph.component(bus, "journal.a", Point{Length{1.f}, Length{2.f}}, "A");
+    Ref<WireEdge> edge = graph.edge("journal.e", {bare, bare});
+    node->connnect_port(bus->get_port_idx("out0").unwrap(), edge, WireEdge::LEFT);
+    journal->commit();
+    const json built = graph.to_json();
+
+    SUBCASE("undo and redo a removed node") {
+        graph.remove_node(node->handle());
+        journal->commit();
+        const json removed = graph.to_json();
+        CHECK_FALSE(graph.get_node("journal.a").has_value());
+        CHECK(edge->side(WireEdge::LEFT).is_floating());
+
+        REQUIRE(journal->undo());
+        CHECK_EQ(graph.to_json(), built);
+        const Ref<ComponentNode> restored = graph.get_node("journal.a").unwrap();
+        REQUIRE(edge->side(WireEdge::LEFT).node().has_value());
+        CHECK_EQ(edge->side(WireEdge::LEFT).node().unwrap().get().id(), "journal.a");
+        CHECK(restored->port(bus->get_port_idx("out0").unwrap()).has_value());
+
+        REQUIRE(journal->redo());
+        CHECK_EQ(graph.to_json(), removed);
+        CHECK_FALSE(journal->redo());
+    }
+
+    SUBCASE("the graph is moved") {
+        node->move_to(Point{Length{3.f}, Length{4.f}});
+        journal->commit();
+        BoardGraph moved{std::move(graph)};
+        REQUIRE(journal->undo());
+        CHECK_EQ(moved.to_json(), built);
+
+        BoardGraph assigned{};
+        assigned = std::move(moved);
+        REQUIRE(journal->redo());
+        CHECK_EQ(node->pos(), Point{Length{3.f}, Length{4.f}});
+
+        {
+            const BoardGraph destroyed{std::move(assigned)};
+        }
+        CHECK_THROWS_AS(journal->undo(), std::runtime_error);
+        CHECK_FALSE(journal->can_undo());
+    }
+
+    SUBCASE("a new edit discards the redo history") {
+        node->move_to(Point{Length{3.f}, Length{4.f}});
+        journal->commit();
+        REQUIRE(journal->undo());
+        CHECK(journal->can_redo());
+        node->move_to(Point{Length{5.f}, Length{6.f}});
+        CHECK_FALSE(journal->can_redo());
+        CHECK_FALSE(journal->redo());
+        REQUIRE(journal->undo());
+        CHECK_EQ(graph.to_json(), built);
+    }
+
+    SUBCASE("the oldest steps are trimmed to fit the capacity") {
+        const std::size_t before = journal->bytes();
+        node->move_to(Point{Length{-1.f}, Length{0.f}});
+        journal->commit();
+        //Every move of the node is recorded in a step of the same size
+        const std::size_t step = journal->bytes() - before;
+        REQUIRE_GT(step, 0);
+        journal->set_capacity(8 * step);
+        CHECK_LE(journal->bytes(), journal->capacity());
+
+        for(int i = 0; i < 64; ++i) {
+            node->move_to(Point{Length{static_cast<float>(i)}, Length{0.f}});
+            journal->commit();
+            CHECK_LE(journal->bytes(), journal->capacity());
+        }
+        std::size_t undone = 0;
+        while(journal->undo()) {
+            undone += 1;
+        }
+        CHECK_EQ(undone, 8);
+        CHECK_EQ(node->pos(), Point{Length{55.f}, Length{0.f}});
+
+        journal->set_capacity(0);
+        CHECK_EQ(journal->bytes(), 0);
+        CHECK_FALSE(journal->can_undo());
+        CHECK_FALSE(journal->can_redo());
+    }
+
+    SUBCASE("an uncommitted step counts against the capacity") {
+        const std::size_t before = journal->bytes();
+        node->move_to(Point{Length{-1.f}, Length{0.f}});
+        const std::size_t step = journal->bytes() - before;
+        REQUIRE_GT(step, 0);
+        journal->set_capacity(8 * step);
+        CHECK_LE(journal->bytes(), journal->capacity());
+
+        //Edits are never committed, so the open step is closed early whenever it outgrows the capacity
+        for(int i = 0; i < 64; ++i) {
+            node->move_to(Point{Length{static_cast<float>(i)}, Length{0.f}});
+            CHECK_LE(journal->bytes(), journal->capacity());
+        }
+        REQUIRE(journal->can_undo());
+        REQUIRE(journal->undo());
+        CHECK_NE(node->pos(), Point{Length{63.f}, Length{0.f}});
+
+        node->move_to(Point{Length{2.f}, Length{0.f}});
+        journal->set_capacity(step / 2);
+        CHECK_EQ(journal->bytes(), 0);
+        CHECK_FALSE(journal->can_undo());
+    }
+}
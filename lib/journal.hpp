@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <span>
+#include <vector>
+
+#include "lib.hpp"
+
+/**
+ * \brief Undo and redo history of a `BoardGraph`. Every edit made to the graph is recorded as a compact binary
+ * delta holding just enough to apply the edit or its inverse again, so undoing or redoing a step costs time
+ * proportional to the size of the step rather than the size of the board.
+ *
+ * Edits are grouped into steps with `commit`, which should be called once per user action. The combined size of
+ * all recorded steps, including the open step, is capped, once the cap is reached the oldest steps are discarded.
+ * An open step that outgrows the cap by itself is committed early and discarded too, so a caller that never commits
+ * still uses bounded memory but can only undo the edits made after the last discard.
+ *
+ * A journal reaches its graph through the graph's storage, so the graph may be moved while the journal is in use
+ */
+class Journal : public GraphObserver {
+public:
+    /** \brief Default cap on the size of the history, in bytes */
+    static constexpr const std::size_t DEFAULT_CAPACITY = 16 * 1024 * 1024;
+
+    /** \brief Create an empty journal for the given graph, use `BoardGraph::track` to have it record the graph's edits */
+    explicit Journal(BoardGraph& graph, std::size_t capacity = DEFAULT_CAPACITY) : m_graph{graph.m_storage.shared()}, m_capacity{capacity} {}
+
+    /** \brief Close the step that edits are currently being recorded into, does nothing if no edits were made */
+    void commit();
+
+    /**
+     * \brief Revert the most recent step, committing any open step first
+     * \return false if there was no step to undo
+     * \throws std::runtime_error if the graph was edited without the journal observing it or has been destroyed,
+     * the history is cleared in this case
+     */
+    bool undo();
+    /**
+     * \brief Apply the most recently undone step again
+     * \return false if there was no step to redo
+     * \throws std::runtime_error under the same conditions as `undo`
+     */
+    bool redo();
+
+    /** \brief Check if there is a step that can be undone, including an open step */
+    inline bool can_undo() const noexcept { return !this->m_undo.empty() || !this->m_open.empty(); }
+    /** \brief Check if there is a step that can be redone */
+    inline bool can_redo() const noexcept { return !this->m_redo.empty(); }
+
+    /** \brief Get the number of bytes of history currently held, including the open step */
+    inline constexpr std::size_t bytes() const noexcept { return this->m_bytes + this->m_open.size(); }
+    /** \brief Get the cap on the number of bytes of history kept */
+    inline constexpr std::size_t capacity() const noexcept { return this->m_capacity; }
+    /** \brief Change the cap on the number of bytes of history, discarding the oldest steps to fit */
+    void set_capacity(std::size_t capacity);
+
+    /** \brief Discard all recorded history */
+    void clear();
+
+    void node_added(ComponentNode const& node) override;
+    void node_removed(ComponentNode const& node) override;
+    void edge_added(WireEdge const& edge) override;
+    void edge_removed(WireEdge const& edge) override;
+    void connected(ComponentNode const& node, ConnectionPortIdx port, WireEdge const& edge, WireEdge::Side side) override;
+    void detached(ComponentNode const& node, ConnectionPortIdx port, WireEdge const& edge, WireEdge::Side side) override;
+    void moved(ComponentNode const& node, Point from) override;
+    void rerouted(WireEdge const& edge, std::span<const RawPoint> from) override;
+private:
+    /** \brief Kind of a single recorded edit, every kind has an inverse kind */
+    enum class Op : std::uint8_t {
+        NODE_ADDED,
+        NODE_REMOVED,
+        EDGE_ADDED,
+        EDGE_REMOVED,
+        CONNECTED,
+        DETACHED,
+        MOVED,
+        REROUTED,
+    };
+
+    /** \brief A single edit decoded from a step */
+    struct Delta;
+
+    /** \brief A group of edits that are undone and redone together, encoded back to back */
+    using Step = std::vector<std::byte>;
+
+    /** \brief Storage of the graph this journal records, which links to the graph even after it is moved */
+    WeakRef<GraphStorage> m_graph;
+    /** \brief Committed steps, oldest first */
+    std::deque<Step> m_undo{};
+    /** \brief Undone steps, most recently undone last */
+    std::vector<Step> m_redo{};
+    /** \brief Step that edits are currently recorded into */
+    Step m_open{};
+    /** \brief Combined size of all steps in `m_undo` and `m_redo` */
+    std::size_t m_bytes{0};
+    std::size_t m_capacity;
+    /** \brief Set while a step is being applied, so that the journal does not record its own edits */
+    bool m_replaying{false};
+
+    /** \brief Start recording an edit into the open step, discarding the redo history */
+    std::vector<std::byte>& record(Op op);
+    /** \brief Record the addition or removal of a node */
+    void record_node(Op op, ComponentNode const& node);
+    /** \brief Record the addition or removal of an edge */
+    void record_edge(Op op, WireEdge const& edge);
+    /** \brief Record the attachment or detachment of a wire end */
+    void record_conn(Op op, ComponentNode const& node, ConnectionPortIdx port, WireEdge const& edge, WireEdge::Side side);
+
+    /** \brief Apply every edit of a step in order, or the inverse of every edit in reverse order */
+    void replay(Step const& step, bool forward);
+    /** \brief Apply a single decoded edit to the graph */
+    void apply(BoardGraph& graph, Delta const& delta);
+    /** \brief Discard the oldest steps until the history fits in the capacity */
+    void trim();
+    /** \brief Bring the history back within the capacity after the open step grew or the capacity shrank */
+    void fit();
+};
@@ -0,0 +1,268 @@
+#include "kernel.hpp"
+#include "component.hpp"
+#include "lib.hpp"
+
+#include <algorithm>
+#include <doctest.h>
+
+namespace kernel {
+
+Outline::Outline(Footprint const& footprint, Point const& offset) {
+    const SingleVec<RawPoint>& pts = footprint;
+    const std::size_t n = pts.size();
+    if(n < 2) {
+        return;
+    }
+
+    this->m_x0.resize(n);
+    this->m_y0.resize(n);
+    this->m_x1.resize(n);
+    this->m_y1.resize(n);
+    this->m_slope.resize(n);
+    const RawPoint origin = offset.raw();
+    for(std::size_t i = 0; i < n; ++i) {
+        const RawPoint at = pts[i] + origin;
+        this->m_x0[i] = coord::to_normalized(at.x);
+        this->m_y0[i] = coord::to_normalized(at.y);
+    }
+    for(std::size_t i = 0; i < n; ++i) {
+        const std::size_t next = (i + 1 == n) ? 0 : i + 1;
+        this->m_x1[i] = this->m_x0[next];
+        this->m_y1[i] = this->m_y0[next];
+        const float dy = this->m_y1[i] - this->m_y0[i];
+        this->m_slope[i] = (dy == 0) ? 0 : (this->m_x1[i] - this->m_x0[i]) / dy;
+    }
+
+    const auto [minx, maxx] = std::minmax_element(this->m_x0.begin(), this->m_x0.end());
+    const auto [miny, maxy] = std::minmax_element(this->m_y0.begin(), this->m_y0.end());
+    this->m_min[0] = *minx;
+    this->m_min[1] = *miny;
+    this->m_max[0] = *maxx;
+    this->m_max[1] = *maxy;
+}
+
+Outline Outline::of(ComponentNode const& node) {
+    return Outline{node.type()->footprint(), node.pos()};
+}
+
+bool Outline::contains(float x, float y) const noexcept {
+    if(!this->bounded(x, y, x, y)) {
+        return false;
+    }
+    //Even-odd rule, counting the edges that a ray cast in the +x direction from the point crosses
+    unsigned crossings = 0;
+    for(std::size_t e = 0; e < this->size(); ++e) {
+        const bool spans = (this->m_y0[e] > y) != (this->m_y1[e] > y);
+        const bool right = x < this->m_x0[e] + (y - this->m_y0[e]) * this->m_slope[e];
+        crossings += spans & right;
+    }
+    return crossings & 1;
+}
+
+void Outline::contains(std::span<const float> xs, std::span<const float> ys, std::span<std::uint8_t> out) const noexcept {
+    assert(xs.size() == ys.size() && xs.size() == out.size());
+    const std::size_t n = this->size();
+    for(std::size_t begin = 0; begin < xs.size(); begin += BLOCK) {
+        const std::size_t len = std::min(BLOCK, xs.size() - begin);
+        //Copied into fixed size blocks so that the inner loop has a constant trip count, the last block is padded
+        float px[BLOCK]{};
+        float py[BLOCK]{};
+        std::copy_n(xs.data() + begin, len, px);
+        std::copy_n(ys.data() + begin, len, py);
+
+        //Each edge is tested against a whole block of points so that the inner loop is the same for every lane
+        std::uint32_t crossings[BLOCK]{};
+        for(std::size_t e = 0; e < n; ++e) {
+            const float x0 = this->m_x0[e];
+            const float y0 = this->m_y0[e];
+            const float y1 = this->m_y1[e];
+            const float slope = this->m_slope[e];
+            for(std::size_t i = 0; i < BLOCK; ++i) {
+                const std::uint32_t spans = (y0 > py[i]) != (y1 > py[i]);
+                const std::uint32_t right = px[i] < x0 + (py[i] - y0) * slope;
+                crossings[i] ^= spans & right;
+            }
+        }
+        for(std::size_t i = 0; i < len; ++i) {
+            out[begin + i] = static_cast<std::uint8_t>(crossings[i]);
+        }
+    }
+}
+
+std::vector<std::uint8_t> Outline::contains(std::span<const Point> pts) const {
+    std::vector<std::uint8_t> out(pts.size(), 0);
+    float xs[BLOCK];
+    float ys[BLOCK];
+    for(std::size_t begin = 0; begin < pts.size(); begin += BLOCK) {
+        const std::size_t len = std::min(BLOCK, pts.size() - begin);
+        for(std::size_t i = 0; i < len; ++i) {
+            xs[i] = pts[begin + i].x.normalized();
+            ys[i] = pts[begin + i].y.normalized();
+        }
+        this->contains(
+            std::span<const float>{xs, len},
+            std::span<const float>{ys, len},
+            std::span<std::uint8_t>{out.data() + begin, len}
+        );
+    }
+    return out;
+}
+
+bool Outline::intersects(AABB const& box) const noexcept {
+    const float minx = coord::to_normalized(box.min.x);
+    const float miny = coord::to_normalized(box.min.y);
+    const float maxx = coord::to_normalized(box.max.x);
+    const float maxy = coord::to_normalized(box.max.y);
+    if(!this->bounded(minx, miny, maxx, maxy)) {
+        return false;
+    }
+
+    //An edge touches the box when their bounds overlap and the box's corners are not all on one side of the edge
+    bool hit = false;
+    for(std::size_t e = 0; e < this->size(); ++e) {
+        const float x0 = this->m_x0[e];
+        const float y0 = this->m_y0[e];
+        const float dx = this->m_x1[e] - x0;
+        const float dy = this->m_y1[e] - y0;
+        const bool overlaps = (std::min(x0, this->m_x1[e]) <= maxx) & (minx <= std::max(x0, this->m_x1[e])) &
+            (std::min(y0, this->m_y1[e]) <= maxy) & (miny <= std::max(y0, this->m_y1[e]));
+        const float c0 = dx * (miny - y0) - dy * (minx - x0);
+        const float c1 = dx * (miny - y0) - dy * (maxx - x0);
+        const float c2 = dx * (maxy - y0) - dy * (minx - x0);
+        const float c3 = dx * (maxy - y0) - dy * (maxx - x0);
+        const bool straddles = (std::min(std::min(c0, c1), std::min(c2, c3)) <= 0) &
+            (std::max(std::max(c0, c1), std::max(c2, c3)) >= 0);
+        hit |= overlaps & straddles;
+    }
+    //With no edge touching the box, the box is either outside the outline or entirely inside it
+    return hit || this->contains(minx, miny);
+}
+
+bool Outline::intersects(Point const& a, Point const& b) const noexcept {
+    const float ax = a.x.normalized();
+    const float ay = a.y.normalized();
+    const float bx = b.x.normalized();
+    const float by = b.y.normalized();
+    if(!this->bounded(std::min(ax, bx), std::min(ay, by), std::max(ax, bx), std::max(ay, by))) {
+        return false;
+    }
+    //With no edge crossed the segment is either outside the outline or entirely inside it
+    return this->crosses(ax, ay, bx, by) || this->contains(ax, ay);
+}
+
+bool Outline::intersects(Outline const& other) const noexcept {
+    if(other.m_x0.empty() || !this->bounded(other.m_min[0], other.m_min[1], other.m_max[0], other.m_max[1])) {
+        return false;
+    }
+    for(std::size_t e = 0; e < other.size(); ++e) {
+        if(this->crosses(other.m_x0[e], other.m_y0[e], other.m_x1[e], other.m_y1[e])) {
+            return true;
+        }
+    }
+    //With no crossing edges the outlines are either disjoint or one lies entirely inside the other
+    return this->contains(other.m_x0[0], other.m_y0[0]) || other.contains(this->m_x0[0], this->m_y0[0]);
+}
+
+bool Outline::crosses(float ax, float ay, float bx, float by) const noexcept {
+    //Two segments touch when each one's ends are not both strictly on one side of the other, checking their bounds
+    //as well rules out collinear segments that do not overlap
+    const float sx = bx - ax;
+    const float sy = by - ay;
+    bool hit = false;
+    for(std::size_t e = 0; e < this->size(); ++e) {
+        const float x0 = this->m_x0[e];
+        const float y0 = this->m_y0[e];
+        const float x1 = this->m_x1[e];
+        const float y1 = this->m_y1[e];
+        const float d0 = sx * (y0 - ay) - sy * (x0 - ax);
+        const float d1 = sx * (y1 - ay) - sy * (x1 - ax);
+        const float d2 = (x1 - x0) * (ay - y0) - (y1 - y0) * (ax - x0);
+        const float d3 = (x1 - x0) * (by - y0) - (y1 - y0) * (bx - x0);
+        const bool overlaps = (std::min(x0, x1) <= std::max(ax, bx)) & (std::min(ax, bx) <= std::max(x0, x1)) &
+            (std::min(y0, y1) <= std::max(ay, by)) & (std::min(ay, by) <= std::max(y0, y1));
+        hit |= overlaps & (d0 * d1 <= 0) & (d2 * d3 <= 0);
+    }
+    return hit;
+}
+}
+
+TEST_CASE("Outline") {
+    //An L shape with a notch cut out of the upper right
+    SingleVec<RawPoint> pts{Point{0._m, 0._m}.raw()};
+    pts.push_back(Point{4._m, 0._m}.raw());
+    pts.push_back(Point{4._m, 2._m}.raw());
+    pts.push_back(Point{2._m, 2._m}.raw());
+    pts.push_back(Point{2._m, 4._m}.raw());
+    pts.push_back(Point{0._m, 4._m}.raw());
+    const kernel::Outline outline{Footprint{std::move(pts)}, Point{1._m, 1._m}};
+    REQUIRE(outline.size() == 6);
+
+    SUBCASE("Contains") {
+        CHECK(outline.contains(Point{2._m, 2._m}));
+        CHECK(outline.contains(Point{4.5_m, 2.5_m}));
+        CHECK(outline.contains(Point{1.5_m, 4.5_m}));
+        CHECK_FALSE(outline.contains(Point{4._m, 4._m}));
+        CHECK_FALSE(outline.contains(Point{0.5_m, 2._m}));
+        CHECK_FALSE(outline.contains(Point{6._m, 2._m}));
+        CHECK_FALSE(kernel::Outline{}.contains(Point{0._m, 0._m}));
+    }
+
+    SUBCASE("Batched") {
+        std::vector<Point> queries{};
+        for(int i = 0; i < 200; ++i) {
+            queries.push_back(Point{Length{(i % 20) * 0.3f}, Length{(i / 20) * 0.6f}});
+        }
+        const std::vector<std::uint8_t> inside = outline.contains(queries);
+        REQUIRE(inside.size() == queries.size());
+        for(std::size_t i = 0; i < queries.size(); ++i) {
+            CHECK(static_cast<bool>(inside[i]) == outline.contains(queries[i]));
+        }
+    }
+
+    SUBCASE("Box") {
+        CHECK(outline.intersects(AABB{Point{2._m, 2._m}, Point{2.5_m, 2.5_m}}));
+        CHECK(outline.intersects(AABB{Point{-1._m, -1._m}, Point{8._m, 8._m}}));
+        CHECK(outline.intersects(AABB{Point{4.5_m, 2.5_m}, Point{6._m, 6._m}}));
+        CHECK(outline.intersects(AABB{Point{5._m, 3._m}, Point{6._m, 4._m}}));
+        CHECK_FALSE(outline.intersects(AABB{Point{3.5_m, 3.5_m}, Point{6._m, 6._m}}));
+        CHECK_FALSE(outline.intersects(AABB{Point{-2._m, -2._m}, Point{0.5_m, 8._m}}));
+    }
+
+    SUBCASE("Segment") {
+        CHECK(outline.intersects(Point{2._m, 2._m}, Point{2.5_m, 2.5_m}));
+        CHECK(outline.intersects(Point{0._m, 2._m}, Point{8._m, 2._m}));
+        CHECK(outline.intersects(Point{5._m, 3._m}, Point{6._m, 3._m}));
+        CHECK(outline.intersects(Point{4._m, 4._m}, Point{2._m, 6._m}));
+        CHECK_FALSE(outline.intersects(Point{3.5_m, 3.5_m}, Point{6._m, 6._m}));
+        CHECK_FALSE(outline.intersects(Point{4._m, 3.5_m}, Point{4._m, 6._m}));
+        CHECK_FALSE(outline.intersects(Point{0._m, 0._m}, Point{0._m, 8._m}));
+    }
+
+    SUBCASE("Outline") {
+        //A 1m square placed with its lower left corner at the given position
+        const auto square = [](float x, float y, float size = 1.f) {
+            SingleVec<RawPoint> pts{Point{Length{x}, Length{y}}.raw()};
+            pts.push_back(Point{Length{x + size}, Length{y}}.raw());
+            pts.push_back(Point{Length{x + size}, Length{y + size}}.raw());
+            pts.push_back(Point{Length{x}, Length{y + size}}.raw());
+            return kernel::Outline{Footprint{std::move(pts)}};
+        };
+        //Crossing edges, touching at a single corner, and touching along edges of the L and of its notch
+        CHECK(outline.intersects(square(0.5f, 0.5f)));
+        CHECK(outline.intersects(square(5.f, 3.f)));
+        CHECK(outline.intersects(square(5.f, 1.f)));
+        CHECK(square(5.f, 1.f).intersects(outline));
+        CHECK(square(3.f, 3.f).intersects(outline));
+        //Entirely inside the L, and the L entirely inside a large square, both ways around
+        CHECK(outline.intersects(square(1.25f, 1.25f, 0.5f)));
+        CHECK(square(1.25f, 1.25f, 0.5f).intersects(outline));
+        CHECK(outline.intersects(square(-1.f, -1.f, 8.f)));
+        CHECK(square(-1.f, -1.f, 8.f).intersects(outline));
+        //Inside the bounds of the L but in its notch, and clear of it
+        CHECK_FALSE(outline.intersects(square(3.5f, 3.5f)));
+        CHECK_FALSE(square(3.5f, 3.5f).intersects(outline));
+        CHECK_FALSE(outline.intersects(square(6.f, 6.f)));
+        CHECK_FALSE(outline.intersects(kernel::Outline{}));
+        CHECK_FALSE(kernel::Outline{}.intersects(outline));
+    }
+}
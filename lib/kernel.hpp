@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "geom.hpp"
+
+/**
+ * \brief Exact geometry tests against footprints, laid out so that the compiler can vectorize the inner loops
+ */
+namespace kernel {
+
+/**
+ * \brief A footprint placed on the workspace, stored as one array per edge coordinate instead of as a list of
+ * points so that each test runs the same arithmetic over every edge, or over a block of query points, without
+ * branching. The outline is closed, the last point connects back to the first, and may be concave.
+ *
+ * All coordinates are normalized lengths
+ */
+class Outline {
+public:
+    /** \brief Number of query points tested together against every edge by the batched containment test */
+    static constexpr const std::size_t BLOCK = 64;
+
+    /** \brief Create an outline with no edges that contains and intersects nothing */
+    Outline() = default;
+
+    /** \brief Create an outline from a footprint placed with its origin at `offset` */
+    explicit Outline(Footprint const& footprint, Point const& offset = Point{});
+
+    /** \brief Get the outline of a node's footprint at the node's current position */
+    static Outline of(ComponentNode const& node);
+
+    /** \brief Get the number of edges in this outline */
+    inline std::size_t size() const noexcept { return this->m_x0.size(); }
+
+    /** \brief Check if a point lies inside this outline, points on the outline itself may go either way */
+    bool contains(float x, float y) const noexcept;
+    inline bool contains(Point const& pt) const noexcept { return this->contains(pt.x.normalized(), pt.y.normalized()); }
+
+    /**
+     * \brief Check many points against this outline at once
+     * \param xs X coordinates of the query points
+     * \param ys Y coordinates of the query points, the same length as `xs`
+     * \param out Set to 1 for every point inside the outline and 0 otherwise, the same length as `xs`
+     */
+    void contains(std::span<const float> xs, std::span<const float> ys, std::span<std::uint8_t> out) const noexcept;
+    /** \brief Check many points against this outline at once, getting 1 for every point inside and 0 otherwise */
+    std::vector<std::uint8_t> contains(std::span<const Point> pts) const;
+
+    /** \brief Check if this outline shares any point with a box, including when either lies entirely inside the other */
+    bool intersects(AABB const& box) const noexcept;
+
+    /** \brief Check if the closed segment from `a` to `b` shares any point with this outline or its interior */
+    bool intersects(Point const& a, Point const& b) const noexcept;
+
+    /**
+     * \brief Check if two outlines share any point, including outlines that only touch along an edge or at a corner
+     * and outlines that lie entirely inside one another
+     */
+    bool intersects(Outline const& other) const noexcept;
+private:
+    /** \brief Start point of every edge */
+    std::vector<float> m_x0{};
+    std::vector<float> m_y0{};
+    /** \brief End point of every edge, which is the start point of the next */
+    std::vector<float> m_x1{};
+    std::vector<float> m_y1{};
+    /** \brief Change in x per unit of y along every edge, 0 for horizontal edges which no horizontal ray crosses */
+    std::vector<float> m_slope{};
+    /** \brief Bounds of every point in the outline */
+    float m_min[2]{0, 0};
+    float m_max[2]{0, 0};
+
+    /** \brief Check if the closed segment from (`ax`, `ay`) to (`bx`, `by`) touches any edge of this outline */
+    bool crosses(float ax, float ay, float bx, float by) const noexcept;
+
+    /** \brief Check if the bounds of this outline overlap the given box */
+    inline bool bounded(float minx, float miny, float maxx, float maxy) const noexcept {
+        return !this->m_x0.empty() &&
+            this->m_min[0] <= maxx && minx <= this->m_max[0] && this->m_min[1] <= maxy && miny <= this->m_max[1];
+    }
+};
+
+}
@@ -1,76 +1,235 @@
 #include "lib.hpp"
+#include "boardfile.hpp"
+#include "loader.hpp"
+#include "ser/writer.hpp"
 #include "component.hpp"
 #include "geom.hpp"
 #include "util/log.hpp"
+#include "util/mapped.hpp"
 #include "wire.hpp"
 #include <algorithm>
 #include <filesystem>
 #include <functional>
 #include <iomanip>
 #include <iostream>
+#include <sstream>
 #include <stdexcept>
 #include <unordered_set>
 #include <numeric>
+#include <utility>
+
+#include <doctest.h>
+
+#include "testing.hpp"
 
 Optional<std::reference_wrapper<const ConnectionPort>> WireEdge::Connection::port() const {
-    if(!this->is_floating()) {
-        return this->m_component.lock()->type()->get_port(this->m_port);
-    } else {
-        return {};
-    }
+    return this
+        ->node()
+        .map([this](const ComponentNode& node) { return node.type()->get_port(this->m_port); })
+        .flatten();
 }
 
-Point const& WireEdge::Connection::pos() const {
-    if(!this->is_floating()) {
-        return this
-            ->m_component
-            .lock()
-            ->type()
-            ->get_port(this->m_port)
-            .unwrap_unchecked()
-            .get()
-            .pos();
+Point WireEdge::Connection::pos() const {
+    //Attached ends of an edge in a snapshot have no graph to read the port from and hold its position instead
+    if(this->m_graph != nullptr) {
+        return Point{this->node().unwrap_unchecked().get().port_pos(this->m_port)};
     } else {
         return this->m_pos;
     }
 }
 
+Ref<ComponentNode> WireEdge::Connection::component() const {
+    if(this->m_graph == nullptr) {
+        return nullptr;
+    }
+    if(!this->m_graph->nodes.contains(this->m_node)) {
+        return nullptr;
+    }
+    return this->m_graph->node_ref(this->m_node.index);
+}
+
 void WireEdge::Connection::detach() {
     if(!this->is_floating()) {
-        auto component = this->m_component.lock();
-        this->m_pos = component->pos() + component
-            ->type()
-            ->get_port(this->m_port)
-            .unwrap_unchecked()
-            .get()
-            .pos();
-        this->m_component.lock()->remove_port(this->m_port);
-        this->m_component.reset();
+        GraphStorage *graph = this->m_graph;
+        ComponentNode *component = graph->nodes.get(this->m_node);
+        const ConnectionPortIdx port = this->m_port;
+        this->m_graph = nullptr;
+        this->m_node = ArenaHandle<ComponentNode>{};
+        if(component == nullptr) {
+            this->m_pos = Point{};
+            return;
+        }
+        this->m_pos = Point{component->port_pos(port)};
+        auto entry = component->m_edges.find(port);
+        if(entry == component->m_edges.end()) {
+            return;
+        }
+        const ComponentNode::EdgeConnection edge = entry->second;
+        graph->edges.touch(edge.edge.index);
+        component->remove_port(port);
+        graph->observers.notify([component, port, &edge, &wire = graph->edges.at(edge.edge.index)](GraphObserver& observer) {
+            observer.detached(*component, port, wire, edge.side);
+        });
+    }
+}
+
+void WireEdge::freeze() noexcept {
+    for(Connection& conn : this->m_conns) {
+        if(conn.m_graph != nullptr) {
+            if(const ComponentNode *node = std::as_const(conn.m_graph->nodes).get(conn.m_node)) {
+                conn.m_pos = Point{node->port_pos(conn.m_port)};
+            }
+            conn.m_graph = nullptr;
+        }
+    }
+    this->m_anchor.reset();
+}
+
+namespace {
+
+/**
+ * \brief Deleter of the control block shared by every `Ref` to one element of a graph's storage, run once the last
+ * of them is dropped. Frees the element's slot if the element was retired while it was still referenced
+ * \tparam Member The arena of `GraphStorage` that holds the element
+ */
+template<auto Member>
+struct Anchor {
+    Ref<GraphStorage> storage;
+    std::uint32_t pos;
+
+    void operator()(void *) const {
+        auto& arena = (*this->storage).*Member;
+        if(arena.retired(this->pos)) {
+            arena.release(this->pos);
+        }
+    }
+};
+
+}
+
+template<auto Member>
+auto GraphStorage::anchored(std::uint32_t pos) {
+    auto& elem = (this->*Member).at(pos);
+    Ref<void> anchor = elem.m_anchor;
+    if(anchor == nullptr) {
+        anchor = Ref<void>{static_cast<void*>(this), Anchor<Member>{this->shared_from_this(), pos}};
+        if(!this->m_orphaned) {
+            elem.m_anchor = anchor;
+        }
+    }
+    return Ref<std::remove_reference_t<decltype(elem)>>{std::move(anchor), &elem};
+}
+
+template<auto Member>
+void GraphStorage::unanchor(std::uint32_t pos) {
+    //A `Ref` still held must not end up aliasing whatever is placed in the slot next
+    auto& arena = this->*Member;
+    const Ref<void> anchor = std::move(arena.at(pos).m_anchor);
+    if(anchor == nullptr || anchor.use_count() == 1) {
+        arena.erase(pos);
+    } else {
+        arena.retire(pos);
+    }
+}
+
+void GraphStorage::Owner::orphan() noexcept {
+    if(this->m_storage == nullptr) {
+        return;
+    }
+    this->m_storage->m_orphaned = true;
+    this->m_storage->graph = nullptr;
+    for(ComponentNode& node : this->m_storage->nodes) {
+        node.m_anchor.reset();
     }
+    for(WireEdge& edge : this->m_storage->edges) {
+        edge.m_anchor.reset();
+    }
+}
+
+Ref<ComponentNode> GraphStorage::node_ref(Arena<ComponentNode>::size_type pos) {
+    return this->anchored<&GraphStorage::nodes>(pos);
+}
+
+Ref<WireEdge> GraphStorage::edge_ref(Arena<WireEdge>::size_type pos) {
+    return this->anchored<&GraphStorage::edges>(pos);
+}
+
+void GraphStorage::erase_node(Arena<ComponentNode>::size_type pos) {
+    //A retired node keeps its data for the `Ref`s still held, but no longer belongs to the graph
+    this->nodes.at(pos).m_graph = nullptr;
+    this->unanchor<&GraphStorage::nodes>(pos);
+}
+
+void GraphStorage::erase_edge(Arena<WireEdge>::size_type pos) {
+    this->unanchor<&GraphStorage::edges>(pos);
 }
 
 Optional<std::reference_wrapper<ComponentNode::EdgeConnection>> ComponentNode::connnect_port(ConnectionPortIdx port, Ref<WireEdge> edge, const WireEdge::Side side, bool force) {
     auto elem = this->m_ty->get_port(port);
-    if(!elem.has_value()) {
+    //Wire ends refer to nodes by handle, so both must live in the same graph storage
+    if(!elem.has_value() || this->m_graph == nullptr || this->m_graph->edges.get(edge->m_handle) != edge.get()) {
         return {};
     }
-    auto [inserted, good] = this->m_edges.try_emplace(port, edge, side);
-    if(!good) {
-        if(force) {
-            auto existing = this->m_edges.find(port);
-            if(existing == this->m_edges.end()) {
-                return {};
-            }
-            existing->second.edge->side(existing->second.side).detach();
-            existing->second.edge = edge;
-            existing->second.side = side;
-            return std::ref(existing->second);
+    
+    auto existing = this->m_edges.find(port);
+    if(existing != this->m_edges.end()) {
+        if(!force) {
+            return {};
         }
-        return {};
+        //Detaching removes the entry from m_edges, so copy the connection out before invalidating the iterator
+        const EdgeConnection old = existing->second;
+        WireEdge *old_edge = this->m_graph->edges.get(old.edge);
+        if(old_edge != nullptr) {
+            old_edge->side(old.side).detach();
+        }
+        this->m_edges.erase(port);
     }
+
+    WireEdge::Connection& conn = edge->side(side);
+    conn.detach();
+    this->m_graph->nodes.touch(this->m_handle);
+    this->m_graph->edges.touch(edge->m_handle.index);
+    conn.m_graph = this->m_graph;
+    conn.m_node = this->m_graph->nodes.handle(this->m_handle);
+    conn.m_port = port;
+    auto [inserted, good] = this->m_edges.try_emplace(port, edge->m_handle, side);
+    this->m_graph->observers.notify([this, port, &edge, side](GraphObserver& observer) { observer.connected(*this, port, *edge, side); });
     return std::ref(inserted->second);
 }
 
+void ComponentNode::move_to(Point pos) {
+    const Point from = this->m_pos;
+    this->m_pos = pos;
+    this->place();
+    if(this->m_graph != nullptr) {
+        this->m_graph->nodes.touch(this->m_handle);
+        //Snapshots store the position of attached wire ends, so the edges attached here must be copied again
+        for(const auto& [port, conn] : this->m_edges) {
+            this->m_graph->edges.touch(conn.edge.index);
+        }
+        this->m_graph->observers.notify([this, from](GraphObserver& observer) { observer.moved(*this, from); });
+    }
+}
+
+void ComponentNode::freeze() noexcept {
+    this->m_graph = nullptr;
+    this->m_anchor.reset();
+}
+
+void ComponentNode::place() {
+    this->m_aabb = this->m_ty->footprint().aabb() + this->m_pos;
+    this->m_port_pos.resize(this->m_ty->port_slots());
+    for(auto port = this->m_ty->begin(); port != this->m_ty->end(); ++port) {
+        this->m_port_pos[port.index()] = this->m_pos.raw() + port->pos().raw();
+    }
+}
+
+void ComponentNode::remove_port(ConnectionPortIdx port) {
+    if(this->m_edges.erase(port) != 0 && this->m_graph != nullptr) {
+        this->m_graph->nodes.touch(this->m_handle);
+    }
+}
+
 Optional<std::reference_wrapper<ComponentNode::EdgeConnection>> ComponentNode::port(ConnectionPortIdx port) {
     auto elem = this->m_edges.find(port);
     if(elem == this->m_edges.end()) {
@@ -81,145 +240,469 @@ Optional<std::reference_wrapper<ComponentNode::EdgeConnection>> ComponentNode::p
 }
 
 Ref<ComponentNode> BoardGraph::component(Ref<Component> type, const std::string& id, Point pos, const std::string_view name) {
-    Ref<ComponentNode> node{new ComponentNode()};
-    node->m_ty = type;
-    node->m_pos = pos;
-    node->m_aabb = type->footprint().aabb() + pos;
-    auto [elem, _] = this->m_nodes.emplace(id, node);
-    node->m_id = std::string_view{elem->first};
+    auto [elem, inserted] = this->m_node_ids.emplace(Symbol::intern(id), Arena<ComponentNode>::npos);
+    if(!inserted) {
+        throw std::runtime_error{fmt::format("A node with ID {} already exists in the graph", id)};
+    }
+    NodeHandle handle = this->m_storage->nodes.emplace();
+    this->adopt(handle);
+    ComponentNode& node = this->m_storage->nodes.at(handle);
+    node.m_ty = type;
+    node.m_pos = pos;
+    node.place();
+    node.m_id = elem->first;
     if(!name.empty()) {
-        node->m_name = name;
+        node.m_name = name;
     }
-    return node;
+    elem->second = handle;
+    this->tally(node, true);
+    this->m_storage->observers.notify([&node](GraphObserver& observer) { observer.node_added(node); });
+    return this->node_ref(handle);
+}
+
+BoardGraph::Inserted BoardGraph::insert(std::span<const NodeDesc> nodes, std::span<const EdgeDesc> edges) {
+    //A port that a wire end attaches to, on either a node of this batch or a node already in the graph
+    struct Target {
+        bool batch;
+        std::uint32_t node;
+        ConnectionPortIdx port;
+
+        constexpr inline auto operator<=>(Target const& other) const noexcept = default;
+    };
+    struct End {
+        Ref<Connector> connector;
+        bool attached;
+        Target target;
+    };
+
+    //Resolve everything up front so that a bad descriptor leaves the graph untouched. IDs are only looked up, not
+    //interned, until the whole batch has been validated so that a rejected batch leaves no strings behind
+    std::vector<Ref<Component>> types{};
+    Map<std::string_view, std::uint32_t> batch_nodes{};
+    Map<std::string_view, Ref<Component>> type_cache{};
+    types.reserve(nodes.size());
+    batch_nodes.reserve(nodes.size());
+    for(std::uint32_t i = 0; const NodeDesc& desc : nodes) {
+        const Optional<Symbol> id = Symbol::find(desc.id);
+        if((id.has_value() && this->m_node_ids.contains(id.unwrap_unchecked())) || !batch_nodes.try_emplace(desc.id, i).second) {
+            throw std::runtime_error{fmt::format("A node with ID {} already exists in the graph", desc.id)};
+        }
+        auto [type, missing] = type_cache.try_emplace(desc.type);
+        if(missing) {
+            type->second = this->m_res.try_get<Component>(desc.type);
+        }
+        types.push_back(type->second);
+        i += 1;
+    }
+
+    std::vector<std::array<End, 2>> ends{};
+    std::vector<Target> claimed{};
+    Map<std::string_view, std::uint32_t> batch_edges{};
+    Map<std::string_view, Ref<Connector>> connector_cache{};
+    ends.reserve(edges.size());
+    batch_edges.reserve(edges.size());
+    for(std::uint32_t i = 0; const EdgeDesc& desc : edges) {
+        const Optional<Symbol> id = Symbol::find(desc.id);
+        if((id.has_value() && this->m_edge_ids.contains(id.unwrap_unchecked())) || !batch_edges.try_emplace(desc.id, i).second) {
+            throw std::runtime_error{fmt::format("An edge with ID {} already exists in the graph", desc.id)};
+        }
+
+        std::array<End, 2>& resolved = ends.emplace_back();
+        for(std::size_t side = 0; side < desc.ends.size(); ++side) {
+            const EdgeDesc::End& end = desc.ends[side];
+            auto [connector, missing] = connector_cache.try_emplace(end.connector);
+            if(missing) {
+                connector->second = this->m_res.try_get<Connector>(end.connector);
+            }
+            resolved[side].connector = connector->second;
+            resolved[side].attached = !end.node.empty();
+            if(!resolved[side].attached) {
+                continue;
+            }
+
+            Target& target = resolved[side].target;
+            Component const *type = nullptr;
+            auto in_batch = batch_nodes.find(end.node);
+            if(in_batch != batch_nodes.end()) {
+                target.batch = true;
+                target.node = in_batch->second;
+                type = types[in_batch->second].get();
+            } else {
+                //Errors are only formatted on failure, this loop runs for every wire end of a large import
+                const Optional<NodeHandle> existing = Symbol::find(end.node)
+                    .map([this](Symbol sym) { return this->node_handle(sym); })
+                    .flatten();
+                if(!existing.has_value()) {
+                    throw std::runtime_error{fmt::format("Edge {} connects to nonexistent node with {}", desc.id, end.node)};
+                }
+                target.batch = false;
+                target.node = existing.unwrap_unchecked();
+                type = this->m_storage->nodes.at(target.node).type().get();
+            }
+            const Optional<ConnectionPortIdx> port = type->get_port_idx(end.port);
+            if(!port.has_value()) {
+                throw std::runtime_error{fmt::format("Component {} has no port with ID {}", type->id(), end.port)};
+            }
+            target.port = port.unwrap_unchecked();
+            if(!target.batch && this->m_storage->nodes.at(target.node).m_edges.contains(target.port)) {
+                throw std::runtime_error{fmt::format("Port {} of node {} is already connected", end.port, end.node)};
+            }
+            claimed.push_back(target);
+        }
+        i += 1;
+    }
+
+    std::sort(claimed.begin(), claimed.end());
+    if(std::adjacent_find(claimed.begin(), claimed.end()) != claimed.end()) {
+        throw std::runtime_error{"A port cannot be connected by more than one wire end"};
+    }
+
+    std::vector<Symbol> node_ids{};
+    std::vector<Symbol> edge_ids{};
+    node_ids.reserve(nodes.size());
+    edge_ids.reserve(edges.size());
+    for(const NodeDesc& desc : nodes) {
+        node_ids.push_back(Symbol::intern(desc.id));
+    }
+    for(const EdgeDesc& desc : edges) {
+        edge_ids.push_back(Symbol::intern(desc.id));
+    }
+
+    GraphStorage& storage = *this->m_storage;
+    storage.nodes.reserve(static_cast<std::size_t>(storage.nodes.slots()) + nodes.size());
+    storage.edges.reserve(static_cast<std::size_t>(storage.edges.slots()) + edges.size());
+    this->m_node_ids.reserve(this->m_node_ids.size() + nodes.size());
+    this->m_edge_ids.reserve(this->m_edge_ids.size() + edges.size());
+
+    Inserted inserted{};
+    inserted.nodes.reserve(nodes.size());
+    inserted.edges.reserve(edges.size());
+    for(std::size_t i = 0; i < nodes.size(); ++i) {
+        const NodeHandle handle = storage.nodes.emplace(node_ids[i]);
+        this->adopt(handle);
+        ComponentNode& node = storage.nodes.at(handle);
+        node.m_ty = std::move(types[i]);
+        node.m_name = nodes[i].name;
+        node.m_pos = nodes[i].pos;
+        node.place();
+        this->m_node_ids.emplace(node_ids[i], handle);
+        this->tally(node, true);
+        inserted.nodes.push_back(handle);
+    }
+
+    for(std::size_t i = 0; i < edges.size(); ++i) {
+        const EdgeHandle handle = storage.edges.emplace();
+        WireEdge& edge = storage.edges.at(handle);
+        edge.m_id = edge_ids[i];
+        edge.m_handle = storage.edges.handle(handle);
+        edge.m_wire_pts.assign(edges[i].points.begin(), edges[i].points.end());
+        for(std::size_t side = 0; side < edge.m_conns.size(); ++side) {
+            WireEdge::Connection& conn = edge.m_conns[side];
+            const End& end = ends[i][side];
+            conn.m_connector = end.connector;
+            if(!end.attached) {
+                conn.m_pos = edges[i].ends[side].pos;
+                continue;
+            }
+            const NodeHandle node = end.target.batch ? inserted.nodes[end.target.node] : end.target.node;
+            conn.m_graph = &storage;
+            conn.m_node = storage.nodes.handle(node);
+            conn.m_port = end.target.port;
+            storage.nodes.at(node).m_edges.emplace(end.target.port, ComponentNode::EdgeConnection{
+                .edge = edge.m_handle,
+                .side = static_cast<WireEdge::Side>(side)
+            });
+            storage.nodes.touch(node);
+        }
+        this->m_edge_ids.emplace(edge.m_id, handle);
+        this->tally(edge, true);
+        inserted.edges.push_back(handle);
+    }
+
+    for(NodeHandle handle : inserted.nodes) {
+        storage.observers.notify([&node = storage.nodes.at(handle)](GraphObserver& observer) { observer.node_added(node); });
+    }
+    for(EdgeHandle handle : inserted.edges) {
+        storage.observers.notify([&edge = storage.edges.at(handle)](GraphObserver& observer) { observer.edge_added(edge); });
+    }
+    for(EdgeHandle handle : inserted.edges) {
+        const WireEdge& edge = storage.edges.at(handle);
+        for(std::size_t side = 0; side < edge.m_conns.size(); ++side) {
+            const WireEdge::Connection& conn = edge.m_conns[side];
+            if(!conn.is_floating()) {
+                const ComponentNode& node = storage.nodes.at(conn.m_node.index);
+                storage.observers.notify([&node, &conn, &edge, side](GraphObserver& observer) {
+                    observer.connected(node, conn.m_port, edge, static_cast<WireEdge::Side>(side));
+                });
+            }
+        }
+    }
+
+    return inserted;
+}
+
+Ref<WireEdge> BoardGraph::edge(const std::string& id, std::array<Ref<Connector>, 2> connectors, std::array<Point, 2> ends, std::vector<RawPoint> points) {
+    auto [elem, inserted] = this->m_edge_ids.emplace(Symbol::intern(id), Arena<WireEdge>::npos);
+    if(!inserted) {
+        throw std::runtime_error{fmt::format("An edge with ID {} already exists in the graph", id)};
+    }
+    EdgeHandle handle = this->m_storage->edges.emplace();
+    WireEdge& edge = this->m_storage->edges.at(handle);
+    edge.m_id = elem->first;
+    edge.m_handle = this->m_storage->edges.handle(handle);
+    edge.m_wire_pts = std::move(points);
+    for(std::size_t side = 0; side < edge.m_conns.size(); ++side) {
+        edge.m_conns[side].m_connector = std::move(connectors[side]);
+        edge.m_conns[side].m_pos = ends[side];
+    }
+    elem->second = handle;
+    this->tally(edge, true);
+    this->m_storage->observers.notify([&edge](GraphObserver& observer) { observer.edge_added(edge); });
+    return this->edge_ref(handle);
+}
+
+void BoardGraph::remove_node(NodeHandle handle) {
+    if(!this->m_storage->nodes.contains(handle)) {
+        throw std::runtime_error{fmt::format("Attempt to remove nonexistent node with handle {}", handle)};
+    }
+    ComponentNode& node = this->m_storage->nodes.at(handle);
+    while(!node.m_edges.empty()) {
+        //Detaching erases the entry, so copy it out first
+        const ComponentNode::EdgeConnection conn = node.m_edges.begin()->second;
+        this->m_storage->edges.at(conn.edge.index).side(conn.side).detach();
+    }
+    this->m_storage->observers.notify([&node](GraphObserver& observer) { observer.node_removed(node); });
+    this->tally(node, false);
+    this->m_node_ids.erase(node.m_id);
+    this->m_storage->erase_node(handle);
+}
+
+void BoardGraph::remove_edge(EdgeHandle handle) {
+    if(!this->m_storage->edges.contains(handle)) {
+        throw std::runtime_error{fmt::format("Attempt to remove nonexistent edge with handle {}", handle)};
+    }
+    WireEdge& edge = this->m_storage->edges.at(handle);
+    for(WireEdge::Connection& conn : edge.m_conns) {
+        conn.detach();
+    }
+    this->m_storage->observers.notify([&edge](GraphObserver& observer) { observer.edge_removed(edge); });
+    this->tally(edge, false);
+    this->m_edge_ids.erase(edge.m_id);
+    this->m_storage->erase_edge(handle);
+}
+
+void BoardGraph::reroute(EdgeHandle handle, std::vector<RawPoint> points) {
+    if(!this->m_storage->edges.contains(handle)) {
+        throw std::runtime_error{fmt::format("Attempt to reroute nonexistent edge with handle {}", handle)};
+    }
+    WireEdge& edge = this->m_storage->edges.at(handle);
+    std::swap(edge.m_wire_pts, points);
+    this->m_storage->edges.touch(handle);
+    this->m_storage->observers.notify([&edge, &points](GraphObserver& observer) { observer.rerouted(edge, points); });
+}
+
+void BoardGraph::tally(ComponentNode const& node, bool added) {
+    if(added) {
+        this->m_component_counts[node.m_ty] += 1;
+    } else if(auto entry = this->m_component_counts.find(node.m_ty); entry != this->m_component_counts.end() && --entry->second == 0) {
+        this->m_component_counts.erase(entry);
+    }
+}
+
+void BoardGraph::tally(WireEdge const& edge, bool added) {
+    for(const WireEdge::Connection& conn : edge.m_conns) {
+        if(added) {
+            this->m_connector_counts[conn.m_connector] += 1;
+        } else if(auto entry = this->m_connector_counts.find(conn.m_connector); entry != this->m_connector_counts.end() && --entry->second == 0) {
+            this->m_connector_counts.erase(entry);
+        }
+    }
+}
+
+std::size_t BoardGraph::count(Ref<Component> const& type) const {
+    auto entry = this->m_component_counts.find(type);
+    return entry == this->m_component_counts.end() ? 0 : entry->second;
+}
+
+std::size_t BoardGraph::count(Ref<Connector> const& type) const {
+    auto entry = this->m_connector_counts.find(type);
+    return entry == this->m_connector_counts.end() ? 0 : entry->second;
+}
+
+Ref<ComponentNode> BoardGraph::node_ref(NodeHandle handle) const {
+    if(!this->m_storage->nodes.contains(handle)) {
+        throw std::runtime_error{fmt::format("Attempt to reference nonexistent node with handle {}", handle)};
+    }
+    return this->m_storage->node_ref(handle);
+}
+
+Ref<WireEdge> BoardGraph::edge_ref(EdgeHandle handle) const {
+    if(!this->m_storage->edges.contains(handle)) {
+        throw std::runtime_error{fmt::format("Attempt to reference nonexistent edge with handle {}", handle)};
+    }
+    return this->m_storage->edge_ref(handle);
+}
+
+void BoardGraph::adopt(NodeHandle handle) {
+    ComponentNode& node = this->m_storage->nodes.at(handle);
+    node.m_handle = handle;
+    node.m_graph = this->m_storage.get();
 }
 
 Optional<Ref<ComponentNode>> BoardGraph::get_node(const std::string_view id) const {
-    const auto& existing = this->m_nodes.find(id);
-    if(existing != this->m_nodes.end()) {
+    return Symbol::find(id)
+        .map([this](Symbol sym) { return this->get_node(sym); })
+        .flatten();
+}
+
+Optional<Ref<ComponentNode>> BoardGraph::get_node(Symbol id) const {
+    const auto& existing = this->m_node_ids.find(id);
+    if(existing != this->m_node_ids.end() && this->m_storage->nodes.contains(existing->second)) {
+        return this->node_ref(existing->second);
+    } else {
+        return {};
+    }
+}
+
+Optional<BoardGraph::NodeHandle> BoardGraph::node_handle(Symbol id) const {
+    const auto& existing = this->m_node_ids.find(id);
+    if(existing != this->m_node_ids.end() && this->m_storage->nodes.contains(existing->second)) {
         return existing->second;
     } else {
         return {};
     }
 }
 
-Optional<Ref<WireEdge>> BoardGraph::get_edge(const std::string_view id) const {
-    const auto& existing = this->m_edges.find(id);
-    if(existing != this->m_edges.end()) {
+Optional<BoardGraph::EdgeHandle> BoardGraph::edge_handle(Symbol id) const {
+    const auto& existing = this->m_edge_ids.find(id);
+    if(existing != this->m_edge_ids.end() && this->m_storage->edges.contains(existing->second)) {
         return existing->second;
     } else {
         return {};
     }
 }
 
-void BoardGraph::load_node(const std::string& id, const json& root_val) {
-    const auto existing = this->get_node(id);
-    if(existing.has_value()) {
-        return;
+Optional<Ref<WireEdge>> BoardGraph::get_edge(const std::string_view id) const {
+    return Symbol::find(id)
+        .map([this](Symbol sym) { return this->get_edge(sym); })
+        .flatten();
+}
+
+Optional<Ref<WireEdge>> BoardGraph::get_edge(Symbol id) const {
+    const auto& existing = this->m_edge_ids.find(id);
+    if(existing != this->m_edge_ids.end() && this->m_storage->edges.contains(existing->second)) {
+        return this->edge_ref(existing->second);
+    } else {
+        return {};
     }
+}
 
+BoardGraph::NodeHandle BoardGraph::load_node(NodeDesc const& desc) {
+    const Symbol sym = Symbol::intern(desc.id);
+    if(this->m_node_ids.contains(sym)) {
+        return Arena<ComponentNode>::npos;
+    }
 
-    auto [entry, ins] = this->m_nodes.emplace(id, Ref<ComponentNode>{new ComponentNode{}});
+    auto [entry, ins] = this->m_node_ids.emplace(sym, Arena<ComponentNode>::npos);
+    NodeHandle handle = Arena<ComponentNode>::npos;
     try {
-        const auto json_val = root_val.at("nodes").at(id);
-        Ref<ComponentNode> node{new ComponentNode{}};
-        node->m_name = json_val.at("name").get<std::string>();
+        handle = this->m_storage->nodes.emplace();
+        this->adopt(handle);
+        ComponentNode *node = &this->m_storage->nodes.at(handle);
+        node->m_name = desc.name;
         node->m_id = entry->first;
-        node->m_ty = this->m_res.try_get<Component>(json_val.at("type").get<std::string_view>());
-        node->m_pos = json_val.at("pos").get<Point>();
-        for(const auto& conn_json : json_val.at("conns")) {
-            ConnectionPortIdx port = node
-                ->m_ty
-                ->get_port_idx(conn_json.at("port").get<std::string_view>())
-                .unwrap_except(std::runtime_error{fmt::format(
-                    "Component {} has no port with id {}",
-                    node->m_ty->id(),
-                    conn_json.at("port").get<std::string_view>()
-                )});
-            auto edge = this
-                ->get_edge(conn_json.at("edge").get<std::string_view>())
-                .unwrap_except(std::runtime_error{fmt::format("Node {} connects to nonexistent edge {}", id, conn_json.at("edge").get<std::string_view>())});
-            node->m_edges[port] = ComponentNode::EdgeConnection{
-                .edge = edge,
-                .side = conn_json.at("side").get<WireEdge::Side>()
-            };
-        }
-
-        node->m_aabb = node->m_ty->m_fp.aabb();
-        node->m_aabb.max += node->m_pos;
-        node->m_aabb.min += node->m_pos;
+        node->m_ty = this->m_res.try_get<Component>(desc.type);
+        node->m_pos = desc.pos;
+        node->place();
         
-        entry->second = node;
+        entry->second = handle;
+        this->tally(*node, true);
+        return handle;
     } catch(std::exception& e) {
-        this->m_nodes.erase(id);
-        throw std::runtime_error{fmt::format("Failed to load graph node with ID {}: {}", id, e.what())}; 
+        if(handle != Arena<ComponentNode>::npos) {
+            this->m_storage->nodes.erase(handle);
+        }
+        this->m_node_ids.erase(entry);
+        throw std::runtime_error{fmt::format("Failed to load graph node with ID {}: {}", desc.id, e.what())}; 
     }
 
 }
 
-void BoardGraph::load_edge(const std::string& id, const json& root_val) {
-    const auto& existing = this->get_edge(id);
-    if(existing.has_value()) {
-        return;
+BoardGraph::EdgeHandle BoardGraph::load_edge(EdgeDesc const& desc) {
+    const Symbol sym = Symbol::intern(desc.id);
+    if(this->m_edge_ids.contains(sym)) {
+        return Arena<WireEdge>::npos;
     }
 
-    auto [entry, ins] = this->m_edges.emplace(id, Ref<WireEdge>{});
+    auto [entry, ins] = this->m_edge_ids.emplace(sym, Arena<WireEdge>::npos);
+    EdgeHandle handle = Arena<WireEdge>::npos;
 
     try {
-        const auto json_val = root_val.at("edges").at(id);
-        Ref<WireEdge> edge{new WireEdge()};
+        handle = this->m_storage->edges.emplace();
+        WireEdge *edge = &this->m_storage->edges.at(handle);
         edge->m_id = entry->first;
-        for(std::size_t i = 0; const auto& conn_json : json_val.at("conns")) {
-            if(i >= 2) {
-                throw std::runtime_error{"Too many connections for edge, must have exactly two"};
+        edge->m_handle = this->m_storage->edges.handle(handle);
+        edge->m_wire_pts.assign(desc.points.begin(), desc.points.end());
+        for(std::size_t i = 0; i < desc.ends.size(); ++i) {
+            const EdgeDesc::End& end = desc.ends[i];
+            edge->m_conns[i].m_connector = this->m_res.try_get<Connector>(end.connector);
+            //Attached ends stay floating until `attach_loaded`, the node they attach to may not be loaded yet
+            if(end.node.empty()) {
+                edge->m_conns[i].m_pos = end.pos;
             }
-            edge->m_conns[i].m_connector = this->m_res.try_get<Connector>(conn_json.at("connector").get<std::string_view>());
-            
-            if(conn_json.contains("node") && conn_json.contains("port")) {
-                edge->m_conns[i].m_component = this
-                    ->get_node(conn_json.at("node").get<std::string_view>())
-                    .unwrap_except(std::runtime_error{fmt::format(
-                        "Edge {} connects to nonexistent node with {}",
-                        edge->m_id,
-                        conn_json.at("node").get<std::string_view>()
-                    )});
-                edge->m_conns[i].m_port = edge
-                    ->m_conns[i]
-                    .m_component
-                    .lock()
-                    ->type()
-                    ->get_port_idx(conn_json.at("port").get<std::string_view>())
-                    .unwrap_except(std::runtime_error{fmt::format(
-                        "Component {} has no port with ID {}",
-                        edge->m_conns[i].m_component.lock()->type()->id(),
-                        conn_json.at("port").get<std::string_view>()
-                    )});
-            } else if(conn_json.contains("pos")) {
-                conn_json.at("pos").get_to<Point>(edge->m_conns[i].m_pos);
-            } else {
-                throw std::runtime_error{"Wire edge connection JSON must have either a 'pos' field if the edge is floating or a 'node' and 'port' ID field"};
-            }
-            i += 1;
         }
 
-        entry->second = edge;
+        entry->second = handle;
+        this->tally(*edge, true);
+        return handle;
     } catch(std::exception& e) {
-        this->m_edges.erase(id);
-        throw std::runtime_error{fmt::format("Failed to load graph edge with ID {}: {}", id, e.what())}; 
+        if(handle != Arena<WireEdge>::npos) {
+            this->m_storage->edges.erase(handle);
+        }
+        this->m_edge_ids.erase(entry);
+        throw std::runtime_error{fmt::format("Failed to load graph edge with ID {}: {}", desc.id, e.what())}; 
     }
 }
 
-BoardGraph::BoardGraph(std::filesystem::path&& path, bool create, bool save) : m_res{}, m_nodes{}, m_edges{}, m_path{path}, m_save{save} {
+bool BoardGraph::attach_loaded(EdgeHandle edge_handle, WireEdge::Side side, NodeHandle node_handle, ConnectionPortIdx port) {
+    GraphStorage& storage = *this->m_storage;
+    ComponentNode& node = storage.nodes.at(node_handle);
+    WireEdge& edge = storage.edges.at(edge_handle);
+    const auto [entry, added] = node.m_edges.emplace(port, ComponentNode::EdgeConnection{
+        .edge = edge.m_handle,
+        .side = side
+    });
+    if(!added) {
+        return false;
+    }
+
+    WireEdge::Connection& conn = edge.m_conns[side];
+    conn.m_graph = &storage;
+    conn.m_node = storage.nodes.handle(node_handle);
+    conn.m_port = port;
+    storage.nodes.touch(node_handle);
+    return true;
+}
+
+BoardGraph::BoardGraph(std::filesystem::path&& path, bool create, bool save) : m_res{}, m_path{path}, m_save{save} {
+    this->m_storage->graph = this;
     this->m_res.register_loader(new ComponentLoader{});
     this->m_res.register_loader(new ConnectorLoader{});
     if(std::filesystem::exists(path)) {
-        std::ifstream json_file{path};
-        json root_json;
         try {
-            json_file >> root_json;
-            from_json(*this, root_json);
+            //Binary files are read in place from the mapping, JSON is loaded as it is parsed without building a tree
+            const MappedFile file{path};
+            if(boardfile::is_binary(file.bytes())) {
+                from_binary(*this, file.bytes());
+            } else {
+                BoardLoader::load(*this, std::string_view{
+                    reinterpret_cast<const char*>(file.bytes().data()),
+                    file.bytes().size()
+                });
+            }
         } catch(const std::exception& e) {
             throw std::runtime_error{fmt::format(
-                "Failed to read board JSON from {}: {}",
+                "Failed to read board from {}: {}",
                 path.c_str(),
                 e.what()
             )};
@@ -240,11 +723,43 @@ BoardGraph::BoardGraph(std::filesystem::path&& path, bool create, bool save) : m
     }
 }
 
+BoardGraph::BoardGraph(BoardGraph&& other) :
+    m_res{std::move(other.m_res)},
+    m_storage{std::move(other.m_storage)},
+    m_node_ids{std::move(other.m_node_ids)},
+    m_edge_ids{std::move(other.m_edge_ids)},
+    m_component_counts{std::move(other.m_component_counts)},
+    m_connector_counts{std::move(other.m_connector_counts)},
+    m_path{std::move(other.m_path)},
+    m_save{other.m_save}
+{
+    if(this->m_storage != nullptr) {
+        this->m_storage->graph = this;
+    }
+}
+
+BoardGraph& BoardGraph::operator=(BoardGraph&& other) {
+    if(this != &other) {
+        this->m_res = std::move(other.m_res);
+        this->m_storage = std::move(other.m_storage);
+        this->m_node_ids = std::move(other.m_node_ids);
+        this->m_edge_ids = std::move(other.m_edge_ids);
+        this->m_component_counts = std::move(other.m_component_counts);
+        this->m_connector_counts = std::move(other.m_connector_counts);
+        this->m_path = std::move(other.m_path);
+        this->m_save = other.m_save;
+        if(this->m_storage != nullptr) {
+            this->m_storage->graph = this;
+        }
+    }
+    return *this;
+}
+
 BoardGraph::~BoardGraph() {
-    if(this->m_save) {
+    //A moved-from graph no longer owns any storage to save
+    if(this->m_save && this->m_storage != nullptr) {
         try {
-            std::ofstream savefile{this->m_path};
-            savefile << std::setw(4) << this->to_json();
+            this->save(this->m_path);
         } catch(const std::exception& e) {
             logger::error("Failed to save board graph to file {}: {}", this->m_path.c_str(), e.what());
         }
@@ -252,63 +767,127 @@ BoardGraph::~BoardGraph() {
 }
 
 void BoardGraph::from_json(BoardGraph& self, const json& obj) {
-    const auto& nodes = obj.at("nodes");
-    const auto& edges = obj.at("edges");
-    for(const auto& [id, node] : nodes.items()) {
-        self.load_node(id, obj);
+    //Nodes and edges are read in a single pass each, cross references between them are resolved by the loader
+    BoardLoader loader{self};
+    if(!obj.is_object()) {
+        throw std::runtime_error{"A board must be a JSON object"};
+    }
+    for(const char * const section : {"nodes", "edges"}) {
+        if(!obj.contains(section)) {
+            throw std::runtime_error{fmt::format("A board must have a '{}' object", section)};
+        }
+        if(!obj.at(section).is_object()) {
+            throw std::runtime_error{fmt::format("The '{}' field of a board must be an object", section)};
+        }
     }
-    for(const auto& [id, edge] : edges.items()) {
-        self.load_edge(id, obj);
+
+    std::vector<BoardLoader::NodeConn> conns{};
+    for(const auto& [id, node_json] : obj.at("nodes").items()) {
+        NodeDesc desc{.id = id, .type{}, .pos{}, .name{}};
+        conns.clear();
+        try {
+            if(!node_json.is_object()) {
+                throw std::runtime_error{"Expected an object"};
+            }
+            desc.type = node_json.at("type").get<std::string_view>();
+            desc.pos = node_json.at("pos").get<Point>();
+            desc.name = node_json.at("name").get<std::string_view>();
+            for(const auto& conn_json : node_json.at("conns")) {
+                conns.push_back(BoardLoader::NodeConn{
+                    .port = conn_json.at("port").get<std::string_view>(),
+                    .edge = conn_json.at("edge").get<std::string_view>(),
+                    .side = conn_json.at("side").get<WireEdge::Side>(),
+                });
+            }
+        } catch(std::exception& e) {
+            throw std::runtime_error{fmt::format("Failed to load graph node with ID {}: {}", id, e.what())}; 
+        }
+        loader.node(desc, conns);
+    }
+
+    for(const auto& [id, edge_json] : obj.at("edges").items()) {
+        EdgeDesc desc{.id = id, .ends{}, .points{}};
+        try {
+            if(!edge_json.is_object()) {
+                throw std::runtime_error{"Expected an object"};
+            }
+            const json& conns_json = edge_json.at("conns");
+            if(conns_json.size() != 2) {
+                throw std::runtime_error{"Wire edges must have exactly two connections"};
+            }
+            for(std::size_t i = 0; const auto& conn_json : conns_json) {
+                EdgeDesc::End& end = desc.ends[i];
+                end.connector = conn_json.at("connector").get<std::string_view>();
+                if(conn_json.contains("node") && conn_json.contains("port")) {
+                    end.node = conn_json.at("node").get<std::string_view>();
+                    end.port = conn_json.at("port").get<std::string_view>();
+                } else if(conn_json.contains("pos")) {
+                    conn_json.at("pos").get_to<Point>(end.pos);
+                } else {
+                    throw std::runtime_error{"Wire edge connection JSON must have either a 'pos' field if the edge is floating or a 'node' and 'port' ID field"};
+                }
+                i += 1;
+            }
+        } catch(std::exception& e) {
+            throw std::runtime_error{fmt::format("Failed to load graph edge with ID {}: {}", id, e.what())}; 
+        }
+        loader.edge(desc);
     }
+    loader.finish();
 }
 
-json BoardGraph::to_json() const {
+template<typename Nodes, typename Edges>
+json BoardGraph::to_json(Nodes const& nodes_store, Edges const& edges_store) {
     json::object_t obj{};
     json::object_t nodes{};
     json::object_t edges{};
 
-    for(const auto& [id, node] : this->m_nodes) {
+    for(const ComponentNode& node : nodes_store) {
         json::object_t node_json{};
-        node_json.emplace("name", node->name());
-        node_json.emplace("type", node->type()->id());
-        node_json.emplace("pos", node->pos());
+        node_json.emplace("name", node.name());
+        node_json.emplace("type", node.type()->id());
+        node_json.emplace("pos", node.pos());
         json::array_t conns{};
-        for(const auto& [port, edge] : node->m_edges) {
+        for(const auto& [port, edge] : node.m_edges) {
             json::object_t conn_json{};
             conn_json.emplace(
                 "port",
                 node
-                    ->type()
+                    .type()
                     ->get_port(port)
-                    .unwrap_except(std::runtime_error{fmt::format("Component {} has no port with id {}", node->type()->id(), port)})
+                    .unwrap_or_else_throw([&node, port]() {
+                        return std::runtime_error{fmt::format("Component {} has no port with id {}", node.type()->id(), port)};
+                    })
                     .get()
                     .id()
             );
-            conn_json.emplace("edge", edge.edge->id());
+            conn_json.emplace("edge", edges_store.at(edge.edge.index).id());
             conn_json.emplace("side", edge.side);
             conns.push_back(std::move(conn_json));
         }
         node_json.emplace("conns", std::move(conns));
         
-        nodes.emplace(node->id(), std::move(node_json));
+        nodes.emplace(node.id(), std::move(node_json));
     }
 
-    for(const auto& [id, edge] : this->m_edges) {
+    for(const WireEdge& edge : edges_store) {
         json::object_t edge_json{};
         edge_json.emplace("conns", json::array_t{});
-        for(const auto& conn : edge->connections()) {
+        for(const auto& conn : edge.connections()) {
             json::object_t conn_json{};
             conn_json.emplace("connector", conn.connector()->id());
             if(conn.is_floating()) {
                 conn_json.emplace("pos", conn.pos());
             } else {
-                conn_json.emplace("node", conn.component().lock()->id());
-                conn_json.emplace("port", conn.port().unwrap_unchecked().get().id());
+                //Resolve the end through the storage being saved, a snapshot's wire ends do not link to any graph
+                const ComponentNode& node = *nodes_store.get(conn.m_node);
+                conn_json.emplace("node", node.id());
+                conn_json.emplace("port", node.type()->get_port(conn.m_port).unwrap_unchecked().get().id());
             }
 
             edge_json.at("conns").push_back(std::move(conn_json));
         }
-        edges.emplace(edge->id(), std::move(edge_json));
+        edges.emplace(edge.id(), std::move(edge_json));
     }
 
     obj.emplace("nodes", std::move(nodes));
@@ -316,3 +895,385 @@ json BoardGraph::to_json() const {
 
     return obj;
 }
+
+template<typename Nodes, typename Edges>
+void BoardGraph::write_json(std::ostream& out, Nodes const& nodes_store, Edges const& edges_store, bool compact) {
+    //Members are written in the order of their keys, the order that `to_json` gets from its sorted objects
+    const auto by_id = [](auto const *a, auto const *b) { return a->id() < b->id(); };
+    std::vector<ComponentNode const*> nodes{};
+    nodes.reserve(nodes_store.size());
+    for(const ComponentNode& node : nodes_store) {
+        nodes.push_back(&node);
+    }
+    std::sort(nodes.begin(), nodes.end(), by_id);
+    std::vector<WireEdge const*> edges{};
+    edges.reserve(edges_store.size());
+    for(const WireEdge& edge : edges_store) {
+        edges.push_back(&edge);
+    }
+    std::sort(edges.begin(), edges.end(), by_id);
+
+    const auto write_pos = [](JsonWriter& writer, Point const& pos) {
+        writer.begin_array();
+        writer.value(pos.x.to_string());
+        writer.value(pos.y.to_string());
+        writer.end_array();
+    };
+
+    JsonWriter writer{out, compact};
+    writer.begin_object();
+
+    writer.key("edges");
+    writer.begin_object();
+    for(const WireEdge *edge : edges) {
+        writer.key(edge->id());
+        writer.begin_object();
+        writer.key("conns");
+        writer.begin_array();
+        for(const auto& conn : edge->connections()) {
+            writer.begin_object();
+            writer.key("connector");
+            writer.value(conn.connector()->id());
+            if(conn.is_floating()) {
+                writer.key("pos");
+                write_pos(writer, conn.pos());
+            } else {
+                //Resolve the end through the storage being saved, a snapshot's wire ends do not link to any graph
+                const ComponentNode& node = *nodes_store.get(conn.m_node);
+                writer.key("node");
+                writer.value(node.id());
+                writer.key("port");
+                writer.value(node.type()->get_port(conn.m_port).unwrap_unchecked().get().id());
+            }
+            writer.end_object();
+        }
+        writer.end_array();
+        writer.end_object();
+    }
+    writer.end_object();
+
+    writer.key("nodes");
+    writer.begin_object();
+    for(const ComponentNode *node : nodes) {
+        writer.key(node->id());
+        writer.begin_object();
+        writer.key("conns");
+        writer.begin_array();
+        for(const auto& [port, edge] : node->m_edges) {
+            writer.begin_object();
+            writer.key("edge");
+            writer.value(edges_store.at(edge.edge.index).id());
+            writer.key("port");
+            writer.value(
+                node
+                    ->type()
+                    ->get_port(port)
+                    .unwrap_or_else_throw([node, port]() {
+                        return std::runtime_error{fmt::format("Component {} has no port with id {}", node->type()->id(), port)};
+                    })
+                    .get()
+                    .id()
+            );
+            writer.key("side");
+            writer.value(static_cast<std::uint64_t>(edge.side));
+            writer.end_object();
+        }
+        writer.end_array();
+        writer.key("name");
+        writer.value(node->name());
+        writer.key("pos");
+        write_pos(writer, node->pos());
+        writer.key("type");
+        writer.value(node->type()->id());
+        writer.end_object();
+    }
+    writer.end_object();
+
+    writer.end_object();
+}
+
+json BoardGraph::to_json() const {
+    return to_json(std::as_const(this->m_storage->nodes), std::as_const(this->m_storage->edges));
+}
+
+void BoardGraph::write_json(std::ostream& out, bool compact) const {
+    write_json(out, std::as_const(this->m_storage->nodes), std::as_const(this->m_storage->edges), compact);
+}
+
+BoardSnapshot BoardGraph::snapshot() {
+    return BoardSnapshot{this->m_storage->nodes.snapshot(), this->m_storage->edges.snapshot()};
+}
+
+json BoardSnapshot::to_json() const {
+    return BoardGraph::to_json(this->m_nodes, this->m_edges);
+}
+
+void BoardSnapshot::write_json(std::ostream& out, bool compact) const {
+    BoardGraph::write_json(out, this->m_nodes, this->m_edges, compact);
+}
+
+TEST_CASE("BoardGraph::write_json") {
+    const testing::AssetDir assets{};
+    BoardGraph graph = testing::asset_board();
+    const Ref<Component> bus = graph.resources().try_get<Component>("1280.bus");
+    const Ref<Connector> bare = graph.resources().try_get<Connector>("1280.bare");
+    //Names with escapes and nodes with several connections, on top of the asset board
+    const Ref<ComponentNode> a = graph.component(bus, "write.a", Point{}, "\"quoted\"\tname\n\u0001");
+    const Ref<ComponentNode> b = graph.component(bus, "write.b", Point{}, "é");
+    for(const auto& [from, to] : {std::pair{"out0", "in"}, std::pair{"out1", "out0"}, std::pair{"aux", "out1"}}) {
+        Ref<WireEdge> edge = graph.edge(fmt::format("write.{}", from), {bare, bare});
+        a->connnect_port(bus->get_port_idx(from).unwrap(), edge, WireEdge::LEFT);
+        b->connnect_port(bus->get_port_idx(to).unwrap(), edge, WireEdge::RIGHT);
+    }
+
+    std::stringstream pretty{};
+    pretty << std::setw(4) << graph.to_json();
+    std::stringstream written{};
+    graph.write_json(written);
+    CHECK_EQ(written.str(), pretty.str());
+
+    std::stringstream compact{};
+    graph.write_json(compact, true);
+    CHECK_EQ(compact.str(), graph.to_json().dump());
+}
+
+TEST_CASE("BoardGraph::snapshot") {
+    const testing::AssetDir assets{};
+    BoardGraph graph = testing::asset_board();
+    const Ref<Component> bus = graph.resources().try_get<Component>("1280.bus");
+    const Ref<Connector> bare = graph.resources().try_get<Connector>("1280.bare");
+    const ConnectionPortIdx out = bus->get_port_idx("out0").unwrap();
+    const Ref<ComponentNode> a = graph.component(bus, "snap.a", Point{Length{1.f}, Length{2.f}}, "A");
+    const Ref<WireEdge> wire = graph.edge("snap.e", {bare, bare});
+    a->connnect_port(out, wire, WireEdge::LEFT);
+    const Point attached{a->port_pos(out)};
+
+    const BoardSnapshot first = graph.snapshot();
+    const json before = first.to_json();
+    a->move_to(Point{Length{3.f}, Length{4.f}});
+    graph.reroute(wire->handle().index, {RawPoint{}});
+    graph.component(bus, "snap.b", Point{}, "B");
+    graph.remove_edge(graph.get_edge("e1").unwrap()->handle().index);
+
+    CHECK_MESSAGE(first.to_json() == before, "A snapshot changed when the graph was edited");
+    const WireEdge& frozen = first.edges().at(wire->handle().index);
+    const WireEdge::Connection& end = frozen.connections()[WireEdge::LEFT];
+    CHECK(frozen.points().empty());
+    CHECK_FALSE(end.is_floating());
+    CHECK_FALSE_MESSAGE(end.node().has_value(), "A wire end in a snapshot resolved through the live graph");
+    CHECK_EQ(end.component(), nullptr);
+    CHECK_EQ(end.pos(), attached);
+    REQUIRE_NE(first.node(end), nullptr);
+    CHECK_EQ(first.node(end)->pos(), Point{Length{1.f}, Length{2.f}});
+
+    const BoardSnapshot second = graph.snapshot();
+    CHECK_EQ(second.to_json(), graph.to_json());
+    CHECK_EQ(second.edges().at(wire->handle().index).connections()[WireEdge::LEFT].pos(), Point{a->port_pos(out)});
+    CHECK_NE(attached, Point{a->port_pos(out)});
+}
+
+TEST_CASE("BoardGraph references to removed elements") {
+    const testing::AssetDir assets{};
+    BoardGraph graph = testing::asset_board();
+    const Ref<Component> bus = graph.resources().try_get<Component>("1280.bus");
+    const Ref<Connector> bare = graph.resources().try_get<Connector>("1280.bare");
+
+    SUBCASE("weak references expire") {
+        const WeakRef<ComponentNode> node = graph.component(bus, "ref.a", Point{});
+        const WeakRef<WireEdge> edge = graph.edge("ref.e", {bare, bare});
+        REQUIRE_FALSE(node.expired());
+        REQUIRE_FALSE(edge.expired());
+        CHECK_EQ(node.lock(), graph.get_node("ref.a").unwrap());
+
+        graph.remove_node(node.lock()->handle());
+        graph.remove_edge(edge.lock()->handle().index);
+        CHECK_MESSAGE(node.expired(), "A weak reference to a removed node did not expire");
+        CHECK_MESSAGE(edge.expired(), "A weak reference to a removed edge did not expire");
+    }
+
+    SUBCASE("held references keep the removed element") {
+        Ref<ComponentNode> a = graph.component(bus, "ref.a", Point{});
+        const WeakRef<ComponentNode> weak = a;
+        const BoardGraph::NodeHandle handle = a->handle();
+        graph.remove_node(handle);
+        CHECK_FALSE(weak.expired());
+        CHECK_FALSE(graph.get_node("ref.a").has_value());
+        CHECK_THROWS(graph.node_ref(handle));
+
+        const Ref<ComponentNode> b = graph.component(bus, "ref.b", Point{});
+        CHECK_MESSAGE(b.get() != a.get(), "A node was placed in the slot of a removed node that is still referenced");
+        CHECK_EQ(a->id(), "ref.a");
+        CHECK_EQ(b->id(), "ref.b");
+        Ref<WireEdge> edge = graph.edge("ref.e", {bare, bare});
+        CHECK_FALSE(a->connnect_port(bus->get_port_idx("in").unwrap(), edge, WireEdge::LEFT).has_value());
+
+        a.reset();
+        CHECK(weak.expired());
+        const Ref<ComponentNode> c = graph.component(bus, "ref.c", Point{});
+        CHECK_EQ(c->handle(), handle);
+    }
+
+    SUBCASE("held references outlive the graph") {
+        Ref<ComponentNode> kept{};
+        {
+            BoardGraph other = testing::asset_board();
+            kept = other.component(bus, "ref.kept", Point{});
+        }
+        const WeakRef<ComponentNode> weak = kept;
+        CHECK_EQ(kept->id(), "ref.kept");
+        kept.reset();
+        CHECK_MESSAGE(weak.expired(), "A node of a destroyed graph is kept alive once no reference to it is held");
+    }
+}
+
+TEST_CASE("BoardGraph::insert") {
+    using NodeDesc = BoardGraph::NodeDesc;
+    using EdgeDesc = BoardGraph::EdgeDesc;
+    const testing::AssetDir assets{};
+    BoardGraph graph = testing::asset_board();
+    const Ref<Component> bus = graph.resources().try_get<Component>("1280.bus");
+    const json before = graph.to_json();
+    const auto wire = [](std::string_view id, std::string_view node, std::string_view port, std::string_view to = {}, std::string_view to_port = {}) {
+        return EdgeDesc{
+            .id = id,
+            .ends = {EdgeDesc::End{.connector = "1280.bare", .node = node, .port = port}, EdgeDesc::End{.connector = "1280.bare", .node = to, .port = to_port}},
+        };
+    };
+
+    SUBCASE("a valid batch") {
+        const std::array nodes{
+            NodeDesc{.id = "insert.a", .type = "1280.bus", .pos = Point{}, .name = "A"},
+            NodeDesc{.id = "insert.b", .type = "1280.bus", .pos = Point{}, .name = "B"},
+        };
+        const std::array edges{wire("insert.e0", "insert.a", "out0", "insert.b", "in"), wire("insert.e1", "test", "pwm0")};
+        const BoardGraph::Inserted inserted = graph.insert(nodes, edges);
+        REQUIRE_EQ(inserted.nodes.size(), 2);
+        REQUIRE_EQ(inserted.edges.size(), 2);
+        CHECK_EQ(graph.node_ref(inserted.nodes[1])->name(), "B");
+        const Ref<WireEdge> e0 = graph.get_edge("insert.e0").unwrap();
+        CHECK_EQ(e0->handle().index, inserted.edges[0]);
+        CHECK_EQ(e0->connections()[WireEdge::RIGHT].node().unwrap().get().id(), "insert.b");
+        CHECK_EQ(graph.get_edge("insert.e1").unwrap()->connections()[WireEdge::LEFT].node().unwrap().get().id(), "test");
+        CHECK(graph.get_node("insert.a").unwrap()->port(bus->get_port_idx("out0").unwrap()).has_value());
+    }
+
+    SUBCASE("a rejected batch leaves the graph unchanged") {
+        const NodeDesc fresh{.id = "insert.fresh", .type = "1280.bus", .pos = Point{}, .name = "Fresh"};
+        const auto rejected = [&](std::span<const NodeDesc> nodes, std::span<const EdgeDesc> edges) {
+            CHECK_THROWS_AS(graph.insert(nodes, edges), std::runtime_error);
+            CHECK_EQ(graph.to_json(), before);
+            CHECK_EQ(graph.count(bus), 0);
+            CHECK_FALSE_MESSAGE(Symbol::find("insert.fresh").has_value(), "A rejected batch interned the IDs it described");
+            CHECK_FALSE(Symbol::find("insert.fresh.e").has_value());
+        };
+
+        SUBCASE("duplicate node ID in the graph") {
+            const std::array nodes{fresh, NodeDesc{.id = "roborio", .type = "1280.bus", .pos = Point{}, .name = ""}};
+            rejected(nodes, {});
+        }
+        SUBCASE("duplicate node ID in the batch") {
+            const std::array nodes{fresh, fresh};
+            rejected(nodes, {});
+        }
+        SUBCASE("duplicate edge ID") {
+            const std::array nodes{fresh};
+            const std::array edges{wire("insert.fresh.e", "", ""), wire("e1", "", "")};
+            rejected(nodes, edges);
+        }
+        SUBCASE("missing component type") {
+            const std::array nodes{fresh, NodeDesc{.id = "insert.typeless", .type = "1280.insert.missing", .pos = Point{}, .name = ""}};
+            rejected(nodes, {});
+            CHECK_FALSE(Symbol::find("1280.insert.missing").has_value());
+        }
+        SUBCASE("missing node") {
+            const std::array nodes{fresh};
+            const std::array edges{wire("insert.fresh.e", "insert.nowhere", "in")};
+            rejected(nodes, edges);
+        }
+        SUBCASE("missing port") {
+            const std::array nodes{fresh};
+            const std::array edges{wire("insert.fresh.e", "insert.fresh", "insert.noport")};
+            rejected(nodes, edges);
+        }
+        SUBCASE("port already connected") {
+            const std::array nodes{fresh};
+            const std::array edges{wire("insert.fresh.e", "roborio", "pwm0")};
+            rejected(nodes, edges);
+        }
+        SUBCASE("port claimed twice in the batch") {
+            const std::array nodes{fresh};
+            const std::array edges{wire("insert.fresh.e", "insert.fresh", "in"), wire("insert.fresh.f", "insert.fresh", "in")};
+            rejected(nodes, edges);
+        }
+    }
+}
+
+TEST_CASE("BoardGraph type counts") {
+    using NodeDesc = BoardGraph::NodeDesc;
+    using EdgeDesc = BoardGraph::EdgeDesc;
+    const testing::AssetDir assets{};
+    BoardGraph graph = testing::asset_board();
+    const Ref<Component> bus = graph.resources().try_get<Component>("1280.bus");
+    const Ref<Connector> bare = graph.resources().try_get<Connector>("1280.bare");
+
+    //The counts kept up to date by every edit must match counting every node and wire end again
+    const auto recount = [](BoardGraph& board) {
+        Map<Ref<Component>, std::size_t> components{};
+        for(const ComponentNode& node : board.nodes()) {
+            components[node.type()] += 1;
+        }
+        Map<Ref<Connector>, std::size_t> connectors{};
+        for(const WireEdge& edge : board.edges()) {
+            for(const auto& conn : edge.connections()) {
+                connectors[conn.connector()] += 1;
+            }
+        }
+        CHECK_EQ(board.component_counts(), components);
+        CHECK_EQ(board.connector_counts(), connectors);
+        for(const auto& [type, count] : components) {
+            CHECK_EQ(board.count(type), count);
+        }
+        for(const auto& [type, count] : connectors) {
+            CHECK_EQ(board.count(type), count);
+        }
+    };
+
+    REQUIRE_FALSE(graph.component_counts().empty());
+    recount(graph);
+
+    const std::array nodes{
+        NodeDesc{.id = "count.a", .type = "1280.bus", .pos = Point{}, .name = "A"},
+        NodeDesc{.id = "count.b", .type = "1280.bus", .pos = Point{}, .name = "B"},
+    };
+    const std::array edges{EdgeDesc{
+        .id = "count.e",
+        .ends = {EdgeDesc::End{.connector = "1280.bare", .node = "count.a", .port = "out0"}, EdgeDesc::End{.connector = "1280.bare"}},
+    }};
+    graph.insert(nodes, edges);
+    recount(graph);
+    CHECK_EQ(graph.count(bus), 2);
+
+    const Ref<ComponentNode> c = graph.component(bus, "count.c", Point{});
+    const Ref<WireEdge> wire = graph.edge("count.f", {bare, bare});
+    c->connnect_port(bus->get_port_idx("in").unwrap(), wire, WireEdge::RIGHT);
+    recount(graph);
+    CHECK_EQ(graph.count(bus), 3);
+
+    graph.remove_edge(graph.get_edge("count.e").unwrap()->handle().index);
+    graph.remove_node(c->handle());
+    recount(graph);
+    for(const std::string_view id : {"count.a", "count.b"}) {
+        graph.remove_node(graph.get_node(id).unwrap()->handle());
+    }
+    recount(graph);
+    CHECK_EQ(graph.count(bus), 0);
+    CHECK_FALSE_MESSAGE(graph.component_counts().contains(bus), "A type with no placed nodes is still listed");
+
+    BoardGraph loaded{};
+    loaded.resources().register_loader(new ComponentLoader{});
+    loaded.resources().register_loader(new ConnectorLoader{});
+    BoardGraph::from_json(loaded, graph.to_json());
+    recount(loaded);
+    CHECK_EQ(loaded.component_counts().size(), graph.component_counts().size());
+    CHECK_EQ(loaded.connector_counts().size(), graph.connector_counts().size());
+}
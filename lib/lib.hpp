@@ -1,9 +1,14 @@
 #pragma once
 
 #include <array>
+#include <cassert>
+#include <concepts>
 #include <cstddef>
 #include <functional>
 #include <iterator>
+#include <ostream>
+#include <span>
+#include <vector>
 
 #include "geom.hpp"
 #include "component.hpp"
@@ -11,9 +16,14 @@
 #include "wire.hpp"
 #include "ser/ser.hpp"
 #include "unit.hpp"
+#include "util/arena.hpp"
 
 
 class ComponentNode;
+class BoardGraph;
+class NetIndex;
+class BoardSnapshot;
+struct GraphStorage;
 
 /**
  * \brief An edge in the board graph representing a single wire connection between two
@@ -39,108 +49,186 @@ public:
      */
     struct Connection {
     public:
-        /** Create a new connection point using a component and pointer to a connection port */
-        inline Connection(WeakRef<ComponentNode> component, ConnectionPortIdx port) :
-            m_component{component}, m_port{port} {}
-    
         /**
          * \brief Get the port that this connection is attached to on the component node
          *
-         * \return an empty `Optional` if this connection end is not attached to any node in the graph
-         * or a reference to the connection port on the attached component this is attached to
+         * \return an empty `Optional` if this connection end is not attached to any node in the graph, or belongs
+         * to an edge in a `BoardSnapshot`, or a reference to the connection port on the attached component
          */
         Optional<std::reference_wrapper<const ConnectionPort>> port() const;
     
         /**
-         * \brief Get the position of this connector, fetched either from the port that this is connected to
-         * or the stored position
+         * \brief Get the position of this connector in workspace coordinates, fetched either from the cached
+         * position of the port that this is connected to or the stored position
          * \return Position that this end occupies
          */
-        Point const& pos() const;
-        /** \brief Get the graph node that this connection is attached to */ 
-        inline WeakRef<ComponentNode> component() const noexcept { return this->m_component; }
+        Point pos() const;
+        /**
+         * \brief Get the graph node that this connection is attached to, resolved by handle with no reference
+         * counting
+         * \return An empty `Optional` if this end is floating, the node it referred to has been removed, or the end
+         * belongs to an edge in a `BoardSnapshot`, which resolves it with `BoardSnapshot::node` instead
+         */
+        inline Optional<std::reference_wrapper<const ComponentNode>> node() const noexcept;
+        /**
+         * \brief Get a shared reference to the graph node that this connection is attached to, prefer `node` when
+         * the reference does not need to outlive the graph
+         * \return nullptr if this end is floating or belongs to an edge in a `BoardSnapshot`
+         */
+        Ref<ComponentNode> component() const;
+        /** \brief Get the generational handle of the node that this connection is attached to */
+        inline constexpr ArenaHandle<ComponentNode> handle() const noexcept { return this->m_node; }
         /** \brief Get the connector type of this connection point */
         inline Ref<Connector> connector() const noexcept { return this->m_connector; }
         /**
          * \brief Check if this connection is attached to a graph node
          * \return true if this connection point does not attach to a node in the graph
          */
-        inline bool is_floating() const { return this->m_component.expired(); }
+        inline constexpr bool is_floating() const noexcept { return this->m_node == ArenaHandle<ComponentNode>{}; }
                 
         /**
          * \brief Detach this wire end from the component node's port, if
          * it is connected at all
          */
         void detach();
-
-        ~Connection() {
-            if(this->is_floating()) {
-                this->m_pos.~Point();
-            }
-        }
     private:
-        /** \brief Node in the graph that this edge connects to */
-        WeakRef<ComponentNode> m_component;
-        
         /**
-         * \brief Union containing either the port that this wire end connects to on 
-         * m_component or the position of the wire end in workspace coordinates if the 
-         * end is 'floating'
+         * \brief Storage of the graph containing the node that this end is attached to, nullptr if the end is
+         * floating or belongs to an edge in a `BoardSnapshot`
          */
-        union {
-            /** 
-             * \brief Index of a connection port on the component node's type 
-             *
-             * Implementation note: This MUST not be invalid if m_component is not expired
-             */
-            ConnectionPortIdx m_port;
-            
-            /** \brief Position of the connector in the workspace if this end is 'floating' */
-            Point m_pos;
-        };
+        GraphStorage *m_graph;
+        /** \brief Handle of the node in the graph that this end is attached to, the default handle if floating */
+        ArenaHandle<ComponentNode> m_node;
+        /** 
+         * \brief Index of a connection port on the component node's type 
+         *
+         * Implementation note: This MUST not be invalid if the end is not floating
+         */
+        ConnectionPortIdx m_port;
+        /**
+         * \brief Position of the connector in the workspace if this end is 'floating', or the position of the
+         * attached port when the edge was copied into a snapshot
+         */
+        Point m_pos;
 
         /** \brief A shared resource pointing to a user-defined connector on this connection point */
         Ref<Connector> m_connector;
 
-        Connection() : m_component{}, m_port{} {}
+        Connection() : m_graph{nullptr}, m_node{}, m_port{}, m_pos{} {}
         friend class WireEdge;
         friend class BoardGraph;
+        friend class ComponentNode;
+        friend class NetIndex;
+        friend class BoardSnapshot;
     };
     
     /** \brief Get the ID of this wire edge */
-    constexpr inline const std::string_view id() const noexcept { return this->m_id; }
+    inline const std::string_view id() const { return this->m_id.str(); }
+    /** \brief Get the interned ID of this wire edge */
+    constexpr inline Symbol symbol() const noexcept { return this->m_id; }
     /** \brief Get the pair of Connection structures representing the ends of this wire edge */
     inline std::array<Connection, 2> const& connections() const noexcept { return this->m_conns; }
     /** 
      * \brief Check if this edge connects to the given node in the graph
      * \return true if this edge attaches to the given node
      */
-    inline bool connects(const Ref<ComponentNode>& node) const { 
-        return std::any_of(
-            this->m_conns.begin(),
-            this->m_conns.end(),
-            [&node](const auto& conn) { return (conn.m_component.expired()) ? false : conn.m_component.lock() == node; } 
-        );
-    }
+    inline bool connects(const Ref<ComponentNode>& node) const;
     
     /**
      * \brief Convenience method to fetch a wire end by side 
      */
     inline constexpr Connection& side(const Side side) { return this->m_conns[side]; }
 
-    std::vector<Point>::const_iterator begin() const { return this->m_wire_pts.begin(); }
-    std::vector<Point>::const_iterator end() const { return this->m_wire_pts.end(); }
+    std::vector<RawPoint>::const_iterator begin() const { return this->m_wire_pts.begin(); }
+    std::vector<RawPoint>::const_iterator end() const { return this->m_wire_pts.end(); }
+    /** \brief Get the user-placed points that this wire travels between, not including either end */
+    inline std::span<const RawPoint> points() const noexcept { return this->m_wire_pts; }
+
+    /** \brief Get the handle of this edge in its graph's edge storage */
+    inline constexpr ArenaHandle<WireEdge> handle() const noexcept { return this->m_handle; }
+
+    /** \brief Create an unconnected edge, only a `BoardGraph` can give the edge an ID */
+    WireEdge() : m_conns{}, m_id{}, m_wire_pts{} {};
 private:
     /** \brief Components that this wire connects between*/
     std::array<Connection, 2> m_conns;
-    /** \brief Internal ID string of this wire edge */
-    std::string_view m_id;
+    /** \brief Internal ID of this wire edge */
+    Symbol m_id;
     /** \brief User-placed points that this wire travels between on the workspace */
-    std::vector<Point> m_wire_pts;
+    std::vector<RawPoint> m_wire_pts;
+    /** \brief Handle of this edge in the owning graph's edge storage */
+    ArenaHandle<WireEdge> m_handle;
+    /** \brief Control block shared by every `Ref` to this edge, created when the first `Ref` is handed out */
+    mutable Ref<void> m_anchor;
 
-    WireEdge() : m_conns{}, m_id{}, m_wire_pts{} {};
+    /**
+     * \brief Cut the links of a copy made for a snapshot back to the live graph, storing the position of every
+     * attached end so the copy can be read while the graph is edited
+     */
+    void freeze() noexcept;
 
     friend class BoardGraph;
+    friend class ComponentNode;
+    friend struct GraphStorage;
+    template<typename, std::size_t> friend class Arena;
+};
+
+/**
+ * \brief Interface for structures derived from a `BoardGraph` that must stay consistent as the graph is edited.
+ * Every method is called after the graph has been updated
+ * \sa BoardGraph::observe
+ */
+class GraphObserver {
+public:
+    /** \brief Called when a node is added to the graph */
+    virtual void node_added(ComponentNode const& node) { (void)node; }
+    /** \brief Called before `node` is removed from the graph, once every wire attached to it has been detached */
+    virtual void node_removed(ComponentNode const& node) { (void)node; }
+    /** \brief Called when `edge` is added to the graph, before any attached ends are reported with `connected` */
+    virtual void edge_added(WireEdge const& edge) { (void)edge; }
+    /** \brief Called before `edge` is removed from the graph, once both of its ends have been detached */
+    virtual void edge_removed(WireEdge const& edge) { (void)edge; }
+    /** \brief Called when the given side of `edge` is attached to `port` on `node` */
+    virtual void connected(ComponentNode const& node, ConnectionPortIdx port, WireEdge const& edge, WireEdge::Side side) {
+        (void)node; (void)port; (void)edge; (void)side;
+    }
+    /** \brief Called when the given side of `edge`, which was attached to `port` on `node`, is detached */
+    virtual void detached(ComponentNode const& node, ConnectionPortIdx port, WireEdge const& edge, WireEdge::Side side) {
+        (void)node; (void)port; (void)edge; (void)side;
+    }
+    /** \brief Called when `node` is moved, `from` is the position that the node was moved from */
+    virtual void moved(ComponentNode const& node, Point from) { (void)node; (void)from; }
+    /** \brief Called when the points that `edge` travels between are replaced, `from` holds the previous points */
+    virtual void rerouted(WireEdge const& edge, std::span<const RawPoint> from) { (void)edge; (void)from; }
+
+    virtual ~GraphObserver() = default;
+};
+
+/**
+ * \brief List of observers of a `BoardGraph`, kept in the graph's storage so that edits made through a node reach
+ * the graph's observers. Observers are held weakly and pruned once they expire
+ */
+class GraphObservers {
+public:
+    /** \brief Add an observer to be notified of all later edits */
+    inline void add(WeakRef<GraphObserver> observer) { this->m_observers.push_back(std::move(observer)); }
+
+    /** \brief Invoke `fn` with every observer that is still alive */
+    template<typename F>
+    requires(std::invocable<F, GraphObserver&>)
+    void notify(F&& fn) {
+        for(std::size_t i = 0; i < this->m_observers.size();) {
+            if(auto observer = this->m_observers[i].lock()) {
+                fn(*observer);
+                i += 1;
+            } else {
+                this->m_observers[i] = std::move(this->m_observers.back());
+                this->m_observers.pop_back();
+            }
+        }
+    }
+private:
+    std::vector<WeakRef<GraphObserver>> m_observers{};
 };
 
 /**
@@ -156,8 +244,8 @@ public:
     * and the side of the wire that connects to this node
     */
     struct EdgeConnection {
-       /** \brief A reference to the wire that connects to this node */
-       Ref<WireEdge> edge;
+       /** \brief Handle of the wire that connects to this node, in the same graph's edge storage */
+       ArenaHandle<WireEdge> edge;
        /** \brief What side of the wire connects to this component */
        WireEdge::Side side;
     };
@@ -166,12 +254,17 @@ public:
     
     /** \brief Get the name of this component node */
     inline constexpr const std::string& name() const { return this->m_name; }
-    inline constexpr const std::string_view id() const { return this->m_id; }
+    inline const std::string_view id() const { return this->m_id.str(); }
+    /** \brief Get the interned ID of this component node */
+    inline constexpr Symbol symbol() const noexcept { return this->m_id; }
     inline constexpr const AABB& aabb() const { return this->m_aabb; }
     
+    /** \brief Get the handle of this node in its graph's node storage */
+    inline constexpr Arena<ComponentNode>::size_type handle() const noexcept { return this->m_handle; }
+    
     /** \brief Fetch the underlying component type of this node */
     inline Ref<Component> type() const noexcept { return this->m_ty; }
-    ComponentNode(const std::string_view id) : m_ty{}, m_id{id}, m_name{}, m_pos{} {}
+    ComponentNode(Symbol id) : m_ty{}, m_id{id}, m_name{}, m_pos{} {}
         
     /**
      * \brief Get the wires connected on to a specific port on this component
@@ -188,8 +281,11 @@ public:
      * \param side The side of the wire edge to connect
      * \param force If any existing connection on the given port should be removed
      * \return A reference to the added or existing connection structure or 
-     * an empty optional if this component's type does not have the given port or 
-     * force is false and there is already a connection to the port
+     * an empty optional if this component's type does not have the given port, 
+     * force is false and there is already a connection to the port, or this node does not belong to a graph
+     *
+     * If the given side of `edge` is already attached elsewhere it is detached first, and the graph's observers
+     * are notified of every detach and of the new connection
      */
     Optional<std::reference_wrapper<ComponentNode::EdgeConnection>> connnect_port(
         ConnectionPortIdx port,
@@ -202,33 +298,168 @@ public:
      * \brief Remove a port's connections from this node
      * \param port The port to remove connections from
      */
-    inline void remove_port(ConnectionPortIdx port) {
-        this->m_edges.erase(port);
-    }
+    void remove_port(ConnectionPortIdx port);
     
     /** \brief Get the position of this component */
     inline constexpr const Point& pos() const { return this->m_pos; }
+
+    /**
+     * \brief Get the position of a port in workspace coordinates, read from this node's cache so no footprint
+     * lookup is done
+     * \param port Index of a port on this node's component type, must be valid
+     */
+    inline RawPoint const& port_pos(ConnectionPortIdx port) const noexcept {
+        assert(port < this->m_port_pos.size());
+        return this->m_port_pos[port];
+    }
+    /**
+     * \brief Get the workspace positions of all ports on this node, indexed by `ConnectionPortIdx`. Slots of
+     * removed ports on the component type hold an unspecified position
+     */
+    inline std::span<const RawPoint> port_positions() const noexcept { return this->m_port_pos; }
+
+    /**
+     * \brief Move this node to a new position in the workspace, updating its bounding box and port positions
+     * and notifying the graph's observers
+     */
+    void move_to(Point pos);
 private:
     /** \brief What kind of component this is, shared with other components */
     Ref<Component> m_ty;
     /** 
      * \brief The user-assigned ID of this component node
      */
-    std::string_view m_id;
+    Symbol m_id;
     /** \brief User-assigned name of the placed part */
     std::string m_name;
     /** \brief Offset in the workspace from center */
     Point m_pos;
     /** \brief Cached axis-aligned bounding box that is offset by `m_pos` */
     AABB m_aabb;
+    /** \brief Cached workspace position of every port slot on `m_ty`, offset by `m_pos` */
+    std::vector<RawPoint> m_port_pos;
+
+    /** \brief Recompute the cached bounding box and port positions, must be called whenever `m_ty` or `m_pos` change */
+    void place();
     
     /** \brief All graph edges connecting this component node to others */
     Map<ConnectionPortIdx, EdgeConnection> m_edges;
+    
+    /** \brief Handle of this node in the owning graph's node storage */
+    Arena<ComponentNode>::size_type m_handle{Arena<ComponentNode>::npos};
+    /** \brief Storage of the graph that owns this node, nullptr if the node does not belong to a graph */
+    GraphStorage *m_graph{nullptr};
+    /** \brief Control block shared by every `Ref` to this node, created when the first `Ref` is handed out */
+    mutable Ref<void> m_anchor;
+
+    /** \brief Cut the links of a copy made for a snapshot back to the live graph */
+    void freeze() noexcept;
 
     friend class BoardGraph;
+    friend struct GraphStorage;
+    friend class WireEdge;
+    template<typename, std::size_t> friend class Arena;
     friend class ConnectedNodesIterator;
+    friend class WireIndex;
+    friend class PortIndex;
+    friend class WireLengths;
+    friend struct WireEdge::Connection;
 };
 
+/**
+ * \brief Storage shared by a `BoardGraph` and everything in it. `Ref`s to nodes and edges handed out by the graph
+ * keep the whole storage alive so that they never outlive the memory they point into, and within the storage nodes
+ * and wire ends refer to each other by handle.
+ *
+ * All `Ref`s to one element share a single control block that the element holds while it is in the graph, so a
+ * `WeakRef` expires once the element has been removed and no `Ref` to it is held. An element removed while a `Ref`
+ * to it is held is retired in its arena rather than erased, so the `Ref` keeps pointing at the removed element and
+ * never at whatever is placed next
+ */
+struct GraphStorage : public std::enable_shared_from_this<GraphStorage> {
+    /**
+     * \brief Reference held by the `BoardGraph` that owns a storage. Elements hold the control blocks of their `Ref`s
+     * and those keep the storage alive, so the owner cuts that cycle once the graph is destroyed or replaced
+     */
+    class Owner {
+    public:
+        Owner() : m_storage{new GraphStorage{}} {}
+        Owner(Owner&& other) = default;
+        Owner& operator=(Owner&& other) {
+            if(this != &other) {
+                this->orphan();
+                this->m_storage = std::move(other.m_storage);
+            }
+            return *this;
+        }
+        ~Owner() { this->orphan(); }
+
+        inline GraphStorage* operator->() const noexcept { return this->m_storage.get(); }
+        inline GraphStorage& operator*() const noexcept { return *this->m_storage; }
+        inline GraphStorage* get() const noexcept { return this->m_storage.get(); }
+        /** \brief Get a shared reference to the storage, that does not keep the graph's elements in the graph */
+        inline Ref<GraphStorage> const& shared() const noexcept { return this->m_storage; }
+        inline bool operator==(std::nullptr_t) const noexcept { return this->m_storage == nullptr; }
+    private:
+        Ref<GraphStorage> m_storage;
+
+        /** \brief Drop the control blocks held by the storage's elements, leaving them to the `Ref`s still held */
+        void orphan() noexcept;
+    };
+
+    /** \brief Densely packed storage of all nodes */
+    Arena<ComponentNode> nodes{};
+    /** \brief Densely packed storage of all edges */
+    Arena<WireEdge> edges{};
+    /** \brief Observers notified of edits to the graph */
+    GraphObservers observers{};
+    /**
+     * \brief Graph that owns this storage, kept up to date when the graph is moved and cleared once it is destroyed,
+     * so that anything holding a `WeakRef` to the storage can reach the graph wherever it lives
+     */
+    BoardGraph *graph{nullptr};
+
+    /** \brief Get a shared reference to the live node at the given position */
+    Ref<ComponentNode> node_ref(Arena<ComponentNode>::size_type pos);
+    /** \brief Get a shared reference to the live edge at the given position */
+    Ref<WireEdge> edge_ref(Arena<WireEdge>::size_type pos);
+    /** \brief Remove the node at the given position, retiring it if a `Ref` to it is still held */
+    void erase_node(Arena<ComponentNode>::size_type pos);
+    /** \brief Remove the edge at the given position, retiring it if a `Ref` to it is still held */
+    void erase_edge(Arena<WireEdge>::size_type pos);
+private:
+    /** \brief Set once the owning graph is gone, after which elements no longer hold the control blocks of their `Ref`s */
+    bool m_orphaned{false};
+
+    /** \brief Get a `Ref` to a live element of the given arena, sharing the element's control block if one exists */
+    template<auto Member>
+    auto anchored(std::uint32_t pos);
+    /** \brief Erase an element of the given arena, or retire it if a `Ref` to it is held */
+    template<auto Member>
+    void unanchor(std::uint32_t pos);
+};
+
+inline Optional<std::reference_wrapper<const ComponentNode>> WireEdge::Connection::node() const noexcept {
+    if(this->m_graph == nullptr) {
+        return {};
+    }
+    const ComponentNode *node = std::as_const(this->m_graph->nodes).get(this->m_node);
+    if(node == nullptr) {
+        return {};
+    }
+    return std::cref(*node);
+}
+
+inline bool WireEdge::connects(const Ref<ComponentNode>& node) const {
+    return std::any_of(
+        this->m_conns.begin(),
+        this->m_conns.end(),
+        [&node](const auto& conn) {
+            return !conn.is_floating() && conn.m_graph == node->m_graph && conn.m_node.index == node->m_handle;
+        }
+    );
+}
+
 /**  
  * \brief A graph data structures in which the
  * nodes are `Component`s and the edges are wires
@@ -237,15 +468,21 @@ private:
  */
 class BoardGraph {
 public:
+    /** \brief Stable handle of a node in the graph's node storage */
+    using NodeHandle = Arena<ComponentNode>::size_type;
+    /** \brief Stable handle of an edge in the graph's edge storage */
+    using EdgeHandle = Arena<WireEdge>::size_type;
+
     /**
      * \brief Initialize this board graph, loading or regenerating
      * cached resource files 
      */
-    BoardGraph() = default;
+    BoardGraph() { this->m_storage->graph = this; }
     
     /**
-     * \brief Load a board graph from a saved JSON file, or create a new save file with the given file
-     * \param path Path to a JSON save file that the board graph is stored in
+     * \brief Load a board graph from a saved JSON or binary file, or create a new save file with the given file
+     * \param path Path to a save file that the board graph is stored in, which is saved in the binary format if it
+     * has the binary format's extension
      * \param create If the file at the given path does not exist, should we create it?
      * \param save Wether this board graph should write itself to the save file when the destructor runs
      * \throws std::runtime_error if `create` is false and the file does not exist
@@ -253,15 +490,65 @@ public:
      */
     BoardGraph(std::filesystem::path&& path, bool create = false, bool save = true);
 
-    inline BoardGraph(BoardGraph&& other) = default; 
-    inline BoardGraph& operator=(BoardGraph&& other) = default;
+    /** \brief Move a graph along with its storage, observers that reach the graph through its storage follow it */
+    BoardGraph(BoardGraph&& other);
+    BoardGraph& operator=(BoardGraph&& other);
     
     /**
      * \brief Create a new component node with the given type 
      * \param type The type of component to create
      * \return A reference to the created graph node
+     * \throws std::runtime_error if a node with the given ID already exists
      */
     Ref<ComponentNode> component(Ref<Component> type, const std::string& id, Point pos = Point{}, const std::string_view name = std::string_view{});
+
+    /** \brief Description of a node to be placed by `insert` */
+    struct NodeDesc {
+        /** \brief ID of the new node, must not be used by any other node */
+        std::string_view id;
+        /** \brief Resource ID of the node's component type */
+        std::string_view type;
+        Point pos{};
+        std::string_view name{};
+    };
+
+    /** \brief Description of an edge to be added by `insert` */
+    struct EdgeDesc {
+        /** \brief Description of a single wire end */
+        struct End {
+            /** \brief Resource ID of the connector on this end */
+            std::string_view connector;
+            /** \brief ID of the node to attach to, either already in the graph or in the same batch, empty if floating */
+            std::string_view node{};
+            /** \brief ID of the port to attach to on `node` */
+            std::string_view port{};
+            /** \brief Workspace position of the end if it is floating */
+            Point pos{};
+        };
+
+        /** \brief ID of the new edge, must not be used by any other edge */
+        std::string_view id;
+        /** \brief Both ends of the edge, indexed by `WireEdge::Side` */
+        std::array<End, 2> ends;
+        /** \brief Points that the wire travels between */
+        std::span<const RawPoint> points{};
+    };
+
+    /** \brief Handles of the nodes and edges added by `insert`, in the order they were described */
+    struct Inserted {
+        std::vector<NodeHandle> nodes;
+        std::vector<EdgeHandle> edges;
+    };
+
+    /**
+     * \brief Add many nodes and edges at once. Every ID, component type, connector, and port is resolved before
+     * the graph is modified, with each distinct type loaded only once, and storage is reserved for the whole
+     * batch up front. Observers are notified once the batch has been added
+     * \return Handles of the added nodes and edges
+     * \throws std::runtime_error if any ID is already used in the graph or the batch, any resource or attached
+     * port does not exist, or any port would be connected by more than one wire, the graph is left unchanged
+     */
+    Inserted insert(std::span<const NodeDesc> nodes, std::span<const EdgeDesc> edges = {});
     
     /**
      * \brief Get a reference to the lazy resource loader that this graph loads
@@ -275,6 +562,28 @@ public:
     static void from_json(BoardGraph&, const json&); 
     /** \brief Save this board graph to a file */
     json to_json() const;
+    /**
+     * \brief Write this board graph as JSON text straight to a stream, without building the `json` tree that
+     * `to_json` returns. The text is the same as `to_json().dump(4)`, or `to_json().dump()` if `compact` is set
+     */
+    void write_json(std::ostream& out, bool compact = false) const;
+
+    /**
+     * \brief Load a board graph from a buffer holding a file in the binary format described in `boardfile`, adding
+     * every node and edge in one batch with `insert`
+     * \throws std::runtime_error if the buffer is not a valid binary board file
+     */
+    static void from_binary(BoardGraph&, std::span<const std::byte> bytes);
+    /** \brief Save this board graph in the binary format described in `boardfile` */
+    std::vector<std::byte> to_binary() const;
+
+    /**
+     * \brief Write this board graph to a file, in the binary format if the path has its extension and as JSON otherwise.
+     * The file is only replaced once the whole board has been written next to it
+     * \param compact Write JSON without any whitespace instead of pretty printing it
+     * \throws std::runtime_error if the file cannot be opened or written
+     */
+    void save(std::filesystem::path const& path, bool compact = false) const;
     
     /**
      * \brief Get or load a node in this graph by ID
@@ -282,41 +591,139 @@ public:
      * \return An empty optional if the file for the UUID does not exist
      */
     Optional<Ref<ComponentNode>> get_node(const std::string_view id) const;
+    /** \brief Get a node in this graph by interned ID */
+    Optional<Ref<ComponentNode>> get_node(Symbol id) const;
     /**
      * \brief Get or load an edge in this graph by ID
      * \param id UUID of the loaded edge
      * \return An empty optional if the file does not exis
      */
     Optional<Ref<WireEdge>> get_edge(const std::string_view id) const;
+    /** \brief Get an edge in this graph by interned ID */
+    Optional<Ref<WireEdge>> get_edge(Symbol id) const;
+    
+    /**
+     * \brief Get the number of placed nodes of every component type on this board, kept up to date as nodes are
+     * added and removed. Types with no placed nodes are not listed
+     */
+    inline Map<Ref<Component>, std::size_t> const& component_counts() const noexcept { return this->m_component_counts; }
+    /**
+     * \brief Get the number of wire ends using every connector type on this board, an edge counts once for each
+     * of its ends. Types with no wire ends are not listed
+     */
+    inline Map<Ref<Connector>, std::size_t> const& connector_counts() const noexcept { return this->m_connector_counts; }
+    /** \brief Get the number of placed nodes of the given component type */
+    std::size_t count(Ref<Component> const& type) const;
+    /** \brief Get the number of wire ends using the given connector type */
+    std::size_t count(Ref<Connector> const& type) const;
+
+    /** \brief Get the handle of the node with the given ID, if the node exists */
+    Optional<NodeHandle> node_handle(Symbol id) const;
+    /** \brief Get the handle of the edge with the given ID, if the edge exists */
+    Optional<EdgeHandle> edge_handle(Symbol id) const;
+    /**
+     * \brief Register an observer to be notified of every edit made to this graph from now on, edits are not
+     * published while loading so observers should be attached to a fully loaded graph. The graph does not keep
+     * the observer alive
+     */
+    inline void observe(WeakRef<GraphObserver> observer) { this->m_storage->observers.add(std::move(observer)); }
+    /**
+     * \brief Build an observer from this graph and register it with `observe`, the graph should be fully loaded.
+     * `args` are passed to the observer's constructor after the graph
+     * \return The observer, which stops being notified once every `Ref` to it is dropped
+     */
+    template<typename T, typename... Args>
+    requires(std::derived_from<T, GraphObserver>)
+    Ref<T> track(Args&&... args) {
+        Ref<T> observer{new T{*this, std::forward<Args>(args)...}};
+        this->observe(observer);
+        return observer;
+    }
+
+    /**
+     * \brief Create a new wire edge with both ends floating, ends are attached with `ComponentNode::connnect_port`
+     * \param id ID of the new edge
+     * \param connectors Connector types of the left and right ends
+     * \param ends Workspace positions of the left and right ends
+     * \param points Points that the wire travels between
+     * \throws std::runtime_error if an edge with the given ID already exists
+     */
+    Ref<WireEdge> edge(
+        const std::string& id,
+        std::array<Ref<Connector>, 2> connectors,
+        std::array<Point, 2> ends = {},
+        std::vector<RawPoint> points = {}
+    );
+
+    /**
+     * \brief Remove a node from the graph, detaching every wire attached to it first. Every `WeakRef` to the node
+     * expires once no `Ref` to it is held. A `Ref` held across the removal keeps the removed node alive, detached
+     * from the graph, and its handle is not given to another node until that `Ref` is dropped
+     * \throws std::runtime_error if the graph has no node with the given handle
+     */
+    void remove_node(NodeHandle handle);
+    /**
+     * \brief Remove an edge from the graph, detaching both of its ends first. Outstanding `Ref`s and `WeakRef`s
+     * behave as they do for `remove_node`
+     * \throws std::runtime_error if the graph has no edge with the given handle
+     */
+    void remove_edge(EdgeHandle handle);
+    /**
+     * \brief Replace the points that an edge travels between, notifying observers with the old points
+     * \throws std::runtime_error if the graph has no edge with the given handle
+     */
+    void reroute(EdgeHandle handle, std::vector<RawPoint> points);
+
+    /**
+     * \brief Take an immutable snapshot of the nodes and edges of this graph that other threads can read without
+     * locking while this graph is edited. Only storage chunks modified since the last snapshot are copied
+     */
+    BoardSnapshot snapshot();
+
+    /**
+     * \brief Get a shared reference to the node with the given handle, shared with every other `Ref` to the node
+     * \throws std::runtime_error if the graph has no node with the given handle
+     */
+    Ref<ComponentNode> node_ref(NodeHandle handle) const;
+    /**
+     * \brief Get a shared reference to the edge with the given handle, shared with every other `Ref` to the edge
+     * \throws std::runtime_error if the graph has no edge with the given handle
+     */
+    Ref<WireEdge> edge_ref(EdgeHandle handle) const;
+    /**
+     * \brief Get the node with the given handle without sharing ownership of it, for reads that do not outlive the
+     * next edit of the graph. If the node was removed this is UB
+     */
+    inline ComponentNode const& node_at(NodeHandle handle) const { return this->m_storage->nodes.at(handle); }
     
     /** Save this graph to a file */
     virtual ~BoardGraph();
     
     /**
      * \brief structure with `begin` and `end` methods to allow an iteration over nodes in a board graph
-     * using an enhanced for loop
+     * using an enhanced for loop, visiting nodes in storage order
      */
     struct NodeIterator {
     public:
-        using iterator_type = Map<std::string, Ref<ComponentNode>>::iterator;
+        using iterator_type = Arena<ComponentNode>::iterator;
 
         constexpr NodeIterator(BoardGraph& graph) : m_graph{graph} {}
-        inline iterator_type begin() { return this->m_graph.m_nodes.begin(); }
-        inline iterator_type end() { return this->m_graph.m_nodes.end(); }
+        inline iterator_type begin() { return this->m_graph.m_storage->nodes.begin(); }
+        inline iterator_type end() { return this->m_graph.m_storage->nodes.end(); }
     private:
         BoardGraph& m_graph;
     };
     
     /**
      * \brief Structure referencing a `BoardGraph` that allows iteration over edges in the graph
-     * using an enhanced for loop
+     * using an enhanced for loop, visiting edges in storage order
      */
     struct EdgeIterator {
     public:
-        using iterator_type = Map<std::string, Ref<WireEdge>>::iterator;
+        using iterator_type = Arena<WireEdge>::iterator;
         constexpr EdgeIterator(BoardGraph& graph) : m_graph{graph} {}
-        inline iterator_type begin() { return this->m_graph.m_edges.begin(); }
-        inline iterator_type end() { return this->m_graph.m_edges.end(); }
+        inline iterator_type begin() { return this->m_graph.m_storage->edges.begin(); }
+        inline iterator_type end() { return this->m_graph.m_storage->edges.end(); }
     private:
         BoardGraph& m_graph;
     };
@@ -331,27 +738,109 @@ private:
     /** \brief Collection of all loaded component types */
     LazyResourceStore m_res;
     
-    /** \brief Map of internal node IDs to shared node references */
-    Map<std::string, Ref<ComponentNode>> m_nodes;
-    /** \brief Map of internal node IDs to shared node references */
-    Map<std::string, Ref<WireEdge>> m_edges;
+    /** \brief Storage of all nodes, edges, and observers of this graph */
+    GraphStorage::Owner m_storage{};
+    /** \brief Secondary index of node IDs to handles into the node storage */
+    Map<Symbol, NodeHandle> m_node_ids;
+    /** \brief Secondary index of edge IDs to handles into the edge storage */
+    Map<Symbol, EdgeHandle> m_edge_ids;
+    /** \brief Secondary index of component types to the number of nodes placed with that type */
+    Map<Ref<Component>, std::size_t> m_component_counts;
+    /** \brief Secondary index of connector types to the number of wire ends using that connector */
+    Map<Ref<Connector>, std::size_t> m_connector_counts;
+    
+    /** \brief Give a newly placed node its handle and a link back to this graph's storage */
+    void adopt(NodeHandle handle);
+
+    /** \brief Update the type counts for a node that was added to or is about to be removed from the graph */
+    void tally(ComponentNode const& node, bool added);
+    /** \brief Update the connector counts for an edge that was added to or is about to be removed from the graph */
+    void tally(WireEdge const& edge, bool added);
+
+    /** \brief Serialize the nodes and edges of either a graph's storage or a snapshot of it */
+    template<typename Nodes, typename Edges>
+    static json to_json(Nodes const& nodes, Edges const& edges);
+    /** \brief Stream the nodes and edges of either a graph's storage or a snapshot of it in the format of `to_json` */
+    template<typename Nodes, typename Edges>
+    static void write_json(std::ostream& out, Nodes const& nodes, Edges const& edges, bool compact);
+
     
     /**
-     * \brief Ensure that a node with the given ID has been loaded from the root object
-     * \param id The ID string of the node, must be a valid UUID or the node will not be loaded
-     * \param obj Root JSON object passed to `from_json`
+     * \brief Add a node read by a loader unless a node with its ID has already been loaded, without notifying
+     * observers
+     * \return Handle of the new node, or `npos` if a node with the same ID was already loaded
+     * \throws std::runtime_error if the node's component type cannot be loaded
+     */
+    NodeHandle load_node(NodeDesc const& desc);
+    /**
+     * \brief Add an edge read by a loader unless an edge with its ID has already been loaded, without notifying
+     * observers. Ends that attach to a node are left floating, to be attached with `attach_loaded` once every node
+     * has been loaded
+     * \return Handle of the new edge, or `npos` if an edge with the same ID was already loaded
+     * \throws std::runtime_error if a connector does not exist
      */
-    void load_node(const std::string& id, const json& obj);
+    EdgeHandle load_edge(EdgeDesc const& desc);
     /**
-     * \brief Ensure that an edge with the given ID has been loaded from the root object
-     * \param id The ID string, must be a valid UUID
-     * \param obj Root JSON object passed to `from_json`
+     * \brief Attach an end of a loaded edge to a port of a loaded node, without notifying observers
+     * \return false if the port is already connected, leaving the graph unchanged
      */
-    void load_edge(const std::string& id, const json& obj);
+    bool attach_loaded(EdgeHandle edge, WireEdge::Side side, NodeHandle node, ConnectionPortIdx port);
     
     /** \brief Path to a file used for saving and loading this board graph */
     std::filesystem::path m_path;
     
     /** \brief If we should serialize this board to our stored save file on destruction */
     bool m_save{false};
+
+    friend class NetIndex;
+    friend class SpatialIndex;
+    friend class WireIndex;
+    friend class PortIndex;
+    friend class WireLengths;
+    friend class BoardSnapshot;
+    friend class BoardLoader;
+    friend class Journal;
+};
+
+/**
+ * \brief Immutable copy of the nodes and edges of a `BoardGraph` at one point in time, made by
+ * `BoardGraph::snapshot`. A snapshot may be read from any thread while the graph keeps being edited, unchanged
+ * storage is shared between snapshots so keeping one alive is cheap.
+ *
+ * Elements in a snapshot never link back to the live graph. Wire ends keep the position they had when the snapshot
+ * was taken, but `WireEdge::Connection::node`, `port` and `component` are empty for them, the node that an end is
+ * attached to is resolved within the snapshot with `node`
+ */
+class BoardSnapshot {
+public:
+    using NodeStore = Arena<ComponentNode>::Snapshot;
+    using EdgeStore = Arena<WireEdge>::Snapshot;
+
+    /** \brief Create a snapshot of an empty graph */
+    BoardSnapshot() = default;
+
+    /** \brief Get all nodes in the snapshot, indexed by `BoardGraph::NodeHandle` */
+    inline constexpr NodeStore const& nodes() const noexcept { return this->m_nodes; }
+    /** \brief Get all edges in the snapshot, indexed by `BoardGraph::EdgeHandle` */
+    inline constexpr EdgeStore const& edges() const noexcept { return this->m_edges; }
+
+    /**
+     * \brief Get the node that a wire end in this snapshot is attached to
+     * \return nullptr if the end is floating
+     */
+    inline ComponentNode const* node(WireEdge::Connection const& conn) const noexcept {
+        return conn.is_floating() ? nullptr : this->m_nodes.get(conn.m_node);
+    }
+
+    /** \brief Serialize this snapshot in the same format as `BoardGraph::to_json` */
+    json to_json() const;
+    /** \brief Write this snapshot as JSON text in the same format as `BoardGraph::write_json` */
+    void write_json(std::ostream& out, bool compact = false) const;
+private:
+    NodeStore m_nodes{};
+    EdgeStore m_edges{};
+
+    BoardSnapshot(NodeStore&& nodes, EdgeStore&& edges) : m_nodes{std::move(nodes)}, m_edges{std::move(edges)} {}
+
+    friend class BoardGraph;
 };
@@ -0,0 +1,634 @@
+#include "loader.hpp"
+#include "util/log.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#include <doctest.h>
+
+#include "testing.hpp"
+
+void BoardLoader::load(BoardGraph& graph, std::string_view text) {
+    BoardLoader loader{graph};
+    json::sax_parse(text.begin(), text.end(), &loader);
+}
+
+void BoardLoader::node(BoardGraph::NodeDesc const& desc, std::span<const NodeConn> conns) {
+    if(desc.id.empty()) {
+        throw std::runtime_error{"Failed to load graph node: Node IDs must not be empty"};
+    }
+    const BoardGraph::NodeHandle handle = this->m_graph.load_node(desc);
+    if(handle == Arena<ComponentNode>::npos) {
+        return;
+    }
+    for(const NodeConn& conn : conns) {
+        this->m_listed.push_back(Listed{
+            .node = handle,
+            .side = conn.side,
+            .port = Symbol::intern(conn.port),
+            .edge = Symbol::intern(conn.edge),
+        });
+    }
+}
+
+void BoardLoader::edge(BoardGraph::EdgeDesc const& desc) {
+    if(desc.id.empty()) {
+        throw std::runtime_error{"Failed to load graph edge: Edge IDs must not be empty"};
+    }
+    const BoardGraph::EdgeHandle handle = this->m_graph.load_edge(desc);
+    if(handle == Arena<WireEdge>::npos) {
+        return;
+    }
+    for(std::size_t side = 0; side < desc.ends.size(); ++side) {
+        const BoardGraph::EdgeDesc::End& end = desc.ends[side];
+        if(!end.node.empty()) {
+            this->m_fixups.push_back(Fixup{
+                .edge = handle,
+                .side = static_cast<WireEdge::Side>(side),
+                .node = Symbol::intern(end.node),
+                .port = Symbol::intern(end.port),
+            });
+        }
+    }
+}
+
+void BoardLoader::finish() {
+    GraphStorage& storage = *this->m_graph.m_storage;
+    //Only the kind and position of each failure is recorded while resolving, messages are formatted at the end
+    std::vector<Failure> failures{};
+    //Index of every wire end that attached
+    std::vector<std::size_t> attached{};
+    attached.reserve(this->m_fixups.size());
+    for(std::size_t i = 0; i < this->m_fixups.size(); ++i) {
+        const Fixup& fix = this->m_fixups[i];
+        const Optional<BoardGraph::NodeHandle> node = this->m_graph.node_handle(fix.node);
+        if(!node.has_value()) {
+            failures.push_back(Failure{.kind = Failure::NO_NODE, .index = i});
+            continue;
+        }
+        const Optional<ConnectionPortIdx> port = storage.nodes.at(node.unwrap_unchecked()).type()->get_port_idx(fix.port);
+        if(!port.has_value()) {
+            failures.push_back(Failure{.kind = Failure::NO_PORT, .index = i});
+            continue;
+        }
+        if(!this->m_graph.attach_loaded(fix.edge, fix.side, node.unwrap_unchecked(), port.unwrap_unchecked())) {
+            failures.push_back(Failure{.kind = Failure::PORT_TAKEN, .index = i});
+            continue;
+        }
+        attached.push_back(i);
+    }
+
+    //Every end is attached, so a listed connection is consistent exactly when the port records the same edge end.
+    //Checking them after a wire end failed to attach would only repeat that failure
+    if(failures.empty()) {
+        //Wire ends claimed by a listed connection, indexed by edge handle and side
+        std::vector<bool> claimed(static_cast<std::size_t>(storage.edges.slots()) * 2, false);
+        for(std::size_t i = 0; i < this->m_listed.size(); ++i) {
+            const Listed& listed = this->m_listed[i];
+            ComponentNode& node = storage.nodes.at(listed.node);
+            const Optional<BoardGraph::EdgeHandle> edge = this->m_graph.edge_handle(listed.edge);
+            const Optional<ConnectionPortIdx> port = node.type()->get_port_idx(listed.port);
+            bool agrees = edge.has_value() && port.has_value();
+            if(agrees) {
+                const auto conn = node.port(port.unwrap_unchecked());
+                agrees = conn.has_value() &&
+                    conn.unwrap_unchecked().get().edge.index == edge.unwrap_unchecked() &&
+                    conn.unwrap_unchecked().get().side == listed.side;
+            }
+            if(!agrees) {
+                failures.push_back(Failure{.kind = Failure::NOT_ATTACHED, .index = i});
+                continue;
+            }
+            claimed[static_cast<std::size_t>(edge.unwrap_unchecked()) * 2 + listed.side] = true;
+        }
+        //The wire end is the record that attaches the port, so an end that its node does not list stays attached
+        for(const std::size_t i : attached) {
+            const Fixup& fix = this->m_fixups[i];
+            if(!claimed[static_cast<std::size_t>(fix.edge) * 2 + fix.side]) {
+                logger::warn(
+                    "Node {} does not list the connection of port {} to edge {}, loading it from the edge",
+                    fix.node.str(),
+                    fix.port.str(),
+                    storage.edges.at(fix.edge).id()
+                );
+            }
+        }
+    }
+
+    std::string error{};
+    if(!failures.empty()) {
+        error = this->describe(failures);
+    }
+    this->m_fixups.clear();
+    this->m_listed.clear();
+    if(!error.empty()) {
+        throw std::runtime_error{error};
+    }
+}
+
+std::string BoardLoader::describe(std::span<const Failure> failures) const {
+    GraphStorage const& storage = *this->m_graph.m_storage;
+    std::string error{};
+    for(std::size_t i = 0; i < std::min(failures.size(), MAX_REPORTED); ++i) {
+        const Failure& failure = failures[i];
+        if(i != 0) {
+            error += '\n';
+        }
+        if(failure.kind == Failure::NOT_ATTACHED) {
+            const Listed& listed = this->m_listed[failure.index];
+            error += fmt::format(
+                "Failed to load graph node with ID {}: Port {} is listed as connected to edge {}, which does not attach to it",
+                storage.nodes.at(listed.node).id(),
+                listed.port.str(),
+                listed.edge.str()
+            );
+            continue;
+        }
+
+        const Fixup& fix = this->m_fixups[failure.index];
+        const std::string_view edge = storage.edges.at(fix.edge).id();
+        switch(failure.kind) {
+            case Failure::NO_NODE: {
+                error += fmt::format(
+                    "Failed to load graph edge with ID {}: Edge {} connects to nonexistent node with {}",
+                    edge,
+                    edge,
+                    fix.node.str()
+                );
+            } break;
+            case Failure::NO_PORT: {
+                const ComponentNode& node = storage.nodes.at(this->m_graph.node_handle(fix.node).unwrap_unchecked());
+                error += fmt::format(
+                    "Failed to load graph edge with ID {}: Component {} has no port with ID {}",
+                    edge,
+                    node.type()->id(),
+                    fix.port.str()
+                );
+            } break;
+            case Failure::PORT_TAKEN: {
+                error += fmt::format(
+                    "Failed to load graph edge with ID {}: Port {} of node {} is already connected",
+                    edge,
+                    fix.port.str(),
+                    fix.node.str()
+                );
+            } break;
+            default: break;
+        }
+    }
+    if(failures.size() > MAX_REPORTED) {
+        error += fmt::format("\n{} more references failed to load", failures.size() - MAX_REPORTED);
+    }
+    return error;
+}
+
+BoardLoader::Slot BoardLoader::slot() const noexcept {
+    //Fields are matched by the keys last read, which only apply while the containers around the value have the
+    //kinds that the format gives them
+    const auto array = [this](std::size_t depth) { return this->m_objects.size() >= depth && !this->m_objects[depth - 1]; };
+    const auto object = [this](std::size_t depth) { return this->m_objects.size() >= depth && this->m_objects[depth - 1]; };
+    switch(this->m_depth) {
+        case 3: {
+            if(this->m_section != Section::NODES) {
+                return Slot::NONE;
+            }
+            return this->m_field == "type" ? Slot::NODE_TYPE : this->m_field == "name" ? Slot::NODE_NAME : Slot::NONE;
+        }
+        case 4: return (this->m_section == Section::NODES && this->m_field == "pos" && array(4)) ? Slot::NODE_POS : Slot::NONE;
+        case 5: {
+            if(!object(5) || !array(4)) {
+                return Slot::NONE;
+            }
+            if(this->in_conns(Section::NODES)) {
+                return this->m_conn_field == "port" ? Slot::CONN_PORT :
+                    this->m_conn_field == "edge" ? Slot::CONN_EDGE :
+                    this->m_conn_field == "side" ? Slot::CONN_SIDE : Slot::NONE;
+            } else if(this->in_conns(Section::EDGES)) {
+                return this->m_conn_field == "connector" ? Slot::END_CONNECTOR :
+                    this->m_conn_field == "node" ? Slot::END_NODE :
+                    this->m_conn_field == "port" ? Slot::END_PORT : Slot::NONE;
+            }
+            return Slot::NONE;
+        }
+        case 6: {
+            return (this->in_conns(Section::EDGES) && this->m_conn_field == "pos" && array(6) && object(5) && array(4)) ?
+                Slot::END_POS : Slot::NONE;
+        }
+        default: return Slot::NONE;
+    }
+}
+
+void BoardLoader::fail(std::string_view what) const {
+    throw std::runtime_error{fmt::format(
+        "Failed to load graph {} with ID {}: {}",
+        this->m_section == Section::NODES ? "node" : "edge",
+        this->m_item.id,
+        what
+    )};
+}
+
+void BoardLoader::shape(bool object) const {
+    //The connections of a node or edge must be an array of objects, other values below the nodes and edges are
+    //checked field by field as they are read
+    if(this->m_depth == 3 && object && (this->in_conns(Section::NODES) || this->in_conns(Section::EDGES))) {
+        this->fail("The 'conns' field must be an array");
+    }
+    if(this->m_depth == 4 && !object && (this->in_conns(Section::NODES) || this->in_conns(Section::EDGES))) {
+        this->fail("Every connection in 'conns' must be an object");
+    }
+    if(object || this->m_depth > 2) {
+        return;
+    }
+    if(this->m_depth == 0) {
+        throw std::runtime_error{"A board must be a JSON object"};
+    }
+    if(this->m_section == Section::NONE) {
+        return;
+    }
+    if(this->m_depth == 1) {
+        throw std::runtime_error{fmt::format(
+            "The '{}' field of a board must be an object",
+            this->m_section == Section::NODES ? "nodes" : "edges"
+        )};
+    }
+    this->fail("Expected an object");
+}
+
+bool BoardLoader::scalar() {
+    this->shape(false);
+    if(this->slot() != Slot::NONE) {
+        this->fail("Expected a string");
+    }
+    return true;
+}
+
+bool BoardLoader::null() { return this->scalar(); }
+bool BoardLoader::boolean(bool) { return this->scalar(); }
+bool BoardLoader::number_float(number_float_t, const string_t&) { return this->scalar(); }
+bool BoardLoader::binary(binary_t&) { return this->scalar(); }
+
+bool BoardLoader::number_integer(number_integer_t val) {
+    if(val < 0) {
+        return this->scalar();
+    }
+    return this->number_unsigned(static_cast<number_unsigned_t>(val));
+}
+
+bool BoardLoader::number_unsigned(number_unsigned_t val) {
+    if(this->slot() != Slot::CONN_SIDE) {
+        return this->scalar();
+    }
+    if(val > WireEdge::RIGHT) {
+        this->fail("The side of a connection must be 0 or 1");
+    }
+    Conn& conn = this->conn();
+    conn.side = static_cast<WireEdge::Side>(val);
+    conn.has[2] = true;
+    return true;
+}
+
+bool BoardLoader::string(string_t& val) {
+    this->shape(false);
+    const Slot slot = this->slot();
+    switch(slot) {
+        case Slot::NONE: break;
+        case Slot::CONN_SIDE: this->fail("The side of a connection must be 0 or 1");
+        case Slot::NODE_TYPE: {
+            this->m_item.type = std::move(val);
+            this->m_item.has[0] = true;
+        } break;
+        case Slot::NODE_NAME: {
+            this->m_item.name = std::move(val);
+            this->m_item.has[1] = true;
+        } break;
+        case Slot::CONN_PORT: {
+            this->conn().port = std::move(val);
+            this->conn().has[0] = true;
+        } break;
+        case Slot::CONN_EDGE: {
+            this->conn().edge = std::move(val);
+            this->conn().has[1] = true;
+        } break;
+        case Slot::END_CONNECTOR: this->end().connector = std::move(val); break;
+        case Slot::END_NODE: this->end().node = std::move(val); break;
+        case Slot::END_PORT: this->end().port = std::move(val); break;
+        case Slot::NODE_POS:
+        case Slot::END_POS: {
+            if(this->m_coord >= 2) {
+                this->fail("A position must have exactly two coordinates");
+            }
+            Point& pos = (slot == Slot::NODE_POS) ? this->m_item.pos : this->end().pos;
+            try {
+                Length::from_string((this->m_coord == 0) ? pos.x : pos.y, val);
+            } catch(const std::exception& e) {
+                this->fail(e.what());
+            }
+            this->m_coord += 1;
+        } break;
+    }
+    return true;
+}
+
+bool BoardLoader::start_object(std::size_t) {
+    this->shape(true);
+    this->open(true);
+    if(this->m_depth == 2 && this->m_section == Section::NODES) {
+        this->m_seen[0] = true;
+    } else if(this->m_depth == 2 && this->m_section == Section::EDGES) {
+        this->m_seen[1] = true;
+    } else if(this->m_depth == 3 && this->m_section != Section::NONE) {
+        //The ID was already read from the key of this object
+        Item& item = this->m_item;
+        item.has = {};
+        item.pos = Point{};
+        item.conns.clear();
+        item.ends_len = 0;
+        this->m_field.clear();
+    } else if(this->m_depth == 5 && this->in_conns(Section::NODES)) {
+        this->m_item.conns.emplace_back();
+    } else if(this->m_depth == 5 && this->in_conns(Section::EDGES)) {
+        End& end = this->end();
+        end.connector.clear();
+        end.node.clear();
+        end.port.clear();
+        end.pos = Point{};
+        end.has_pos = false;
+    }
+    return true;
+}
+
+bool BoardLoader::key(string_t& val) {
+    switch(this->m_depth) {
+        case 1: {
+            this->m_section = (val == "nodes") ? Section::NODES : (val == "edges") ? Section::EDGES : Section::NONE;
+        } break;
+        case 2: {
+            if(this->m_section != Section::NONE && val.empty()) {
+                throw std::runtime_error{fmt::format(
+                    "Failed to load graph {}: IDs must not be empty",
+                    this->m_section == Section::NODES ? "node" : "edge"
+                )};
+            }
+            this->m_item.id = std::move(val);
+        } break;
+        case 3: this->m_field = std::move(val); break;
+        case 5: this->m_conn_field = std::move(val); break;
+        default: break;
+    }
+    return true;
+}
+
+bool BoardLoader::end_object() {
+    if(this->m_depth == 3 && this->m_section == Section::NODES) {
+        this->finish_node();
+    } else if(this->m_depth == 3 && this->m_section == Section::EDGES) {
+        this->finish_edge();
+    } else if(this->m_depth == 5 && this->in_conns(Section::NODES)) {
+        this->finish_conn();
+    } else if(this->m_depth == 5 && this->in_conns(Section::EDGES)) {
+        this->finish_end();
+        this->m_item.ends_len += 1;
+    } else if(this->m_depth == 1) {
+        if(!this->m_seen[0] || !this->m_seen[1]) {
+            throw std::runtime_error{fmt::format("A board must have a '{}' object", this->m_seen[0] ? "edges" : "nodes")};
+        }
+        this->finish();
+    }
+    this->close();
+    return true;
+}
+
+bool BoardLoader::start_array(std::size_t) {
+    this->shape(false);
+    this->open(false);
+    if(this->slot() == Slot::NODE_POS || this->slot() == Slot::END_POS) {
+        this->m_coord = 0;
+    } else if(this->m_depth == 4 && this->in_conns(Section::NODES)) {
+        this->m_item.has[3] = true;
+    }
+    return true;
+}
+
+bool BoardLoader::end_array() {
+    const Slot slot = this->slot();
+    if(slot == Slot::NODE_POS || slot == Slot::END_POS) {
+        if(this->m_coord != 2) {
+            this->fail("A position must have exactly two coordinates");
+        }
+        if(slot == Slot::NODE_POS) {
+            this->m_item.has[2] = true;
+        } else {
+            this->end().has_pos = true;
+        }
+    }
+    this->close();
+    return true;
+}
+
+void BoardLoader::open(bool object) {
+    this->m_depth += 1;
+    this->m_objects.push_back(object);
+    //Keys read in an enclosing container never describe the values of a new one, except for the position array
+    //of a wire end which is matched by the key it was read under
+    if(this->m_depth <= 5) {
+        this->m_conn_field.clear();
+    }
+}
+
+void BoardLoader::close() {
+    this->m_depth -= 1;
+    this->m_objects.pop_back();
+}
+
+BoardLoader::End& BoardLoader::end() {
+    if(this->m_item.ends_len >= this->m_item.ends.size()) {
+        this->fail("Wire edges must have exactly two connections");
+    }
+    return this->m_item.ends[this->m_item.ends_len];
+}
+
+BoardLoader::Conn& BoardLoader::conn() {
+    if(this->m_item.conns.empty()) {
+        this->fail("Every connection in 'conns' must be an object");
+    }
+    return this->m_item.conns.back();
+}
+
+bool BoardLoader::parse_error(std::size_t, const std::string&, const nlohmann::detail::exception& ex) {
+    throw std::runtime_error{ex.what()};
+}
+
+void BoardLoader::finish_node() {
+    constexpr const std::array<std::string_view, 4> FIELDS{"type", "name", "pos", "conns"};
+    for(std::size_t i = 0; i < FIELDS.size(); ++i) {
+        if(!this->m_item.has[i]) {
+            this->fail(fmt::format("Missing field '{}'", FIELDS[i]));
+        }
+    }
+
+    std::vector<NodeConn> conns{};
+    conns.reserve(this->m_item.conns.size());
+    for(const Conn& conn : this->m_item.conns) {
+        conns.push_back(NodeConn{.port = conn.port, .edge = conn.edge, .side = conn.side});
+    }
+    this->node(
+        BoardGraph::NodeDesc{
+            .id = this->m_item.id,
+            .type = this->m_item.type,
+            .pos = this->m_item.pos,
+            .name = this->m_item.name,
+        },
+        conns
+    );
+}
+
+void BoardLoader::finish_edge() {
+    if(this->m_item.ends_len != 2) {
+        this->fail("Wire edges must have exactly two connections");
+    }
+    BoardGraph::EdgeDesc desc{.id = this->m_item.id, .ends{}, .points{}};
+    for(std::size_t side = 0; side < desc.ends.size(); ++side) {
+        const End& end = this->m_item.ends[side];
+        desc.ends[side] = BoardGraph::EdgeDesc::End{
+            .connector = end.connector,
+            .node = end.node,
+            .port = end.port,
+            .pos = end.pos,
+        };
+    }
+    this->edge(desc);
+}
+
+void BoardLoader::finish_conn() {
+    constexpr const std::array<std::string_view, 3> FIELDS{"port", "edge", "side"};
+    for(std::size_t i = 0; i < FIELDS.size(); ++i) {
+        if(!this->conn().has[i]) {
+            this->fail(fmt::format("Missing field '{}' in connection", FIELDS[i]));
+        }
+    }
+}
+
+void BoardLoader::finish_end() {
+    End& end = this->end();
+    if(end.connector.empty()) {
+        this->fail("Missing field 'connector'");
+    }
+    //An end is only attached when both its node and port are given, otherwise it must have a position
+    if(end.node.empty() || end.port.empty()) {
+        if(!end.has_pos) {
+            this->fail("Wire edge connection JSON must have either a 'pos' field if the edge is floating or a 'node' and 'port' ID field");
+        }
+        end.node.clear();
+    }
+}
+
+TEST_CASE("BoardLoader") {
+    const testing::AssetDir assets{};
+    BoardGraph graph = testing::asset_board();
+    //Message of the error thrown when loading the given text, or an empty string if it loads
+    const auto error = [&graph](std::string const& text) {
+        try {
+            BoardLoader::load(graph, text);
+        } catch(const std::runtime_error& e) {
+            return std::string{e.what()};
+        }
+        return std::string{};
+    };
+    const auto node = [](std::string_view id, std::string_view conns) {
+        return fmt::format(
+            R"("{}": {{"type": "1280.test", "name": "", "pos": ["0in", "0in"], "conns": [{}]}})",
+            id,
+            conns
+        );
+    };
+    const auto edge = [](std::string_view id, std::string_view node) {
+        return fmt::format(
+            R"("{}": {{"conns": [{{"connector": "1280.bare", "node": "{}", "port": "pwm0"}}, {{"connector": "1280.bare", "pos": ["1in", "2in"]}}]}})",
+            id,
+            node
+        );
+    };
+    const auto listed = [](std::string_view edge) {
+        return fmt::format(R"({{"port": "pwm0", "edge": "{}", "side": 0}})", edge);
+    };
+
+    SUBCASE("nodes after edges") {
+        CHECK_EQ(error(fmt::format(
+            R"({{"edges": {{{}}}, "nodes": {{{}}}}})",
+            edge("l.e", "l.a"),
+            node("l.a", listed("l.e"))
+        )), "");
+        const Ref<ComponentNode> a = graph.get_node("l.a").unwrap();
+        const Ref<WireEdge> e = graph.get_edge("l.e").unwrap();
+        REQUIRE(e->side(WireEdge::LEFT).node().has_value());
+        CHECK_EQ(e->side(WireEdge::LEFT).node().unwrap().get().id(), "l.a");
+        CHECK_FALSE(e->side(WireEdge::RIGHT).node().has_value());
+        CHECK(a->port(a->type()->get_port_idx("pwm0").unwrap()).has_value());
+    }
+
+    SUBCASE("inconsistent references") {
+        //Both edges attach the same port, so the second cannot
+        CHECK_NE(error(fmt::format(
+            R"({{"nodes": {{{}}}, "edges": {{{}, {}}}}})",
+            node("l.a", listed("l.e0")),
+            edge("l.e0", "l.a"),
+            edge("l.e1", "l.a")
+        )).find("Port pwm0 of node l.a is already connected"), std::string::npos);
+
+        CHECK_NE(error(fmt::format(
+            R"({{"nodes": {{{}}}, "edges": {{{}}}}})",
+            node("l.b", listed("l.f")),
+            edge("l.f", "test")
+        )).find("Port pwm0 is listed as connected to edge l.f"), std::string::npos);
+
+    }
+
+    SUBCASE("connections missing from a node are loaded from the edge") {
+        CHECK_EQ(error(fmt::format(
+            R"({{"nodes": {{{}}}, "edges": {{{}}}}})",
+            node("l.c", ""),
+            edge("l.g", "l.c")
+        )), "");
+        const Ref<ComponentNode> c = graph.get_node("l.c").unwrap();
+        const Ref<WireEdge> g = graph.get_edge("l.g").unwrap();
+        REQUIRE(g->side(WireEdge::LEFT).node().has_value());
+        CHECK_EQ(g->side(WireEdge::LEFT).node().unwrap().get().id(), "l.c");
+        CHECK(c->port(c->type()->get_port_idx("pwm0").unwrap()).has_value());
+    }
+
+    SUBCASE("reported failures are capped") {
+        std::string edges{};
+        for(std::size_t i = 0; i < BoardLoader::MAX_REPORTED + 4; ++i) {
+            edges += fmt::format("{}{}", i == 0 ? "" : ", ", edge(fmt::format("l.e{}", i), "l.missing"));
+        }
+        const std::string message = error(fmt::format(R"({{"nodes": {{}}, "edges": {{{}}}}})", edges));
+        CHECK_EQ(static_cast<std::size_t>(std::count(message.begin(), message.end(), '\n')), BoardLoader::MAX_REPORTED);
+        CHECK(message.ends_with("\n4 more references failed to load"));
+    }
+
+    SUBCASE("malformed boards") {
+        for(std::string const& text : {
+            std::string{R"([])"},
+            std::string{R"("board")"},
+            std::string{R"({"nodes": {}})"},
+            std::string{R"({"edges": {}})"},
+            std::string{R"({"nodes": [], "edges": {}})"},
+            std::string{R"({"nodes": {}, "edges": 1})"},
+            std::string{R"({"nodes": {"l.a": []}, "edges": {}})"},
+            std::string{R"({"nodes": {}, "edges": {"l.e": "wire"}})"},
+            fmt::format(R"({{"nodes": {{{}}}, "edges": {{}}}})", node("", "")),
+            std::string{R"({"nodes": {"l.a": {"type": "1280.test", "name": "", "pos": ["0in", "0in"]}}, "edges": {}})"},
+            //A trailing element after both wire ends, and a connection that is not an object following a node
+            //whose last connection key was read
+            fmt::format(R"({{"nodes": {{}}, "edges": {{{}}}}})", R"("l.e": {"conns": [{"connector": "1280.bare", "pos": ["0in", "0in"]}, {"connector": "1280.bare", "pos": ["0in", "0in"]}, ["junk"]]})"),
+            fmt::format(R"({{"nodes": {{{}, {}}}, "edges": {{}}}})", node("l.x", listed("e1")), R"("l.y": {"type": "1280.test", "name": "", "pos": ["0in", "0in"], "conns": [[1]]})"),
+            fmt::format(R"({{"nodes": {{{}}}, "edges": {{}}}})", R"("l.a": {"type": "1280.test", "name": "", "pos": ["0in", "0in"], "conns": {"a": {"port": "pwm0", "edge": "e1", "side": 0}}})"),
+        }) {
+            CAPTURE(text);
+            CHECK_NE(error(text), "");
+        }
+        CHECK_FALSE(graph.get_node("l.a").has_value());
+        CHECK_EQ(error(R"({"nodes": {}, "edges": {}, "version": 1})"), "");
+    }
+}
@@ -0,0 +1,241 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "lib.hpp"
+#include "ser/ser.hpp"
+#include "util/intern.hpp"
+
+/**
+ * \brief Loads a board graph in a single pass over its nodes and edges in any order, recording every reference
+ * between a node and an edge in a flat table instead of looking it up as it is read. Nodes and edges are added to
+ * the graph as soon as they are read with any attached wire ends left floating, and `finish` then attaches every
+ * wire end and checks every connection listed on a node against the edge it names in one linear pass.
+ *
+ * The loader is also a SAX handler for JSON text in the format written by `BoardGraph::to_json`, adding each node
+ * and edge as soon as its object closes without building a `json` tree of the whole board first. Only the fields
+ * of the node or edge currently being read and the reference tables are held in memory.
+ *
+ * Connections are recorded on both sides in the format, so every node must have a `conns` array, empty when none
+ * of its ports are connected. A connection that a node lists must be made by the edge it names. The edge is the
+ * record that attaches a port, so a wire end that its node does not list is still attached and only a warning is
+ * logged, which keeps boards saved with incomplete `conns` arrays loading.
+ *
+ * If loading fails the graph keeps every node and edge loaded before the failure
+ */
+class BoardLoader : public nlohmann::json_sax<json> {
+public:
+    /** \brief A connection listed on a node, naming the edge that attaches to one of its ports */
+    struct NodeConn {
+        std::string_view port;
+        std::string_view edge;
+        /** \brief Side of the edge that attaches to the port */
+        WireEdge::Side side;
+    };
+
+    /** \brief Most failures described in the error thrown by `finish`, the rest are only counted */
+    static constexpr const std::size_t MAX_REPORTED = 16;
+
+    /** \brief Create a loader that adds everything it reads to the given graph */
+    explicit BoardLoader(BoardGraph& graph) : m_graph{graph} {}
+
+    /**
+     * \brief Load every node and edge in the given JSON text into a graph
+     * \throws std::runtime_error if the text is not valid JSON, is not an object with `nodes` and `edges` objects
+     * holding an object for every node and edge, or any node or edge fails to load
+     */
+    static void load(BoardGraph& graph, std::string_view text);
+
+    /**
+     * \brief Add a node to the graph, recording the connections it lists to be checked by `finish`. A node with
+     * the same ID as one already loaded is skipped
+     * \throws std::runtime_error if the ID is empty or the node's component type does not exist
+     */
+    void node(BoardGraph::NodeDesc const& desc, std::span<const NodeConn> conns = {});
+    /**
+     * \brief Add an edge to the graph, recording the ends that attach to nodes to be attached by `finish`. An edge
+     * with the same ID as one already loaded is skipped
+     * \throws std::runtime_error if the ID is empty or either connector does not exist
+     */
+    void edge(BoardGraph::EdgeDesc const& desc);
+    /**
+     * \brief Attach the ends of every edge added since the last call to the nodes they name, then check that every
+     * connection listed on a node added since the last call is the end of the edge it names. Every reference is
+     * checked before anything is reported, so a single error describes all of the references that failed. Wire ends
+     * that their node does not list are logged as warnings
+     * \throws std::runtime_error if an attached node or port does not exist, a port is attached by more than one
+     * wire end, or a node lists a connection that its edge does not make
+     */
+    void finish();
+
+    bool null() override;
+    bool boolean(bool val) override;
+    bool number_integer(number_integer_t val) override;
+    bool number_unsigned(number_unsigned_t val) override;
+    bool number_float(number_float_t val, const string_t& str) override;
+    bool string(string_t& val) override;
+    bool binary(binary_t& val) override;
+    bool start_object(std::size_t len) override;
+    bool key(string_t& val) override;
+    bool end_object() override;
+    bool start_array(std::size_t len) override;
+    bool end_array() override;
+    bool parse_error(std::size_t pos, const std::string& token, const nlohmann::detail::exception& ex) override;
+private:
+    /** \brief A wire end of a loaded edge that attaches to a node, waiting for `finish` to attach it */
+    struct Fixup {
+        BoardGraph::EdgeHandle edge;
+        WireEdge::Side side;
+        Symbol node;
+        Symbol port;
+    };
+
+    /** \brief A connection listed on a loaded node, waiting for `finish` to check it against its edge */
+    struct Listed {
+        BoardGraph::NodeHandle node;
+        WireEdge::Side side;
+        Symbol port;
+        Symbol edge;
+    };
+
+    /** \brief A reference that `finish` could not resolve, described only once every reference has been checked */
+    struct Failure {
+        enum Kind : std::uint8_t {
+            /** \brief A wire end names a node that was never loaded */
+            NO_NODE,
+            /** \brief A wire end names a port that its node's component does not have */
+            NO_PORT,
+            /** \brief A wire end names a port that another wire end already attached to */
+            PORT_TAKEN,
+            /** \brief A node lists a connection that the edge it names does not make */
+            NOT_ATTACHED,
+        } kind;
+        /** \brief Index of the wire end in `m_fixups`, or of the listed connection in `m_listed` */
+        std::size_t index;
+    };
+
+    /** \brief Object in the root object that is being read */
+    enum class Section {
+        NONE,
+        NODES,
+        EDGES,
+    };
+
+    /** \brief Field of a node or edge that the next value read is stored in */
+    enum class Slot {
+        /** \brief A value that is not loaded */
+        NONE,
+        NODE_TYPE,
+        NODE_NAME,
+        /** \brief A coordinate of a node's position */
+        NODE_POS,
+        CONN_PORT,
+        CONN_EDGE,
+        CONN_SIDE,
+        END_CONNECTOR,
+        END_NODE,
+        END_PORT,
+        /** \brief A coordinate of a floating wire end's position */
+        END_POS,
+    };
+
+    /** \brief A wire end with its own copies of the strings it was read with */
+    struct End {
+        std::string connector{};
+        std::string node{};
+        std::string port{};
+        Point pos{};
+        /** \brief If the end had a position, which is required when it does not attach to a node */
+        bool has_pos{false};
+    };
+
+    /** \brief A connection listed on a node with its own copies of the strings it was read with */
+    struct Conn {
+        std::string port{};
+        std::string edge{};
+        WireEdge::Side side{WireEdge::LEFT};
+        /** \brief Which of the required fields `port`, `edge`, and `side` have been read */
+        std::array<bool, 3> has{};
+    };
+
+    /** \brief A node or edge with its own copies of the strings it was read with */
+    struct Item {
+        std::string id{};
+        std::string type{};
+        std::string name{};
+        Point pos{};
+        /** \brief Which of the required node fields `type`, `name`, `pos`, and `conns` have been read */
+        std::array<bool, 4> has{};
+        std::vector<Conn> conns{};
+        std::array<End, 2> ends{};
+        /** \brief Number of wire ends read so far */
+        std::size_t ends_len{0};
+    };
+
+    BoardGraph& m_graph;
+    /** \brief Wire ends that have not been attached yet, in the order they were read */
+    std::vector<Fixup> m_fixups{};
+    /** \brief Connections listed on nodes that have not been checked yet */
+    std::vector<Listed> m_listed{};
+
+    /** \brief If the `nodes` and `edges` objects of the root object have been read */
+    std::array<bool, 2> m_seen{};
+    /** \brief Number of objects and arrays that the parser is inside of */
+    std::size_t m_depth{0};
+    /** \brief For each object or array that the parser is inside of, outermost first, if it is an object */
+    std::vector<bool> m_objects{};
+    Section m_section{Section::NONE};
+    /** \brief Key of the value being read in the node or edge object, and in the connection or wire end object */
+    std::string m_field{};
+    std::string m_conn_field{};
+    /** \brief Coordinate of `pos` that the next string is read into */
+    std::size_t m_coord{0};
+    /** \brief Node or edge being read, reused so its strings keep their capacity */
+    Item m_item{};
+
+    /** \brief Check if the parser is inside the `conns` array of a node or edge */
+    inline bool in_conns(Section section) const noexcept { return this->m_section == section && this->m_field == "conns"; }
+
+    /** \brief Format a message describing every failure, up to `MAX_REPORTED` */
+    std::string describe(std::span<const Failure> failures) const;
+    /** \brief Get the field that a value read at the parser's current position is stored in */
+    Slot slot() const noexcept;
+    /** \throws std::runtime_error naming the node or edge being read */
+    [[noreturn]] void fail(std::string_view what) const;
+    /**
+     * \brief Check that a value starting at the parser's current position is allowed there, the root, the `nodes`
+     * and `edges` fields, every node and edge, and every element of their `conns` arrays must be objects
+     * \throws std::runtime_error if the value is not an object but must be, or `conns` is an object
+     */
+    void shape(bool object) const;
+    /** \brief Enter an object or array */
+    void open(bool object);
+    /** \brief Leave the object or array that the parser is inside of */
+    void close();
+    /**
+     * \brief Get the wire end of the edge being read that values are stored in
+     * \throws std::runtime_error if the edge already has two ends
+     */
+    End& end();
+    /**
+     * \brief Get the connection of the node being read that values are stored in
+     * \throws std::runtime_error if no connection object has been started
+     */
+    Conn& conn();
+    /** \brief Handle a number, boolean, or null, which only the side of a node's connection can hold */
+    bool scalar();
+    /** \brief Add the node that was just read to the graph */
+    void finish_node();
+    /** \brief Add the edge that was just read to the graph */
+    void finish_edge();
+    /** \brief Check that a connection listed on a node that was just read has every field */
+    void finish_conn();
+    /** \brief Check that a wire end that was just read attaches to a node or has a position */
+    void finish_end();
+};
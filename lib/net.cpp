@@ -0,0 +1,371 @@
+#include "net.hpp"
+#include "testing.hpp"
+#include "util/disjoint.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#include <doctest.h>
+
+NetIndex::NetIndex(BoardGraph const& graph) {
+    const auto& nodes = std::as_const(graph.m_storage->nodes);
+    const auto& edges = std::as_const(graph.m_storage->edges);
+
+    for(auto it = nodes.begin(); it != nodes.end(); ++it) {
+        this->add_ports(it.index(), *it->type());
+    }
+
+    DisjointSet sets{static_cast<size_type>(this->m_ports.size())};
+    for(const NodePorts& range : this->m_nodes) {
+        if(range.base == npos) {
+            continue;
+        }
+        for(const auto& bus : range.type->buses()) {
+            for(ConnectionPortIdx port : bus) {
+                sets.unite(range.base + bus.front(), range.base + port);
+            }
+        }
+    }
+
+    for(const WireEdge& edge : edges) {
+        const auto& [left, right] = edge.connections();
+        if(left.is_floating() || right.is_floating()) {
+            continue;
+        }
+        const size_type a = this->dense(PortRef{.node = left.m_node.index, .port = left.m_port});
+        const size_type b = this->dense(PortRef{.node = right.m_node.index, .port = right.m_port});
+        //Ends attached to nodes that this index does not know of cannot join any of our nets
+        if(a == npos || b == npos) {
+            continue;
+        }
+        this->m_link[a] = b;
+        this->m_link[b] = a;
+        sets.unite(a, b);
+    }
+
+    std::vector<NetId> root_net(this->m_ports.size(), npos);
+    for(const NodePorts& range : this->m_nodes) {
+        if(range.base == npos) {
+            continue;
+        }
+        for(auto port = range.type->begin(); port != range.type->end(); ++port) {
+            const size_type root = sets.find(range.base + port.index());
+            if(root_net[root] == npos) {
+                root_net[root] = this->m_nets.emplace();
+                this->m_count += 1;
+            }
+            this->join(root_net[root], range.base + port.index());
+        }
+    }
+}
+
+Optional<NetIndex::NetId> NetIndex::net(PortRef port) const noexcept {
+    const size_type idx = this->dense(port);
+    if(idx == npos || this->m_port_net[idx] == npos) {
+        return {};
+    }
+    return this->m_port_net[idx];
+}
+
+void NetIndex::node_added(ComponentNode const& node) {
+    const size_type base = this->add_ports(node.handle(), *node.type());
+    for(auto port = node.type()->begin(); port != node.type()->end(); ++port) {
+        this->join(this->m_nets.emplace(), base + port.index());
+        this->m_count += 1;
+    }
+    for(const auto& bus : node.type()->buses()) {
+        for(ConnectionPortIdx port : bus) {
+            this->merge(base + bus.front(), base + port);
+        }
+    }
+}
+
+void NetIndex::connected(ComponentNode const& node, ConnectionPortIdx port, WireEdge const& edge, WireEdge::Side side) {
+    const auto& other = edge.connections()[side == WireEdge::LEFT ? WireEdge::RIGHT : WireEdge::LEFT];
+    if(other.is_floating()) {
+        return;
+    }
+    const size_type a = this->dense(PortRef{.node = node.handle(), .port = port});
+    const size_type b = this->dense(PortRef{.node = other.m_node.index, .port = other.m_port});
+    if(a == npos || b == npos) {
+        return;
+    }
+    this->m_link[a] = b;
+    this->m_link[b] = a;
+    this->merge(a, b);
+}
+
+void NetIndex::node_removed(ComponentNode const& node) {
+    if(node.handle() >= this->m_nodes.size() || this->m_nodes[node.handle()].base == npos) {
+        return;
+    }
+    //Every wire has been detached already, so each net of the node's ports only holds ports of this node
+    const NodePorts range = this->m_nodes[node.handle()];
+    for(size_type port = range.base; port < range.base + range.len; ++port) {
+        const NetId net = this->m_port_net[port];
+        if(net == npos) {
+            continue;
+        }
+        this->leave(port);
+        if(this->m_nets.at(net).empty()) {
+            this->m_nets.erase(net);
+            this->m_count -= 1;
+        }
+    }
+    //The range is reused by the next node added with the same number of port slots
+    for(size_type port = range.base; port < range.base + range.len; ++port) {
+        this->m_slot[port] = npos;
+        this->m_link[port] = npos;
+    }
+    if(range.len != 0) {
+        if(this->m_free_ranges.size() <= range.len) {
+            this->m_free_ranges.resize(range.len + 1);
+        }
+        this->m_free_ranges[range.len].push_back(range.base);
+    }
+    this->m_nodes[node.handle()] = NodePorts{};
+}
+
+void NetIndex::detached(ComponentNode const& node, ConnectionPortIdx port, WireEdge const& edge, WireEdge::Side side) {
+    (void)edge;
+    (void)side;
+    const size_type a = this->dense(PortRef{.node = node.handle(), .port = port});
+    if(a == npos || this->m_link[a] == npos) {
+        return;
+    }
+    const size_type b = this->m_link[a];
+    this->m_link[a] = npos;
+    this->m_link[b] = npos;
+    this->split(a, b);
+}
+
+NetIndex::size_type NetIndex::dense(PortRef port) const noexcept {
+    if(port.node >= this->m_nodes.size()) {
+        return npos;
+    }
+    const NodePorts& range = this->m_nodes[port.node];
+    if(range.base == npos || port.port >= range.len) {
+        return npos;
+    }
+    return range.base + port.port;
+}
+
+NetIndex::size_type NetIndex::add_ports(BoardGraph::NodeHandle handle, Component const& type) {
+    if(this->m_nodes.size() <= handle) {
+        this->m_nodes.resize(handle + 1);
+    }
+
+    const size_type len = type.port_slots();
+    if(len < this->m_free_ranges.size() && !this->m_free_ranges[len].empty()) {
+        const size_type base = this->m_free_ranges[len].back();
+        this->m_free_ranges[len].pop_back();
+        this->m_nodes[handle] = NodePorts{.base = base, .len = len, .type = &type};
+        for(ConnectionPortIdx port = 0; port < len; ++port) {
+            this->m_ports[base + port] = PortRef{.node = handle, .port = port};
+        }
+        return base;
+    }
+
+    if(this->m_ports.size() + len >= npos) {
+        throw std::length_error{"Board graph has too many ports to index nets"};
+    }
+    const size_type base = static_cast<size_type>(this->m_ports.size());
+    this->m_nodes[handle] = NodePorts{.base = base, .len = type.port_slots(), .type = &type};
+    for(ConnectionPortIdx port = 0; port < type.port_slots(); ++port) {
+        this->m_ports.push_back(PortRef{.node = handle, .port = port});
+    }
+    this->m_port_net.resize(this->m_ports.size(), npos);
+    this->m_slot.resize(this->m_ports.size(), npos);
+    this->m_link.resize(this->m_ports.size(), npos);
+    this->m_mark.resize(this->m_ports.size(), 0);
+    return base;
+}
+
+void NetIndex::join(NetId net, size_type port) {
+    auto& members = this->m_nets.at(net);
+    this->m_port_net[port] = net;
+    this->m_slot[port] = static_cast<size_type>(members.size());
+    members.push_back(this->m_ports[port]);
+}
+
+void NetIndex::leave(size_type port) {
+    auto& members = this->m_nets.at(this->m_port_net[port]);
+    const size_type slot = this->m_slot[port];
+    members[slot] = members.back();
+    this->m_slot[this->dense(members[slot])] = slot;
+    members.pop_back();
+    this->m_port_net[port] = npos;
+}
+
+void NetIndex::merge(size_type a, size_type b) {
+    NetId into = this->m_port_net[a];
+    NetId from = this->m_port_net[b];
+    if(into == from) {
+        return;
+    }
+    if(this->m_nets.at(into).size() < this->m_nets.at(from).size()) {
+        std::swap(into, from);
+    }
+
+    for(const PortRef& member : this->m_nets.at(from)) {
+        const size_type port = this->dense(member);
+        this->m_port_net[port] = into;
+        this->m_slot[port] = static_cast<size_type>(this->m_nets.at(into).size());
+        this->m_nets.at(into).push_back(member);
+    }
+    this->m_nets.erase(from);
+    this->m_count -= 1;
+}
+
+template<typename F>
+void NetIndex::neighbours(size_type port, F&& fn) const {
+    if(this->m_link[port] != npos) {
+        fn(this->m_link[port]);
+    }
+    const PortRef ref = this->m_ports[port];
+    const NodePorts& range = this->m_nodes[ref.node];
+    auto bus = range.type->bus(ref.port);
+    if(bus.has_value()) {
+        for(ConnectionPortIdx sibling : bus.unwrap_unchecked().get()) {
+            if(sibling != ref.port) {
+                fn(range.base + sibling);
+            }
+        }
+    }
+}
+
+void NetIndex::split(size_type a, size_type b) {
+    if(this->m_epoch >= npos - 2) {
+        std::fill(this->m_mark.begin(), this->m_mark.end(), 0);
+        this->m_epoch = FIRST_EPOCH;
+    }
+    const size_type mark_a = this->m_epoch;
+    const size_type mark_b = this->m_epoch + 1;
+    this->m_epoch += 2;
+
+    //Search from both ends in lockstep, the first search to run dry has found the whole of the smaller net
+    std::vector<size_type> found_a{a};
+    std::vector<size_type> found_b{b};
+    this->m_mark[a] = mark_a;
+    this->m_mark[b] = mark_b;
+    std::size_t next_a = 0;
+    std::size_t next_b = 0;
+    bool met = false;
+    auto step = [this, &met](std::vector<size_type>& found, std::size_t& next, size_type mark, size_type other) {
+        const size_type port = found[next++];
+        this->neighbours(port, [&](size_type neighbour) {
+            if(this->m_mark[neighbour] == other) {
+                met = true;
+            } else if(this->m_mark[neighbour] != mark) {
+                this->m_mark[neighbour] = mark;
+                found.push_back(neighbour);
+            }
+        });
+    };
+
+    while(!met && next_a < found_a.size() && next_b < found_b.size()) {
+        step(found_a, next_a, mark_a, mark_b);
+        if(!met) {
+            step(found_b, next_b, mark_b, mark_a);
+        }
+    }
+    if(met) {
+        return;
+    }
+
+    const std::vector<size_type>& moved = next_a == found_a.size() ? found_a : found_b;
+    const NetId net = this->m_nets.emplace();
+    this->m_count += 1;
+    for(size_type port : moved) {
+        this->leave(port);
+        this->join(net, port);
+    }
+}
+
+TEST_CASE("NetIndex") {
+    const testing::AssetDir assets{};
+    BoardGraph graph = testing::asset_board();
+    const Ref<Component> bus = graph.resources().try_get<Component>("1280.bus");
+    const Ref<Connector> bare = graph.resources().try_get<Connector>("1280.bare");
+    const auto port = [&bus](std::string_view id) { return bus->get_port_idx(id).unwrap(); };
+
+    const Ref<NetIndex> tracked = graph.track<NetIndex>();
+    std::vector<Ref<ComponentNode>> nodes{};
+    for(int i = 0; i < 4; ++i) {
+        nodes.push_back(graph.component(bus, fmt::format("net.b{}", i)));
+    }
+    const auto wire = [&](std::string const& id, std::size_t a, std::string_view a_port, std::size_t b, std::string_view b_port) {
+        Ref<WireEdge> edge = graph.edge(id, {bare, bare});
+        nodes[a]->connnect_port(port(a_port), edge, WireEdge::LEFT);
+        nodes[b]->connnect_port(port(b_port), edge, WireEdge::RIGHT);
+        return edge;
+    };
+
+    //The tracked index must partition every port the same way as an index built from scratch
+    const auto agrees = [&graph, &tracked]() {
+        const NetIndex fresh{graph};
+        std::vector<NetIndex::PortRef> ports{};
+        for(const ComponentNode& node : graph.nodes()) {
+            for(auto it = node.type()->begin(); it != node.type()->end(); ++it) {
+                ports.push_back(NetIndex::PortRef{.node = node.handle(), .port = static_cast<ConnectionPortIdx>(it.index())});
+            }
+        }
+        if(tracked->size() != fresh.size()) {
+            return false;
+        }
+        for(const NetIndex::PortRef& a : ports) {
+            for(const NetIndex::PortRef& b : ports) {
+                if(tracked->same_net(a, b) != fresh.same_net(a, b)) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    };
+    const auto ref = [&](std::size_t node, std::string_view id) {
+        return NetIndex::PortRef{.node = nodes[node]->handle(), .port = port(id)};
+    };
+
+    CHECK(tracked->same_net(ref(0, "in"), ref(0, "out1")));
+    CHECK_FALSE(tracked->same_net(ref(0, "in"), ref(0, "aux")));
+    CHECK(agrees());
+
+    //A ring through all four buses, so that cutting one wire does not split it
+    wire("net.w0", 0, "out0", 1, "in");
+    const Ref<WireEdge> w1 = wire("net.w1", 1, "out0", 2, "in");
+    wire("net.w2", 2, "out0", 3, "in");
+    const Ref<WireEdge> w3 = wire("net.w3", 3, "out1", 0, "out1");
+    wire("net.w4", 1, "aux", 3, "aux");
+    CHECK(tracked->same_net(ref(0, "in"), ref(2, "out1")));
+    CHECK(agrees());
+
+    w1->side(WireEdge::LEFT).detach();
+    CHECK(tracked->same_net(ref(1, "in"), ref(2, "in")));
+    CHECK(agrees());
+
+    w3->side(WireEdge::RIGHT).detach();
+    CHECK_FALSE(tracked->same_net(ref(1, "in"), ref(2, "in")));
+    CHECK(tracked->same_net(ref(2, "in"), ref(3, "out1")));
+    CHECK(tracked->same_net(ref(1, "aux"), ref(3, "aux")));
+    CHECK(agrees());
+
+    nodes[1]->connnect_port(port("out0"), w1, WireEdge::LEFT);
+    CHECK(tracked->same_net(ref(0, "in"), ref(3, "in")));
+    CHECK(agrees());
+
+    graph.remove_node(nodes[3]->handle());
+    nodes.pop_back();
+    CHECK(agrees());
+
+    //Removing and adding nodes of the same type reuses their dense port ranges
+    const NetIndex::size_type slots = tracked->port_slots();
+    for(int i = 0; i < 16; ++i) {
+        const Ref<ComponentNode> added = graph.component(bus, fmt::format("net.cycle{}", i));
+        graph.remove_node(added->handle());
+    }
+    const Ref<ComponentNode> added = graph.component(bus, "net.added");
+    CHECK_EQ(tracked->port_slots(), slots);
+    CHECK_FALSE(tracked->same_net(NetIndex::PortRef{.node = added->handle(), .port = port("in")}, ref(0, "in")));
+    CHECK(agrees());
+}
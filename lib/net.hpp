@@ -0,0 +1,131 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+#include "lib.hpp"
+#include "util/freelist.hpp"
+#include "util/optional.hpp"
+
+/**
+ * \brief Index of the electrical nets in a `BoardGraph`, where a net is the set of ports that are joined through
+ * wires or through a bus inside a component. Every port of every node belongs to exactly one net, ports that
+ * nothing connects to form a net of their own.
+ *
+ * When created with `BoardGraph::track`, the index is kept up to date as wires are attached and detached:
+ * merging two nets relabels only the smaller one, and a detach that may split a net searches outward from both
+ * former wire ends at once, stopping as soon as either search meets the other or runs out of ports, so the
+ * work done is bounded by the smaller of the two resulting nets
+ */
+class NetIndex : public GraphObserver {
+public:
+    using size_type = std::uint32_t;
+    /** \brief Identifier of a net, stable until the net is merged into another or split */
+    using NetId = size_type;
+
+    /** \brief A single port on a specific node in the graph */
+    struct PortRef {
+        /** \brief Handle of the node in the graph's node storage */
+        BoardGraph::NodeHandle node;
+        /** \brief Index of the port on the node's component type */
+        ConnectionPortIdx port;
+
+        constexpr inline bool operator==(PortRef const& other) const noexcept = default;
+    };
+
+    /** \brief Create an index containing no nets */
+    NetIndex() = default;
+
+    /**
+     * \brief Compute all nets of the given graph, this is a single union-find pass over every port and wire,
+     * so it runs in time near-linear in the size of the graph
+     */
+    explicit NetIndex(BoardGraph const& graph);
+
+    /**
+     * \brief Get the net that the given port belongs to
+     * \return An empty `Optional` if this index does not know of the node or port
+     */
+    Optional<NetId> net(PortRef port) const noexcept;
+
+    /** \brief Check if two ports are electrically joined */
+    inline bool same_net(PortRef a, PortRef b) const noexcept {
+        auto net = this->net(a);
+        return net.has_value() && net == this->net(b);
+    }
+
+    /** \brief Get every port that belongs to the given net, in no particular order */
+    inline std::span<const PortRef> members(NetId net) const noexcept { return this->m_nets.at(net); }
+
+    /** \brief Get the number of nets in this index */
+    inline size_type size() const noexcept { return this->m_count; }
+    /** \brief Get the number of dense port indices allocated, including the ranges of removed nodes kept for reuse */
+    inline size_type port_slots() const noexcept { return static_cast<size_type>(this->m_ports.size()); }
+
+    /** \brief Iterator over the member lists of all nets, `index()` of the iterator is the `NetId` */
+    using iterator = FreeList<std::vector<PortRef>>::const_iterator;
+    inline iterator begin() const noexcept { return this->m_nets.begin(); }
+    inline iterator end() const noexcept { return this->m_nets.end(); }
+
+    void node_added(ComponentNode const& node) override;
+    void connected(ComponentNode const& node, ConnectionPortIdx port, WireEdge const& edge, WireEdge::Side side) override;
+    void node_removed(ComponentNode const& node) override;
+    void detached(ComponentNode const& node, ConnectionPortIdx port, WireEdge const& edge, WireEdge::Side side) override;
+private:
+    /** \brief Marks an absent node range, port, or net */
+    static constexpr const size_type npos = std::numeric_limits<size_type>::max();
+
+    /** \brief Range of dense port indices assigned to the ports of a single node */
+    struct NodePorts {
+        size_type base{npos};
+        size_type len{0};
+        /** \brief Component type of the node, used to find the ports sharing a bus */
+        Component const *type{nullptr};
+    };
+
+    /** \brief Dense port ranges of every node, indexed by node handle */
+    std::vector<NodePorts> m_nodes{};
+    /** \brief The port referred to by each dense port index */
+    std::vector<PortRef> m_ports{};
+    /** \brief Net of every port, indexed by dense port index */
+    std::vector<NetId> m_port_net{};
+    /** \brief Position of every port in its net's member list */
+    std::vector<size_type> m_slot{};
+    /** \brief Dense index of the port at the other end of the wire attached to each port */
+    std::vector<size_type> m_link{};
+    /** \brief Bases of the dense port ranges of removed nodes, bucketed by the number of ports in the range */
+    std::vector<std::vector<size_type>> m_free_ranges{};
+    /** \brief Member lists of all nets */
+    FreeList<std::vector<PortRef>> m_nets{};
+    /** \brief Number of live nets */
+    size_type m_count{0};
+
+    /** \brief Search marks for split detection, stamped with the current epoch so they never need clearing */
+    std::vector<size_type> m_mark{};
+    /** \brief Mark value for ports reached from the first wire end, the second end uses `m_epoch + 1` */
+    size_type m_epoch{FIRST_EPOCH};
+    /** \brief Smallest epoch value, every mark below it is stale */
+    static constexpr const size_type FIRST_EPOCH = 2;
+
+    /** \brief Get the dense index of the given port, or `npos` */
+    size_type dense(PortRef port) const noexcept;
+    /**
+     * \brief Allocate a range of dense port indices for a node without placing the ports in any net, reusing the
+     * range of a removed node with the same number of ports if there is one
+     * \return The first dense index of the node's range
+     */
+    size_type add_ports(BoardGraph::NodeHandle handle, Component const& type);
+    /** \brief Append a dense port to the given net */
+    void join(NetId net, size_type port);
+    /** \brief Remove a dense port from its net */
+    void leave(size_type port);
+    /** \brief Merge the nets of two dense ports, moving the smaller net into the larger */
+    void merge(size_type a, size_type b);
+    /** \brief Split the net of two dense ports that were just unlinked if they are no longer joined */
+    void split(size_type a, size_type b);
+    /** \brief Invoke `fn` with every dense port directly joined to the given dense port */
+    template<typename F>
+    void neighbours(size_type port, F&& fn) const;
+};
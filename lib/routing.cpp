@@ -0,0 +1,206 @@
+#include "routing.hpp"
+
+#include <cmath>
+#include <numeric>
+#include <utility>
+
+#include <doctest.h>
+
+#include "testing.hpp"
+
+WireLengths::WireLengths(BoardGraph const& graph) : m_graph{graph.m_storage.shared()} {
+    const auto& edges = std::as_const(graph.m_storage->edges);
+    for(auto it = edges.begin(); it != edges.end(); ++it) {
+        this->invalidate(it.index());
+    }
+    this->update();
+}
+
+Optional<Length> WireLengths::length(BoardGraph::EdgeHandle edge) {
+    this->update();
+    if(edge >= this->m_state.size() || this->m_state[edge] != State::MEASURED) {
+        return {};
+    }
+    return Length{this->m_lengths[edge]};
+}
+
+Length WireLengths::total() {
+    this->update();
+    Length::Raw sum = 0;
+    for(std::size_t i = 0; i < this->m_lengths.size(); ++i) {
+        if(this->m_state[i] == State::MEASURED) {
+            sum += this->m_lengths[i];
+        }
+    }
+    return Length{sum};
+}
+
+void WireLengths::update() {
+    if(this->m_dirty.empty()) {
+        return;
+    }
+    std::vector<BoardGraph::EdgeHandle> dirty = std::move(this->m_dirty);
+    this->m_dirty.clear();
+    if(Ref<GraphStorage> storage = this->m_graph.lock(); storage != nullptr) {
+        this->measure(*storage, dirty);
+    } else {
+        //The graph is gone, so nothing that was waiting to be measured can be anymore
+        for(BoardGraph::EdgeHandle edge : dirty) {
+            this->m_state[edge] = State::ABSENT;
+        }
+    }
+}
+
+void WireLengths::measure(GraphStorage const& storage, std::span<const BoardGraph::EdgeHandle> edges) {
+    //Every wire's points, including both ends, are laid out one after another so that all segments of all wires
+    //are measured by the same loop. `ends[i]` is one past the index of the last point of the `i`th wire
+    std::vector<Length::Raw> xs{};
+    std::vector<Length::Raw> ys{};
+    std::vector<std::size_t> ends{};
+    ends.reserve(edges.size());
+    std::size_t points = 0;
+    for(BoardGraph::EdgeHandle handle : edges) {
+        points += storage.edges.at(handle).points().size() + 2;
+    }
+    xs.reserve(points);
+    ys.reserve(points);
+    auto add = [&xs, &ys](RawPoint const& pt) {
+        xs.push_back(coord::to_normalized(pt.x));
+        ys.push_back(coord::to_normalized(pt.y));
+    };
+    for(BoardGraph::EdgeHandle handle : edges) {
+        const WireEdge& edge = storage.edges.at(handle);
+        add(edge.connections()[WireEdge::LEFT].pos().raw());
+        for(const RawPoint& pt : edge) {
+            add(pt);
+        }
+        add(edge.connections()[WireEdge::RIGHT].pos().raw());
+        ends.push_back(xs.size());
+    }
+
+    //Segments joining the last point of one wire to the first point of the next are measured too but never summed
+    const std::size_t segments = xs.empty() ? 0 : xs.size() - 1;
+    std::vector<Length::Raw> lengths(segments);
+    for(std::size_t i = 0; i < segments; ++i) {
+        const Length::Raw dx = xs[i + 1] - xs[i];
+        const Length::Raw dy = ys[i + 1] - ys[i];
+        lengths[i] = std::sqrt(dx * dx + dy * dy);
+    }
+
+    for(std::size_t i = 0, begin = 0; i < edges.size(); begin = ends[i], ++i) {
+        this->m_lengths[edges[i]] = std::accumulate(
+            lengths.begin() + static_cast<std::ptrdiff_t>(begin),
+            lengths.begin() + static_cast<std::ptrdiff_t>(ends[i] - 1),
+            Length::Raw{0}
+        );
+        this->m_state[edges[i]] = State::MEASURED;
+    }
+}
+
+void WireLengths::invalidate(BoardGraph::EdgeHandle edge) {
+    if(edge >= this->m_state.size()) {
+        this->m_state.resize(edge + 1, State::ABSENT);
+        this->m_lengths.resize(edge + 1, 0);
+    }
+    if(this->m_state[edge] != State::STALE) {
+        this->m_state[edge] = State::STALE;
+        this->m_dirty.push_back(edge);
+    }
+}
+
+void WireLengths::edge_added(WireEdge const& edge) {
+    this->invalidate(edge.handle().index);
+}
+
+void WireLengths::edge_removed(WireEdge const& edge) {
+    const BoardGraph::EdgeHandle handle = edge.handle().index;
+    if(handle >= this->m_state.size()) {
+        return;
+    }
+    if(this->m_state[handle] == State::STALE) {
+        std::erase(this->m_dirty, handle);
+    }
+    this->m_state[handle] = State::ABSENT;
+}
+
+void WireLengths::connected(ComponentNode const& node, ConnectionPortIdx port, WireEdge const& edge, WireEdge::Side side) {
+    (void)node;
+    (void)port;
+    (void)side;
+    this->invalidate(edge.handle().index);
+}
+
+void WireLengths::detached(ComponentNode const& node, ConnectionPortIdx port, WireEdge const& edge, WireEdge::Side side) {
+    (void)node;
+    (void)port;
+    (void)side;
+    this->invalidate(edge.handle().index);
+}
+
+void WireLengths::moved(ComponentNode const& node, Point from) {
+    (void)from;
+    for(const auto& [port, conn] : node.m_edges) {
+        this->invalidate(conn.edge.index);
+    }
+}
+
+void WireLengths::rerouted(WireEdge const& edge, std::span<const RawPoint> from) {
+    (void)from;
+    this->invalidate(edge.handle().index);
+}
+
+TEST_CASE("WireLengths") {
+    const testing::AssetDir assets{};
+    BoardGraph graph = testing::asset_board();
+    const Ref<Component> bus = graph.resources().try_get<Component>("1280.bus");
+    const Ref<Connector> bare = graph.resources().try_get<Connector>("1280.bare");
+    const Ref<WireLengths> tracked = graph.track<WireLengths>();
+    const auto near = [](Length a, Length b) { return std::abs(a.normalized() - b.normalized()) < 1e-4f; };
+    //The cached length of a wire matches a cache measured from scratch
+    const auto agrees = [&graph, &tracked, &near](Ref<WireEdge> const& edge) {
+        WireLengths fresh{graph};
+        return near(tracked->length(edge->handle().index).unwrap(), fresh.length(edge->handle().index).unwrap()) &&
+            near(tracked->total(), fresh.total());
+    };
+
+    Ref<WireEdge> edge = graph.edge(
+        "routing.e",
+        {bare, bare},
+        {Point{Length{0.f}, Length{0.f}}, Point{Length{0.3f}, Length{0.4f}}}
+    );
+    const BoardGraph::EdgeHandle handle = edge->handle().index;
+    CHECK_EQ(tracked->stale(), 1);
+    CHECK(near(tracked->length(handle).unwrap(), Length{0.5f}));
+    CHECK_EQ(tracked->stale(), 0);
+
+    graph.reroute(handle, {Point{Length{0.3f}, Length{0.f}}.raw()});
+    CHECK_EQ(tracked->stale(), 1);
+    CHECK(near(tracked->length(handle).unwrap(), Length{0.7f}));
+
+    const Ref<ComponentNode> node = graph.component(bus, "routing.a", Point{Length{-0.5f}, Length{0.f}});
+    node->connnect_port(bus->get_port_idx("aux").unwrap(), edge, WireEdge::LEFT);
+    CHECK_EQ(tracked->stale(), 1);
+    CHECK(agrees(edge));
+
+    node->move_to(Point{Length{-0.5f}, Length{-0.5f}});
+    CHECK_EQ(tracked->stale(), 1);
+    CHECK(agrees(edge));
+
+    //Every wire on the board is summed, including the wires of the asset board
+    Length sum{};
+    for(const WireEdge& wire : graph.edges()) {
+        sum = sum + tracked->length(wire.handle().index).unwrap();
+    }
+    CHECK(near(tracked->total(), sum));
+
+    graph.remove_node(node->handle());
+    CHECK_EQ(tracked->stale(), 1);
+    CHECK(agrees(edge));
+
+    const Length before = tracked->total();
+    const Length removed = tracked->length(handle).unwrap();
+    graph.remove_edge(handle);
+    CHECK_EQ(tracked->stale(), 0);
+    CHECK_FALSE(tracked->length(handle).has_value());
+    CHECK(near(tracked->total(), before - removed));
+}
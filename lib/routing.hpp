@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "lib.hpp"
+#include "util/optional.hpp"
+
+/**
+ * \brief Cache of the routed length of every wire in a `BoardGraph`, measured from the wire's left end through each
+ * of its points in order to its right end.
+ *
+ * Lengths are computed in batches: the coordinates of every wire that needs measuring are gathered into contiguous
+ * arrays and all of their segments are measured in one pass, so building the cache for a whole board is a single
+ * pass over the board's wire geometry. When created with `BoardGraph::track`, only the wires that are added,
+ * rerouted, attached, detached, or attached to a moved node are marked stale, and stale wires are measured
+ * together the next time a length is read
+ */
+class WireLengths : public GraphObserver {
+public:
+    /** \brief Create a cache containing no wires */
+    WireLengths() = default;
+
+    /** \brief Measure every wire in the given graph in one batch */
+    explicit WireLengths(BoardGraph const& graph);
+
+    /**
+     * \brief Get the routed length of a wire, measuring every stale wire first
+     * \return An empty `Optional` if this cache does not know of the edge
+     */
+    Optional<Length> length(BoardGraph::EdgeHandle edge);
+
+    /** \brief Get the summed routed length of every wire, measuring every stale wire first */
+    Length total();
+
+    /** \brief Measure every wire marked stale since the last update in one batch */
+    void update();
+
+    /** \brief Get the number of wires waiting to be measured */
+    inline std::size_t stale() const noexcept { return this->m_dirty.size(); }
+
+    void edge_added(WireEdge const& edge) override;
+    void edge_removed(WireEdge const& edge) override;
+    void connected(ComponentNode const& node, ConnectionPortIdx port, WireEdge const& edge, WireEdge::Side side) override;
+    void detached(ComponentNode const& node, ConnectionPortIdx port, WireEdge const& edge, WireEdge::Side side) override;
+    void moved(ComponentNode const& node, Point from) override;
+    void rerouted(WireEdge const& edge, std::span<const RawPoint> from) override;
+private:
+    /** \brief State of a single edge handle in the cache */
+    enum class State: std::uint8_t {
+        /** \brief No edge with this handle is known */
+        ABSENT,
+        /** \brief The cached length is up to date */
+        MEASURED,
+        /** \brief The edge is waiting in `m_dirty` to be measured */
+        STALE,
+    };
+
+    /** \brief Storage of the graph that stale wires are read from when they are measured */
+    WeakRef<GraphStorage> m_graph{};
+    /** \brief Cached routed length of every edge in normalized units, indexed by edge handle */
+    std::vector<Length::Raw> m_lengths{};
+    /** \brief State of every edge, indexed by edge handle */
+    std::vector<State> m_state{};
+    /** \brief Handles of every stale edge, in the order they were marked */
+    std::vector<BoardGraph::EdgeHandle> m_dirty{};
+
+    /** \brief Mark an edge as needing to be measured, adding it to the cache if it is new */
+    void invalidate(BoardGraph::EdgeHandle edge);
+    /** \brief Measure the given edges of a graph's storage in one batch */
+    void measure(GraphStorage const& storage, std::span<const BoardGraph::EdgeHandle> edges);
+};
@@ -76,23 +76,39 @@ Id::Id(const std::string_view str) : m_string{str} {
 }
 
 
-Ref<void> LazyResourceStore::try_get_id(TypeId type_id, const char *type_name, const std::string_view id_str) {
+LazyResourceStore::Slot& LazyResourceStore::slot(TypeId type_id, const char *type_name) {
     auto elem = this->m_res.find(type_id.val());
     if(elem == this->m_res.end()) {
         throw UnregisteredResourceException(
             fmt::format("Type {} has no registered LazyResourceLoader implementation", type_name)
         );
     }
-    
-    auto cached = elem->second.cache.find(id_str);
-    if(cached != elem->second.cache.end() && !cached->second.expired()) {
+    return elem->second;
+}
+
+Ref<void> LazyResourceStore::try_get_id(TypeId type_id, const char *type_name, Symbol sym) {
+    Slot& slot = this->slot(type_id, type_name);
+    auto cached = slot.cache.find(sym);
+    if(cached != slot.cache.end() && !cached->second.expired()) {
         return cached->second.lock();
     }
-    
+    return this->load(slot, type_name, sym.str(), sym);
+}
+
+Ref<void> LazyResourceStore::try_get_str(TypeId type_id, const char *type_name, std::string_view id) {
+    const Optional<Symbol> sym = Symbol::find(id);
+    if(sym.has_value()) {
+        return this->try_get_id(type_id, type_name, sym.unwrap_unchecked());
+    }
+    //A string that was never interned cannot be cached
+    return this->load(this->slot(type_id, type_name), type_name, id, {});
+}
+
+Ref<void> LazyResourceStore::load(Slot& slot, const char *type_name, std::string_view id, Optional<Symbol> sym) {
     try {
-        Id id{id_str};
-        id.to_path();
-        std::filesystem::path resource_path = elem->second.loader->dir() / id.str();
+        Id path{id};
+        path.to_path();
+        std::filesystem::path resource_path = slot.loader->dir() / path.str();
         resource_path += ".json";
 
         logger::trace("Resource not found by ID, loading from {}", resource_path.c_str());
@@ -102,12 +118,14 @@ Ref<void> LazyResourceStore::try_get_id(TypeId type_id, const char *type_name, c
         json j;
         file >> j;
         
-        auto [loaded, ins] = elem->second.cache.insert_or_assign(std::string{id_str}, WeakRef<void>{});
-        Ref<void> load = elem->second.loader->load_untyped(loaded->first, j, *this);
-        elem->second.cache.insert_or_assign(std::string{id_str}, WeakRef<void>{load});
+        if(!sym.has_value()) {
+            sym = Symbol::intern(id);
+        }
+        Ref<void> load = slot.loader->load_untyped(sym.unwrap_unchecked(), j, *this);
+        slot.cache.insert_or_assign(sym.unwrap_unchecked(), WeakRef<void>{load});
         return load;
     } catch(const std::exception& e) {
-        logger::error("Failed to deserialize element of type '{}' with id '{}': {}", type_name, id_str.data(), e.what());
-        throw std::runtime_error(fmt::format("While loading '{}' with id '{}': {}", type_name, id_str.data(), e.what()));
+        logger::error("Failed to deserialize element of type '{}' with id '{}': {}", type_name, id, e.what());
+        throw std::runtime_error(fmt::format("While loading '{}' with id '{}': {}", type_name, id, e.what()));
     }
 }
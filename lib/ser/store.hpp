@@ -7,6 +7,7 @@
 #include <concepts>
 #include <vector>
 
+#include "util/intern.hpp"
 #include "util/optional.hpp"
 #include "ser.hpp"
 
@@ -137,7 +138,7 @@ private:
      * \param store A lazy loading resource store that we can use to load values of other types
      */
     virtual Ref<void> load_untyped(
-        std::string_view id,
+        Symbol id,
         const json& json,
         LazyResourceStore& store
     ) = 0;
@@ -169,7 +170,7 @@ public:
      * \return A reference to the loaded value
      * \throws Any exception that may occur when deserializing
      */
-    virtual Ref<T> load(std::string_view id, const json& json, LazyResourceStore& store) = 0;
+    virtual Ref<T> load(Symbol id, const json& json, LazyResourceStore& store) = 0;
     
     virtual ~LazyResourceLoader() = default;
     LazyResourceLoader() = default;
@@ -178,7 +179,7 @@ public:
     virtual std::filesystem::path const& dir() const noexcept override = 0;
 private:
     /** Override to safely implement the unsafe type-erasure functionality of `ErasedLazyResourceLoader` */
-    Ref<void> load_untyped(std::string_view id, const json& json, LazyResourceStore& store) override {
+    Ref<void> load_untyped(Symbol id, const json& json, LazyResourceStore& store) override {
         return this->load(id, json, store);
     }
 
@@ -245,11 +246,21 @@ public:
      * \throws UnregisteredResourceException if `T` does not have a registered `LazyResourceLoader`
      */
     template<typename T>
-    inline Ref<std::decay_t<T>> try_get(std::string_view id) {
+    inline Ref<std::decay_t<T>> try_get(Symbol id) {
         auto type_id = TypeId::id<std::decay_t<T>>();
         return std::static_pointer_cast<std::decay_t<T>>(this->try_get_id(type_id, typeid(T).name(), id));
     }
 
+    /**
+     * \brief Get a cached resource or load a new one from the given ID string. The ID is only interned once the
+     * resource's file has been read, so looking up a resource that does not exist leaves the symbol table unchanged
+     */
+    template<typename T>
+    inline Ref<std::decay_t<T>> try_get(std::string_view id) {
+        auto type_id = TypeId::id<std::decay_t<T>>();
+        return std::static_pointer_cast<std::decay_t<T>>(this->try_get_str(type_id, typeid(T).name(), id));
+    }
+
 private:
     /** 
      * \brief A single slot associated with a `TypeId` in the resource map
@@ -258,8 +269,8 @@ private:
         /** A pointer to a derived instance of `ErasedLazyResourceLoader` to load assets */
         std::unique_ptr<ErasedLazyResourceLoader> loader;
 
-        /** Cache of already loaded values */
-        Map<std::string, WeakRef<void>> cache;
+        /** Cache of already loaded values, keyed by interned ID */
+        Map<Symbol, WeakRef<void>> cache;
         
         /** Create a new Slot with the given type erased resource loader */
         Slot(std::unique_ptr<ErasedLazyResourceLoader>&& l) : loader{std::move(l)}, cache{} {}
@@ -274,9 +285,19 @@ private:
     /**
      * \brief Attempt to load a value using the registered lazy loader for the given type ID
      * \param type_id The ID of the type to load 
-     * \param id_str ID to search for or load
+     * \param id ID to search for or load
      * \param type_name Compile-time known typename of the type referenced by `id`
      * \return A type-erased reference to the value
      */
-    Ref<void> try_get_id(TypeId type_id, const char *type_name, std::string_view id_str);
+    Ref<void> try_get_id(TypeId type_id, const char *type_name, Symbol id);
+    /** \brief Load a value by ID string, interning the ID only if the value's file can be read */
+    Ref<void> try_get_str(TypeId type_id, const char *type_name, std::string_view id);
+
+    /**
+     * \brief Get the slot of the given type
+     * \throws UnregisteredResourceException if the type has no registered `LazyResourceLoader`
+     */
+    Slot& slot(TypeId type_id, const char *type_name);
+    /** \brief Load a value that is not cached, `sym` holds the interned ID if it has already been interned */
+    Ref<void> load(Slot& slot, const char *type_name, std::string_view id, Optional<Symbol> sym);
 };
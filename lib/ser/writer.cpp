@@ -0,0 +1,251 @@
+#include "writer.hpp"
+#include "ser.hpp"
+
+#include <charconv>
+#include <sstream>
+#include <stdexcept>
+
+#include <doctest.h>
+
+JsonWriter::JsonWriter(std::ostream& out, bool compact) : m_out{out}, m_compact{compact} {
+    this->m_buf.reserve(BUFFER_SIZE + BUFFER_SIZE / 4);
+}
+
+JsonWriter::~JsonWriter() {
+    this->flush();
+}
+
+void JsonWriter::flush() {
+    if(!this->m_buf.empty()) {
+        this->m_out.write(this->m_buf.data(), static_cast<std::streamsize>(this->m_buf.size()));
+        this->m_buf.clear();
+    }
+}
+
+void JsonWriter::element() {
+    if(this->m_after_key) {
+        this->m_after_key = false;
+        return;
+    }
+    if(this->m_nonempty.empty()) {
+        return;
+    }
+
+    if(this->m_nonempty.back()) {
+        this->m_buf += ',';
+    }
+    this->m_nonempty.back() = true;
+    if(!this->m_compact) {
+        this->m_buf += '\n';
+        this->m_buf.append(this->m_nonempty.size() * INDENT, ' ');
+    }
+}
+
+void JsonWriter::close(char bracket) {
+    const bool nonempty = this->m_nonempty.back();
+    this->m_nonempty.pop_back();
+    if(nonempty && !this->m_compact) {
+        this->m_buf += '\n';
+        this->m_buf.append(this->m_nonempty.size() * INDENT, ' ');
+    }
+    this->m_buf += bracket;
+    this->reserve();
+}
+
+void JsonWriter::begin_object() {
+    this->element();
+    this->m_buf += '{';
+    this->m_nonempty.push_back(false);
+}
+
+void JsonWriter::end_object() {
+    this->close('}');
+}
+
+void JsonWriter::begin_array() {
+    this->element();
+    this->m_buf += '[';
+    this->m_nonempty.push_back(false);
+}
+
+void JsonWriter::end_array() {
+    this->close(']');
+}
+
+void JsonWriter::key(std::string_view key) {
+    this->element();
+    this->escaped(key);
+    this->m_buf += this->m_compact ? ":" : ": ";
+    this->m_after_key = true;
+}
+
+void JsonWriter::value(std::string_view str) {
+    this->element();
+    this->escaped(str);
+    this->reserve();
+}
+
+void JsonWriter::value(std::uint64_t num) {
+    this->element();
+    char digits[20];
+    const auto [end, err] = std::to_chars(std::begin(digits), std::end(digits), num);
+    this->m_buf.append(std::begin(digits), end);
+    this->reserve();
+}
+
+/**
+ * \brief Get the length of the UTF-8 sequence starting at a byte of `str` that is not ASCII
+ * \return 0 if the bytes at `pos` are not a valid sequence, including overlong encodings and surrogates
+ */
+static std::size_t utf8_sequence(std::string_view str, std::size_t pos) noexcept {
+    const auto byte = [&str](std::size_t i) { return i < str.size() ? static_cast<unsigned char>(str[i]) : 0; };
+    const unsigned char lead = byte(pos);
+    //Range of the byte after the lead byte, the remaining bytes are always 0x80 to 0xBF
+    std::size_t len = 0;
+    unsigned char lo = 0x80, hi = 0xBF;
+    if(lead >= 0xC2 && lead <= 0xDF) {
+        len = 2;
+    } else if(lead >= 0xE0 && lead <= 0xEF) {
+        len = 3;
+        lo = lead == 0xE0 ? 0xA0 : 0x80;
+        hi = lead == 0xED ? 0x9F : 0xBF;
+    } else if(lead >= 0xF0 && lead <= 0xF4) {
+        len = 4;
+        lo = lead == 0xF0 ? 0x90 : 0x80;
+        hi = lead == 0xF4 ? 0x8F : 0xBF;
+    } else {
+        return 0;
+    }
+
+    if(byte(pos + 1) < lo || byte(pos + 1) > hi) {
+        return 0;
+    }
+    for(std::size_t i = 2; i < len; ++i) {
+        if(byte(pos + i) < 0x80 || byte(pos + i) > 0xBF) {
+            return 0;
+        }
+    }
+    return len;
+}
+
+void JsonWriter::escaped(std::string_view str) {
+    static constexpr const char HEX[] = "0123456789abcdef";
+
+    this->m_buf += '"';
+    for(std::size_t i = 0; i < str.size(); ++i) {
+        const char c = str[i];
+        switch(c) {
+            case '"': this->m_buf += "\\\""; break;
+            case '\\': this->m_buf += "\\\\"; break;
+            case '\b': this->m_buf += "\\b"; break;
+            case '\t': this->m_buf += "\\t"; break;
+            case '\n': this->m_buf += "\\n"; break;
+            case '\f': this->m_buf += "\\f"; break;
+            case '\r': this->m_buf += "\\r"; break;
+            default: {
+                //Other control characters are written as unicode escapes, everything else including valid UTF-8 as is
+                if(static_cast<unsigned char>(c) < 0x20) {
+                    this->m_buf += "\\u00";
+                    this->m_buf += HEX[static_cast<unsigned char>(c) >> 4];
+                    this->m_buf += HEX[static_cast<unsigned char>(c) & 0xF];
+                } else if(static_cast<unsigned char>(c) < 0x80) {
+                    this->m_buf += c;
+                } else {
+                    //Invalid UTF-8 would make the output invalid JSON, so it is rejected like `json::dump` rejects it
+                    const std::size_t len = utf8_sequence(str, i);
+                    if(len == 0) {
+                        throw std::runtime_error{fmt::format(
+                            "Invalid UTF-8 byte at index {}: 0x{:02X}",
+                            i,
+                            static_cast<unsigned char>(c)
+                        )};
+                    }
+                    this->m_buf.append(str.substr(i, len));
+                    i += len - 1;
+                }
+            } break;
+        }
+    }
+    this->m_buf += '"';
+}
+
+/** \brief Write a JSON tree of objects, arrays, strings, and unsigned numbers through a writer */
+static void write_tree(JsonWriter& writer, json const& val) {
+    if(val.is_object()) {
+        writer.begin_object();
+        for(const auto& [key, member] : val.items()) {
+            writer.key(key);
+            write_tree(writer, member);
+        }
+        writer.end_object();
+    } else if(val.is_array()) {
+        writer.begin_array();
+        for(const json& elem : val) {
+            write_tree(writer, elem);
+        }
+        writer.end_array();
+    } else if(val.is_string()) {
+        writer.value(val.get_ref<const std::string&>());
+    } else {
+        writer.value(val.get<std::uint64_t>());
+    }
+}
+
+TEST_CASE("JsonWriter") {
+    const json tree = json::parse(R"({
+        "edges": {},
+        "nodes": {
+            "a \"quoted\"\tkey": {"conns": [], "pos": ["1.000000m", "-2.500000mm"], "side": 1},
+            "b": {"list": [[], {}, [0, 18446744073709551615]], "name": "line\nbreak \u0001 é \\"}
+        },
+        "z": "end"
+    })");
+
+    const auto written = [&tree](bool compact) {
+        std::stringstream out{};
+        {
+            JsonWriter writer{out, compact};
+            write_tree(writer, tree);
+        }
+        return out.str();
+    };
+
+    CHECK_EQ(written(false), tree.dump(4));
+    CHECK_EQ(written(true), tree.dump());
+
+    std::stringstream out{};
+    JsonWriter writer{out};
+    writer.begin_array();
+    for(std::uint64_t i = 0; i < JsonWriter::BUFFER_SIZE; ++i) {
+        writer.value(i);
+    }
+    //Everything but the last partial buffer has already been written
+    CHECK_FALSE(out.str().empty());
+    writer.end_array();
+    writer.flush();
+    CHECK_EQ(json::parse(out.str()).size(), JsonWriter::BUFFER_SIZE);
+
+    //Every sequence that `json::dump` rejects is rejected, and valid multibyte sequences are written as is
+    for(std::string const& invalid : {
+        std::string{"\xff"},
+        std::string{"truncated \xc3"},
+        std::string{"\xc0\xaf"},
+        std::string{"\xe0\x80\xaf"},
+        std::string{"\xed\xa0\x80"},
+        std::string{"\xf4\x90\x80\x80"},
+        std::string{"\x80"},
+    }) {
+        CAPTURE(invalid);
+        CHECK_THROWS_AS(json(invalid).dump(), json::type_error);
+        std::stringstream rejected{};
+        JsonWriter strings{rejected};
+        CHECK_THROWS_AS(strings.value(invalid), std::runtime_error);
+    }
+    const std::string valid = "\xc3\xa9 \xe2\x82\xac \xf0\x9f\x94\x8c \xed\x9f\xbf \xf4\x8f\xbf\xbf";
+    std::stringstream accepted{};
+    {
+        JsonWriter strings{accepted, true};
+        strings.value(valid);
+    }
+    CHECK_EQ(accepted.str(), json(valid).dump());
+}
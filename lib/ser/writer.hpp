@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * \brief Writes JSON text straight to an output stream one value at a time, without building a `json` tree first.
+ *
+ * Output is formatted exactly as `json::dump` formats it: with a 4 space indent when pretty printing, or with no
+ * whitespace at all when compact. Strings are written as UTF-8 and only escaped where `json::dump` escapes them, so
+ * writing the members of every object in the order of their keys reproduces `dump` byte for byte.
+ *
+ * Text is collected in a fixed size buffer that is written to the stream whenever it fills, and when the writer is
+ * flushed or destroyed
+ */
+class JsonWriter {
+public:
+    /** \brief Number of bytes collected before they are written to the stream */
+    static constexpr const std::size_t BUFFER_SIZE = 64 * 1024;
+    /** \brief Number of spaces that each level of nesting is indented by when pretty printing */
+    static constexpr const std::size_t INDENT = 4;
+
+    /** \brief Create a writer that writes to the given stream, pretty printed unless `compact` is set */
+    explicit JsonWriter(std::ostream& out, bool compact = false);
+
+    JsonWriter(JsonWriter const&) = delete;
+    JsonWriter& operator=(JsonWriter const&) = delete;
+
+    ~JsonWriter();
+
+    void begin_object();
+    void end_object();
+    void begin_array();
+    void end_array();
+    /**
+     * \brief Write the key of the next member of the object being written
+     * \throws std::runtime_error if the key is not valid UTF-8, as `json::dump` does
+     */
+    void key(std::string_view key);
+
+    /** \throws std::runtime_error if the string is not valid UTF-8, as `json::dump` does */
+    void value(std::string_view str);
+    void value(std::uint64_t num);
+
+    /** \brief Write everything buffered so far to the stream */
+    void flush();
+private:
+    std::ostream& m_out;
+    bool m_compact;
+    std::string m_buf{};
+    /** \brief For each object or array being written, if it has had any elements written yet */
+    std::vector<bool> m_nonempty{};
+    /** \brief If a key was just written, so the next value continues its member instead of starting a new element */
+    bool m_after_key{false};
+
+    /** \brief Write the separator and indent that come before a new element of the object or array being written */
+    void element();
+    /** \brief Close the object or array being written with the given bracket */
+    void close(char bracket);
+    /** \brief Write a string with the escapes that `json::dump` uses */
+    void escaped(std::string_view str);
+    /** \brief Write the buffer to the stream if it has filled */
+    inline void reserve() {
+        if(this->m_buf.size() >= BUFFER_SIZE) {
+            this->flush();
+        }
+    }
+};
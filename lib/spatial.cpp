@@ -0,0 +1,506 @@
+#include "spatial.hpp"
+#include "component.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include <doctest.h>
+
+#include "testing.hpp"
+
+SpatialIndex::SpatialIndex(BoardGraph const& graph) {
+    const auto& nodes = std::as_const(graph.m_storage->nodes);
+    std::vector<std::pair<Tree::Box, BoardGraph::NodeHandle>> entries{};
+    entries.reserve(nodes.size());
+    this->m_boxes.resize(nodes.slots());
+    for(auto it = nodes.begin(); it != nodes.end(); ++it) {
+        const Tree::Box bounds = box(it->aabb());
+        this->m_boxes[it.index()] = bounds;
+        entries.emplace_back(bounds, it.index());
+    }
+    this->m_tree.load(std::move(entries));
+}
+
+std::vector<BoardGraph::NodeHandle> SpatialIndex::at(Point const& pt) const {
+    std::vector<BoardGraph::NodeHandle> found{};
+    this->at(pt, [&found](BoardGraph::NodeHandle node) { found.push_back(node); });
+    return found;
+}
+
+std::vector<BoardGraph::NodeHandle> SpatialIndex::intersecting(AABB const& area) const {
+    std::vector<BoardGraph::NodeHandle> found{};
+    this->intersecting(area, [&found](BoardGraph::NodeHandle node) { found.push_back(node); });
+    return found;
+}
+
+std::vector<BoardGraph::NodeHandle> SpatialIndex::within(AABB const& area) const {
+    std::vector<BoardGraph::NodeHandle> found{};
+    this->within(area, [&found](BoardGraph::NodeHandle node) { found.push_back(node); });
+    return found;
+}
+
+void SpatialIndex::node_added(ComponentNode const& node) {
+    this->insert(node);
+}
+
+void SpatialIndex::node_removed(ComponentNode const& node) {
+    this->remove(node.handle());
+}
+
+void SpatialIndex::moved(ComponentNode const& node, Point from) {
+    (void)from;
+    this->remove(node.handle());
+    this->insert(node);
+}
+
+SpatialIndex::Tree::Box SpatialIndex::box(AABB const& aabb) noexcept {
+    return Tree::Box{
+        {coord::to_normalized(aabb.min.x), coord::to_normalized(aabb.min.y)},
+        {coord::to_normalized(aabb.max.x), coord::to_normalized(aabb.max.y)}
+    };
+}
+
+void SpatialIndex::insert(ComponentNode const& node) {
+    if(node.handle() >= this->m_boxes.size()) {
+        this->m_boxes.resize(node.handle() + 1);
+    }
+    const Tree::Box bounds = box(node.aabb());
+    this->m_boxes[node.handle()] = bounds;
+    this->m_tree.insert(bounds, node.handle());
+}
+
+void SpatialIndex::remove(BoardGraph::NodeHandle handle) {
+    if(handle >= this->m_boxes.size() || !this->m_boxes[handle].has_value()) {
+        return;
+    }
+    this->m_tree.remove(this->m_boxes[handle].unwrap_unchecked(), handle);
+    this->m_boxes[handle] = std::nullopt;
+}
+
+WireIndex::WireIndex(BoardGraph const& graph) {
+    const auto& edges = std::as_const(graph.m_storage->edges);
+    std::vector<std::pair<Tree::Box, Segment>> entries{};
+    this->m_lines.resize(edges.slots());
+    for(auto it = edges.begin(); it != edges.end(); ++it) {
+        this->m_lines[it.index()] = line(*it);
+        for(size_type i = 0; i + 1 < this->m_lines[it.index()].size(); ++i) {
+            const Segment seg{.edge = it.index(), .index = i};
+            entries.emplace_back(this->box(seg), seg);
+        }
+    }
+    this->m_tree.load(std::move(entries));
+}
+
+Optional<WireIndex::Segment> WireIndex::hit(Point const& pt, Length tolerance) const {
+    const Vec at{pt.x.normalized(), pt.y.normalized()};
+    Tree::Scalar best = tolerance.normalized();
+    Optional<Segment> found{};
+    //Segments are visited by the distance to their bounds, which is never more than the distance to the segment
+    this->m_tree.nearest(at[0], at[1], [this, &at, &best, &found](Segment const& seg, Tree::Scalar bound) {
+        if(bound > best) {
+            return false;
+        }
+        const Tree::Scalar dist = this->distance(seg, at);
+        if(dist <= best) {
+            best = dist;
+            found = seg;
+        }
+        return true;
+    });
+    return found;
+}
+
+std::vector<BoardGraph::EdgeHandle> WireIndex::intersecting(AABB const& area) const {
+    std::vector<BoardGraph::EdgeHandle> found{};
+    this->intersecting(area, [&found](Segment seg) { found.push_back(seg.edge); });
+    std::sort(found.begin(), found.end());
+    found.erase(std::unique(found.begin(), found.end()), found.end());
+    return found;
+}
+
+void WireIndex::edge_added(WireEdge const& edge) {
+    this->insert(edge);
+}
+
+void WireIndex::edge_removed(WireEdge const& edge) {
+    this->remove(edge.handle().index);
+}
+
+void WireIndex::connected(ComponentNode const& node, ConnectionPortIdx port, WireEdge const& edge, WireEdge::Side side) {
+    this->move_end(edge.handle().index, side, node.port_pos(port));
+}
+
+void WireIndex::detached(ComponentNode const& node, ConnectionPortIdx port, WireEdge const& edge, WireEdge::Side side) {
+    (void)node;
+    (void)port;
+    this->move_end(edge.handle().index, side, edge.connections()[side].pos().raw());
+}
+
+void WireIndex::moved(ComponentNode const& node, Point from) {
+    (void)from;
+    for(const auto& [port, conn] : node.m_edges) {
+        this->move_end(conn.edge.index, conn.side, node.port_pos(port));
+    }
+}
+
+void WireIndex::rerouted(WireEdge const& edge, std::span<const RawPoint> from) {
+    (void)from;
+    this->remove(edge.handle().index);
+    this->insert(edge);
+}
+
+std::vector<WireIndex::Vec> WireIndex::line(WireEdge const& edge) {
+    std::vector<Vec> pts{};
+    pts.reserve(edge.points().size() + 2);
+    auto add = [&pts](RawPoint const& pt) { pts.push_back(Vec{coord::to_normalized(pt.x), coord::to_normalized(pt.y)}); };
+    add(edge.connections()[WireEdge::LEFT].pos().raw());
+    std::for_each(edge.begin(), edge.end(), add);
+    add(edge.connections()[WireEdge::RIGHT].pos().raw());
+    return pts;
+}
+
+WireIndex::Tree::Box WireIndex::box(Segment seg) const noexcept {
+    const Vec& a = this->m_lines[seg.edge][seg.index];
+    const Vec& b = this->m_lines[seg.edge][seg.index + 1];
+    return Tree::Box{
+        {std::min(a[0], b[0]), std::min(a[1], b[1])},
+        {std::max(a[0], b[0]), std::max(a[1], b[1])}
+    };
+}
+
+WireIndex::Tree::Scalar WireIndex::distance(Segment seg, Vec const& pt) const noexcept {
+    const Vec& a = this->m_lines[seg.edge][seg.index];
+    const Vec& b = this->m_lines[seg.edge][seg.index + 1];
+    const Tree::Scalar dx = b[0] - a[0];
+    const Tree::Scalar dy = b[1] - a[1];
+    const Tree::Scalar len2 = dx * dx + dy * dy;
+    //Project the point onto the segment, clamping to the ends
+    const Tree::Scalar t = len2 == 0 ? 0 : std::clamp(((pt[0] - a[0]) * dx + (pt[1] - a[1]) * dy) / len2, Tree::Scalar{0}, Tree::Scalar{1});
+    return std::hypot(a[0] + t * dx - pt[0], a[1] + t * dy - pt[1]);
+}
+
+bool WireIndex::crosses(Segment seg, Tree::Box const& area) const noexcept {
+    const Vec& a = this->m_lines[seg.edge][seg.index];
+    const Vec& b = this->m_lines[seg.edge][seg.index + 1];
+    //Clip the segment's parameter range against each pair of box edges in turn
+    Tree::Scalar lo = 0;
+    Tree::Scalar hi = 1;
+    for(std::size_t axis = 0; axis < 2; ++axis) {
+        const Tree::Scalar d = b[axis] - a[axis];
+        if(d == 0) {
+            if(a[axis] < area.min[axis] || a[axis] > area.max[axis]) {
+                return false;
+            }
+            continue;
+        }
+        Tree::Scalar enter = (area.min[axis] - a[axis]) / d;
+        Tree::Scalar exit = (area.max[axis] - a[axis]) / d;
+        if(enter > exit) {
+            std::swap(enter, exit);
+        }
+        lo = std::max(lo, enter);
+        hi = std::min(hi, exit);
+        if(lo > hi) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void WireIndex::insert(WireEdge const& edge) {
+    const BoardGraph::EdgeHandle handle = edge.handle().index;
+    if(handle >= this->m_lines.size()) {
+        this->m_lines.resize(handle + 1);
+    }
+    this->m_lines[handle] = line(edge);
+    for(size_type i = 0; i + 1 < this->m_lines[handle].size(); ++i) {
+        const Segment seg{.edge = handle, .index = i};
+        this->m_tree.insert(this->box(seg), seg);
+    }
+}
+
+void WireIndex::remove(BoardGraph::EdgeHandle handle) {
+    if(handle >= this->m_lines.size()) {
+        return;
+    }
+    for(size_type i = 0; i + 1 < this->m_lines[handle].size(); ++i) {
+        const Segment seg{.edge = handle, .index = i};
+        this->m_tree.remove(this->box(seg), seg);
+    }
+    this->m_lines[handle].clear();
+}
+
+void WireIndex::move_end(BoardGraph::EdgeHandle handle, WireEdge::Side side, RawPoint const& pos) {
+    if(handle >= this->m_lines.size() || this->m_lines[handle].size() < 2) {
+        return;
+    }
+    std::vector<Vec>& pts = this->m_lines[handle];
+    const Segment seg{.edge = handle, .index = side == WireEdge::LEFT ? 0 : static_cast<size_type>(pts.size() - 2)};
+    const Vec moved{coord::to_normalized(pos.x), coord::to_normalized(pos.y)};
+    Vec& end = side == WireEdge::LEFT ? pts.front() : pts.back();
+    if(end == moved) {
+        return;
+    }
+    this->m_tree.remove(this->box(seg), seg);
+    end = moved;
+    this->m_tree.insert(this->box(seg), seg);
+}
+
+PortIndex::PortIndex(BoardGraph const& graph) {
+    const auto& nodes = std::as_const(graph.m_storage->nodes);
+    std::vector<std::pair<Tree::Box, Port>> entries{};
+    this->m_ports.resize(nodes.slots());
+    for(auto it = nodes.begin(); it != nodes.end(); ++it) {
+        const ComponentNode& node = *it;
+        std::vector<Optional<Tree::Box>>& ports = this->m_ports[it.index()];
+        ports.resize(node.port_positions().size());
+        for(auto port = node.type()->begin(); port != node.type()->end(); ++port) {
+            if(node.m_edges.contains(port.index())) {
+                continue;
+            }
+            const RawPoint& pos = node.port_pos(port.index());
+            const Tree::Box box = Tree::Box::point(coord::to_normalized(pos.x), coord::to_normalized(pos.y));
+            ports[port.index()] = box;
+            entries.emplace_back(box, Port{.node = it.index(), .port = port.index()});
+        }
+    }
+    this->m_tree.load(std::move(entries));
+}
+
+std::vector<PortIndex::Port> PortIndex::nearest(Point const& pt, Length radius, std::size_t k) const {
+    std::vector<Port> found{};
+    if(k == 0) {
+        return found;
+    }
+    found.reserve(k);
+    this->nearest(pt, radius, [&found, k](Port port, Length) {
+        found.push_back(port);
+        return found.size() < k;
+    });
+    return found;
+}
+
+void PortIndex::node_added(ComponentNode const& node) {
+    if(node.handle() >= this->m_ports.size()) {
+        this->m_ports.resize(node.handle() + 1);
+    }
+    this->m_ports[node.handle()].assign(node.port_positions().size(), Optional<Tree::Box>{});
+    //Wires attached by a batch insert are reported afterwards with `connected`, which removes their ports again
+    for(auto port = node.type()->begin(); port != node.type()->end(); ++port) {
+        this->insert(node, port.index());
+    }
+}
+
+void PortIndex::node_removed(ComponentNode const& node) {
+    if(node.handle() >= this->m_ports.size()) {
+        return;
+    }
+    for(ConnectionPortIdx port = 0; port < this->m_ports[node.handle()].size(); ++port) {
+        this->remove(node.handle(), port);
+    }
+    this->m_ports[node.handle()].clear();
+}
+
+void PortIndex::connected(ComponentNode const& node, ConnectionPortIdx port, WireEdge const& edge, WireEdge::Side side) {
+    (void)edge;
+    (void)side;
+    this->remove(node.handle(), port);
+}
+
+void PortIndex::detached(ComponentNode const& node, ConnectionPortIdx port, WireEdge const& edge, WireEdge::Side side) {
+    (void)edge;
+    (void)side;
+    this->insert(node, port);
+}
+
+void PortIndex::moved(ComponentNode const& node, Point from) {
+    (void)from;
+    if(node.handle() >= this->m_ports.size()) {
+        return;
+    }
+    for(ConnectionPortIdx port = 0; port < this->m_ports[node.handle()].size(); ++port) {
+        if(this->m_ports[node.handle()][port].has_value()) {
+            this->remove(node.handle(), port);
+            this->insert(node, port);
+        }
+    }
+}
+
+void PortIndex::insert(ComponentNode const& node, ConnectionPortIdx port) {
+    if(node.handle() >= this->m_ports.size() || port >= this->m_ports[node.handle()].size()) {
+        return;
+    }
+    Optional<Tree::Box>& slot = this->m_ports[node.handle()][port];
+    if(slot.has_value()) {
+        return;
+    }
+    const RawPoint& pos = node.port_pos(port);
+    slot = Tree::Box::point(coord::to_normalized(pos.x), coord::to_normalized(pos.y));
+    this->m_tree.insert(slot.unwrap_unchecked(), Port{.node = node.handle(), .port = port});
+}
+
+void PortIndex::remove(BoardGraph::NodeHandle node, ConnectionPortIdx port) {
+    if(node >= this->m_ports.size() || port >= this->m_ports[node].size()) {
+        return;
+    }
+    Optional<Tree::Box>& slot = this->m_ports[node][port];
+    if(!slot.has_value()) {
+        return;
+    }
+    this->m_tree.remove(slot.unwrap_unchecked(), Port{.node = node, .port = port});
+    slot = std::nullopt;
+}
+
+namespace {
+
+/** \brief Windows tiling the area around the origin that the test boards are built in */
+std::vector<AABB> windows() {
+    std::vector<AABB> out{};
+    for(int i = -5; i < 5; ++i) {
+        for(int j = -5; j < 5; ++j) {
+            out.emplace_back(
+                Point{Length{i * 0.2f}, Length{j * 0.2f}},
+                Point{Length{(i + 1) * 0.2f}, Length{(j + 1) * 0.2f}}
+            );
+        }
+    }
+    return out;
+}
+
+/** \brief Check that a tracked index finds the same items in every window as an index built from scratch */
+template<typename Index>
+bool agrees(Index const& tracked, BoardGraph const& graph) {
+    const Index fresh{graph};
+    if(tracked.size() != fresh.size()) {
+        return false;
+    }
+    for(const AABB& window : windows()) {
+        auto a = tracked.intersecting(window);
+        auto b = fresh.intersecting(window);
+        std::sort(a.begin(), a.end());
+        std::sort(b.begin(), b.end());
+        if(a != b) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/** \brief Workspace bounds of the test boards */
+const AABB EVERYWHERE{Point{Length{-1.f}, Length{-1.f}}, Point{Length{1.f}, Length{1.f}}};
+
+}
+
+TEST_CASE("SpatialIndex") {
+    const testing::AssetDir assets{};
+    BoardGraph graph = testing::asset_board();
+    const Ref<Component> bus = graph.resources().try_get<Component>("1280.bus");
+    const Ref<SpatialIndex> tracked = graph.track<SpatialIndex>();
+    CHECK(agrees(*tracked, graph));
+
+    const Ref<ComponentNode> a = graph.component(bus, "spatial.a", Point{Length{-0.5f}, Length{-0.5f}});
+    const Ref<ComponentNode> b = graph.component(bus, "spatial.b", Point{Length{-0.5f}, Length{0.5f}});
+    CHECK(agrees(*tracked, graph));
+    CHECK_EQ(tracked->at(Point{Length{-0.5f}, Length{-0.5f}}), std::vector{a->handle()});
+    CHECK_EQ(tracked->within(EVERYWHERE).size(), tracked->size());
+
+    a->move_to(Point{Length{0.7f}, Length{-0.7f}});
+    CHECK(agrees(*tracked, graph));
+    CHECK(tracked->at(Point{Length{-0.5f}, Length{-0.5f}}).empty());
+    CHECK_EQ(tracked->nearest(Point{Length{0.8f}, Length{-0.8f}}).unwrap(), a->handle());
+
+    graph.remove_node(b->handle());
+    CHECK(agrees(*tracked, graph));
+    CHECK(tracked->at(Point{Length{-0.5f}, Length{0.5f}}).empty());
+}
+
+TEST_CASE("WireIndex") {
+    const testing::AssetDir assets{};
+    BoardGraph graph = testing::asset_board();
+    const Ref<Component> bus = graph.resources().try_get<Component>("1280.bus");
+    const Ref<Connector> bare = graph.resources().try_get<Connector>("1280.bare");
+    const Ref<WireIndex> tracked = graph.track<WireIndex>();
+    CHECK(agrees(*tracked, graph));
+
+    const Ref<ComponentNode> a = graph.component(bus, "wire.a", Point{Length{-0.6f}, Length{-0.6f}});
+    const Ref<ComponentNode> b = graph.component(bus, "wire.b", Point{Length{-0.6f}, Length{0.6f}});
+    const Point bend{Length{-0.9f}, Length{0.f}};
+    Ref<WireEdge> edge = graph.edge(
+        "wire.e",
+        {bare, bare},
+        {Point{Length{0.f}, Length{-0.9f}}, Point{Length{0.f}, Length{0.9f}}},
+        {bend.raw()}
+    );
+    CHECK(agrees(*tracked, graph));
+    CHECK_EQ(tracked->hit(bend, Length{0.01f}).unwrap().edge, edge->handle().index);
+
+    a->connnect_port(bus->get_port_idx("out0").unwrap(), edge, WireEdge::LEFT);
+    b->connnect_port(bus->get_port_idx("in").unwrap(), edge, WireEdge::RIGHT);
+    CHECK(agrees(*tracked, graph));
+
+    a->move_to(Point{Length{0.6f}, Length{-0.6f}});
+    CHECK(agrees(*tracked, graph));
+
+    graph.reroute(edge->handle().index, {Point{Length{0.9f}, Length{0.f}}.raw()});
+    CHECK(agrees(*tracked, graph));
+    CHECK_FALSE(tracked->hit(bend, Length{0.01f}).has_value());
+
+    edge->side(WireEdge::RIGHT).detach();
+    CHECK(agrees(*tracked, graph));
+    b->move_to(Point{Length{0.f}, Length{0.6f}});
+    CHECK(agrees(*tracked, graph));
+
+    graph.remove_node(a->handle());
+    CHECK(agrees(*tracked, graph));
+    graph.remove_edge(edge->handle().index);
+    CHECK(agrees(*tracked, graph));
+}
+
+TEST_CASE("PortIndex") {
+    const testing::AssetDir assets{};
+    BoardGraph graph = testing::asset_board();
+    const Ref<Component> bus = graph.resources().try_get<Component>("1280.bus");
+    const Ref<Connector> bare = graph.resources().try_get<Connector>("1280.bare");
+    const Ref<PortIndex> tracked = graph.track<PortIndex>();
+    const auto port = [&bus](std::string_view id) { return bus->get_port_idx(id).unwrap(); };
+    //Free ports near a point as found by the tracked index and by an index built from scratch, in the same order
+    const auto agrees = [&graph, &tracked](Point const& pt) {
+        const PortIndex fresh{graph};
+        const auto by_port = [](PortIndex::Port const& l, PortIndex::Port const& r) {
+            return std::pair{l.node, l.port} < std::pair{r.node, r.port};
+        };
+        auto a = tracked->nearest(pt, Length{2.f}, tracked->size() + fresh.size());
+        auto b = fresh.nearest(pt, Length{2.f}, tracked->size() + fresh.size());
+        std::sort(a.begin(), a.end(), by_port);
+        std::sort(b.begin(), b.end(), by_port);
+        return tracked->size() == fresh.size() && a == b;
+    };
+    CHECK(agrees(Point{}));
+
+    const std::size_t before = tracked->size();
+    const Ref<ComponentNode> a = graph.component(bus, "port.a", Point{Length{-0.5f}, Length{-0.5f}});
+    CHECK_EQ(tracked->size(), before + 4);
+    CHECK(agrees(Point{}));
+
+    Ref<WireEdge> edge = graph.edge("port.e", {bare, bare});
+    a->connnect_port(port("aux"), edge, WireEdge::LEFT);
+    CHECK_EQ(tracked->size(), before + 3);
+    CHECK(agrees(Point{}));
+
+    const Point aux{Point{Length{-0.5f}, Length{-0.5f}}.x + Length{LengthUnit::Inches, 2}, Length{-0.5f}};
+    const std::vector<PortIndex::Port> nearest = tracked->nearest(aux, Length{0.01f}, 1);
+    CHECK(nearest.empty());
+
+    edge->side(WireEdge::LEFT).detach();
+    CHECK_EQ(tracked->size(), before + 4);
+    CHECK_EQ(tracked->nearest(aux, Length{0.01f}, 1), std::vector{PortIndex::Port{.node = a->handle(), .port = port("aux")}});
+
+    a->move_to(Point{Length{0.5f}, Length{0.5f}});
+    CHECK(agrees(Point{Length{0.5f}, Length{0.5f}}));
+    CHECK(tracked->nearest(aux, Length{0.01f}, 1).empty());
+
+    graph.remove_node(a->handle());
+    CHECK_EQ(tracked->size(), before);
+    CHECK(agrees(Point{}));
+}
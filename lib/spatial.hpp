@@ -0,0 +1,263 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "lib.hpp"
+#include "util/optional.hpp"
+#include "util/rtree.hpp"
+
+/**
+ * \brief Spatial index of the nodes in a `BoardGraph`, keyed on each node's bounding box, so that hit-testing,
+ * box selection, and overlap checks visit only the nodes near the queried area instead of every node on the board.
+ *
+ * When created with `BoardGraph::track`, the index is kept up to date as nodes are added, removed, and moved
+ */
+class SpatialIndex : public GraphObserver {
+public:
+    using Tree = RTree<BoardGraph::NodeHandle>;
+
+    /** \brief Create an index containing no nodes */
+    SpatialIndex() = default;
+
+    /**
+     * \brief Index the bounding boxes of every node in the given graph, building the whole tree in one pass so that
+     * it is packed more tightly than a tree built up by later edits
+     */
+    explicit SpatialIndex(BoardGraph const& graph);
+
+    /** \brief Get the number of nodes in this index */
+    inline std::size_t size() const noexcept { return this->m_tree.size(); }
+
+    /** \brief Invoke `fn` with the handle of every node whose bounding box contains the given point */
+    template<typename F>
+    requires(std::invocable<F, BoardGraph::NodeHandle>)
+    inline void at(Point const& pt, F&& fn) const {
+        this->m_tree.query(pt.x.normalized(), pt.y.normalized(), std::forward<F>(fn));
+    }
+    /** \brief Get the handles of all nodes whose bounding boxes contain the given point */
+    std::vector<BoardGraph::NodeHandle> at(Point const& pt) const;
+
+    /** \brief Invoke `fn` with the handle of every node whose bounding box overlaps `area` */
+    template<typename F>
+    requires(std::invocable<F, BoardGraph::NodeHandle>)
+    inline void intersecting(AABB const& area, F&& fn) const {
+        this->m_tree.query(box(area), std::forward<F>(fn));
+    }
+    /** \brief Get the handles of all nodes whose bounding boxes overlap `area` */
+    std::vector<BoardGraph::NodeHandle> intersecting(AABB const& area) const;
+
+    /** \brief Invoke `fn` with the handle of every node whose bounding box lies entirely inside `area` */
+    template<typename F>
+    requires(std::invocable<F, BoardGraph::NodeHandle>)
+    inline void within(AABB const& area, F&& fn) const {
+        this->m_tree.contained(box(area), std::forward<F>(fn));
+    }
+    /** \brief Get the handles of all nodes whose bounding boxes lie entirely inside `area`, as for box selection */
+    std::vector<BoardGraph::NodeHandle> within(AABB const& area) const;
+
+    /**
+     * \brief Visit nodes in order of increasing distance from the given point to their bounding boxes, until
+     * `fn` returns false
+     * \param fn Invoked with the handle of each node and the distance to its bounding box, which is 0 when the
+     * point is inside the box
+     */
+    template<typename F>
+    requires(std::is_invocable_r_v<bool, F, BoardGraph::NodeHandle, Length>)
+    inline void nearest(Point const& pt, F&& fn) const {
+        this->m_tree.nearest(
+            pt.x.normalized(),
+            pt.y.normalized(),
+            [&fn](BoardGraph::NodeHandle node, Tree::Scalar dist) { return fn(node, Length{dist}); }
+        );
+    }
+    /** \brief Get the node with the bounding box nearest to the given point, if there are any nodes */
+    inline Optional<BoardGraph::NodeHandle> nearest(Point const& pt) const {
+        return this->m_tree.nearest(pt.x.normalized(), pt.y.normalized());
+    }
+
+    void node_added(ComponentNode const& node) override;
+    void node_removed(ComponentNode const& node) override;
+    void moved(ComponentNode const& node, Point from) override;
+private:
+    Tree m_tree{};
+    /** \brief Box that each node was inserted into the tree with, indexed by node handle */
+    std::vector<Optional<Tree::Box>> m_boxes{};
+
+    /** \brief Convert a bounding box to normalized tree coordinates */
+    static Tree::Box box(AABB const& aabb) noexcept;
+
+    /** \brief Insert a node with its current bounding box */
+    void insert(ComponentNode const& node);
+    /** \brief Remove a node using the box it was inserted with */
+    void remove(BoardGraph::NodeHandle handle);
+};
+
+/**
+ * \brief Spatial index of every straight segment of every wire in a `BoardGraph`, answering which wire is under a
+ * point and which wires pass through a region without walking the points of every edge. A wire runs from its left
+ * end through each of its points in order to its right end.
+ *
+ * When created with `BoardGraph::track`, the index is kept up to date as edges are added, removed, and
+ * rerouted, as wire ends are attached and detached, and as the nodes that wires attach to are moved. Only the
+ * segments whose geometry changed are reindexed
+ */
+class WireIndex : public GraphObserver {
+public:
+    using size_type = std::uint32_t;
+
+    /** \brief A single straight segment of a wire */
+    struct Segment {
+        /** \brief Handle of the wire in the graph's edge storage */
+        BoardGraph::EdgeHandle edge;
+        /** \brief Position of the segment along the wire, segment `i` runs from the `i`th point to the next */
+        size_type index;
+
+        constexpr inline bool operator==(Segment const& other) const noexcept = default;
+    };
+
+    using Tree = RTree<Segment>;
+
+    /** \brief Create an index containing no wires */
+    WireIndex() = default;
+
+    /** \brief Index every segment of every wire in the given graph, building the whole tree in one pass */
+    explicit WireIndex(BoardGraph const& graph);
+
+    /** \brief Get the number of wire segments in this index */
+    inline std::size_t size() const noexcept { return this->m_tree.size(); }
+
+    /**
+     * \brief Invoke `fn` with every segment that passes within `tolerance` of the given point, and the distance
+     * from the point to the segment
+     */
+    template<typename F>
+    requires(std::invocable<F, Segment, Length>)
+    void at(Point const& pt, Length tolerance, F&& fn) const {
+        const Vec at{pt.x.normalized(), pt.y.normalized()};
+        const Tree::Scalar tol = tolerance.normalized();
+        this->m_tree.query(
+            Tree::Box{{at[0] - tol, at[1] - tol}, {at[0] + tol, at[1] + tol}},
+            [this, &at, tol, &fn](Segment const& seg) {
+                const Tree::Scalar dist = this->distance(seg, at);
+                if(dist <= tol) {
+                    fn(seg, Length{dist});
+                }
+            }
+        );
+    }
+    /** \brief Get the segment nearest to the given point, if any segment passes within `tolerance` of it */
+    Optional<Segment> hit(Point const& pt, Length tolerance) const;
+
+    /** \brief Invoke `fn` with every segment that passes through `area` */
+    template<typename F>
+    requires(std::invocable<F, Segment>)
+    void intersecting(AABB const& area, F&& fn) const {
+        const Tree::Box bounds{
+            {coord::to_normalized(area.min.x), coord::to_normalized(area.min.y)},
+            {coord::to_normalized(area.max.x), coord::to_normalized(area.max.y)}
+        };
+        this->m_tree.query(bounds, [this, &bounds, &fn](Segment const& seg) {
+            if(this->crosses(seg, bounds)) {
+                fn(seg);
+            }
+        });
+    }
+    /** \brief Get the handles of all wires with at least one segment passing through `area`, each listed once */
+    std::vector<BoardGraph::EdgeHandle> intersecting(AABB const& area) const;
+
+    void edge_added(WireEdge const& edge) override;
+    void edge_removed(WireEdge const& edge) override;
+    void connected(ComponentNode const& node, ConnectionPortIdx port, WireEdge const& edge, WireEdge::Side side) override;
+    void detached(ComponentNode const& node, ConnectionPortIdx port, WireEdge const& edge, WireEdge::Side side) override;
+    void moved(ComponentNode const& node, Point from) override;
+    void rerouted(WireEdge const& edge, std::span<const RawPoint> from) override;
+private:
+    /** \brief A point in normalized workspace coordinates */
+    using Vec = std::array<Tree::Scalar, 2>;
+
+    Tree m_tree{};
+    /** \brief Every point of every indexed wire including both ends, indexed by edge handle */
+    std::vector<std::vector<Vec>> m_lines{};
+
+    /** \brief Get every point of a wire from its left end to its right end */
+    static std::vector<Vec> line(WireEdge const& edge);
+    /** \brief Get the bounds of a segment of an indexed wire */
+    Tree::Box box(Segment seg) const noexcept;
+    /** \brief Get the distance from a point to the nearest point on a segment */
+    Tree::Scalar distance(Segment seg, Vec const& pt) const noexcept;
+    /** \brief Check if a segment passes through a box */
+    bool crosses(Segment seg, Tree::Box const& area) const noexcept;
+
+    /** \brief Index every segment of a wire, which must not already be indexed */
+    void insert(WireEdge const& edge);
+    /** \brief Remove every segment of a wire */
+    void remove(BoardGraph::EdgeHandle handle);
+    /** \brief Move one end of an indexed wire, reindexing only the segment that ends there */
+    void move_end(BoardGraph::EdgeHandle handle, WireEdge::Side side, RawPoint const& pos);
+};
+
+/**
+ * \brief Spatial index of the ports in a `BoardGraph` that no wire is attached to, placed at their workspace
+ * positions, for snapping a dragged wire end to the nearest free port. Occupied ports are kept out of the index
+ * entirely, so a nearest-port query never has to step over them.
+ *
+ * When created with `BoardGraph::track`, the index is kept up to date as nodes are added, removed, and moved
+ * and as wires are attached and detached
+ */
+class PortIndex : public GraphObserver {
+public:
+    /** \brief A single port on a specific node in the graph */
+    struct Port {
+        BoardGraph::NodeHandle node;
+        ConnectionPortIdx port;
+
+        constexpr inline bool operator==(Port const& other) const noexcept = default;
+    };
+
+    using Tree = RTree<Port>;
+
+    /** \brief Create an index containing no ports */
+    PortIndex() = default;
+
+    /** \brief Index every free port of every node in the given graph, building the whole tree in one pass */
+    explicit PortIndex(BoardGraph const& graph);
+
+    /** \brief Get the number of free ports in this index */
+    inline std::size_t size() const noexcept { return this->m_tree.size(); }
+
+    /**
+     * \brief Visit free ports within `radius` of the given point in order of increasing distance, until `fn`
+     * returns false
+     * \param fn Invoked with each port and its distance from the point
+     */
+    template<typename F>
+    requires(std::is_invocable_r_v<bool, F, Port, Length>)
+    void nearest(Point const& pt, Length radius, F&& fn) const {
+        const Tree::Scalar max = radius.normalized();
+        this->m_tree.nearest(pt.x.normalized(), pt.y.normalized(), [max, &fn](Port const& port, Tree::Scalar dist) {
+            return dist <= max && fn(port, Length{dist});
+        });
+    }
+    /** \brief Get up to `k` free ports within `radius` of the given point, nearest first */
+    std::vector<Port> nearest(Point const& pt, Length radius, std::size_t k) const;
+
+    void node_added(ComponentNode const& node) override;
+    void node_removed(ComponentNode const& node) override;
+    void connected(ComponentNode const& node, ConnectionPortIdx port, WireEdge const& edge, WireEdge::Side side) override;
+    void detached(ComponentNode const& node, ConnectionPortIdx port, WireEdge const& edge, WireEdge::Side side) override;
+    void moved(ComponentNode const& node, Point from) override;
+private:
+    Tree m_tree{};
+    /**
+     * \brief Position that every port was inserted into the tree at, indexed by node handle and then by port,
+     * empty for ports that are not in the tree
+     */
+    std::vector<std::vector<Optional<Tree::Box>>> m_ports{};
+
+    /** \brief Add a free port to the tree at its current position */
+    void insert(ComponentNode const& node, ConnectionPortIdx port);
+    /** \brief Remove a port from the tree if it is there */
+    void remove(BoardGraph::NodeHandle node, ConnectionPortIdx port);
+};
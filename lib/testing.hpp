@@ -0,0 +1,58 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include <buildopts.h>
+
+#include "lib.hpp"
+
+/**
+ * \brief Helpers for the test cases of modules that need a loaded board. Resources and boards are loaded from
+ * paths relative to the working directory, so tests that use the assets in the source tree switch to it first
+ */
+namespace testing {
+
+/** \brief Switches the working directory to the root of the source tree for as long as it is alive */
+class AssetDir {
+public:
+    AssetDir() : m_prev{std::filesystem::current_path()} {
+        std::filesystem::current_path(BuildOpts::source_dir);
+    }
+
+    AssetDir(AssetDir const&) = delete;
+    AssetDir& operator=(AssetDir const&) = delete;
+
+    ~AssetDir() {
+        std::error_code err{};
+        std::filesystem::current_path(this->m_prev, err);
+    }
+private:
+    std::filesystem::path m_prev;
+};
+
+/** \brief Path of the example board in the source tree's assets, relative to the root of the source tree */
+static constexpr const std::string_view BOARD = "assets/boards/board.json";
+
+/** \brief Load the example board into a graph that is not saved back when destroyed, an `AssetDir` must be alive */
+inline BoardGraph asset_board() {
+    return BoardGraph{std::filesystem::path{BOARD}, false, false};
+}
+
+/**
+ * \brief Run `fn` once for a benchmark, returning its result together with the wall time it took in microseconds.
+ * The result should depend on all of the measured work so that the compiler cannot drop it
+ */
+template<typename F>
+std::pair<std::invoke_result_t<F>, std::int64_t> timed(F&& fn) {
+    const auto start = std::chrono::steady_clock::now();
+    auto result = std::forward<F>(fn)();
+    const auto dur = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    return {std::move(result), static_cast<std::int64_t>(dur.count())};
+}
+
+}
@@ -0,0 +1,171 @@
+#include "arena.hpp"
+#include <doctest.h>
+#include <testing.hpp>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+TEST_CASE("Arena") {
+    Arena<std::string, 4> arena{};
+    std::vector<Arena<std::string, 4>::size_type> handles{};
+    for(int i = 0; i < 10; ++i) {
+        handles.push_back(arena.emplace(std::to_string(i)));
+    }
+    std::string const *third = &arena[handles[2]];
+
+    SUBCASE("stable") {
+        for(int i = 0; i < 100; ++i) { arena.emplace("filler"); }
+        CHECK_MESSAGE(third == &arena[handles[2]], "Arena moved an element after insertion");
+    }
+    SUBCASE("erase") {
+        arena.erase(handles[1]);
+        arena.erase(handles[5]);
+        CHECK_EQ(arena.size(), 8);
+        CHECK_FALSE(arena.contains(handles[1]));
+        CHECK_THROWS(arena.erase(handles[1]));
+        auto reused = arena.emplace("reused");
+        CHECK_MESSAGE(reused == handles[5], "Arena does not reuse free slots");
+    }
+    SUBCASE("throwing constructor") {
+        struct Throws {
+            explicit Throws(bool fail) {
+                if(fail) {
+                    throw std::runtime_error{"constructor failed"};
+                }
+            }
+        };
+        Arena<Throws, 4> throwing{};
+        auto first = throwing.emplace(false);
+        CHECK_THROWS_AS(throwing.emplace(true), std::runtime_error);
+        CHECK_EQ(throwing.slots(), 1);
+        auto appended = throwing.emplace(false);
+        CHECK_EQ(appended, first + 1);
+
+        throwing.erase(first);
+        CHECK_THROWS_AS(throwing.emplace(true), std::runtime_error);
+        CHECK_EQ(throwing.size(), 1);
+        CHECK_MESSAGE(throwing.emplace(false) == first, "A free slot was lost to a throwing constructor");
+        CHECK_EQ(throwing.size(), 2);
+    }
+    SUBCASE("generations") {
+        auto handle = arena.handle(handles[3]);
+        CHECK(arena.contains(handle));
+        CHECK_EQ(arena.get(handle), &arena[handles[3]]);
+        arena.erase(handles[3]);
+        auto reused = arena.emplace("reused");
+        CHECK_EQ(reused, handles[3]);
+        CHECK_FALSE_MESSAGE(arena.contains(handle), "A handle to an erased element still resolves after its slot is reused");
+        CHECK_EQ(arena.get(handle), nullptr);
+        CHECK(arena.contains(arena.handle(reused)));
+    }
+    SUBCASE("retire") {
+        auto handle = arena.handle(handles[4]);
+        arena.retire(handles[4]);
+        CHECK_EQ(arena.size(), 9);
+        CHECK_FALSE(arena.contains(handles[4]));
+        CHECK_FALSE(arena.contains(handle));
+        CHECK(arena.retired(handles[4]));
+        CHECK_THROWS(arena.retire(handles[4]));
+        CHECK_THROWS(arena.erase(handles[4]));
+        CHECK_THROWS(arena.release(handles[5]));
+
+        auto added = arena.emplace("added");
+        CHECK_MESSAGE(added != handles[4], "Arena reused the slot of a retired element");
+        CHECK_EQ(arena[handles[4]], "4");
+        for(auto it = arena.cbegin(); it != arena.cend(); ++it) {
+            CHECK_NE(it.index(), handles[4]);
+        }
+        CHECK_FALSE(arena.snapshot().contains(handles[4]));
+
+        arena.release(handles[4]);
+        CHECK_FALSE(arena.retired(handles[4]));
+        CHECK_EQ(arena.size(), 10);
+        CHECK_EQ(arena.emplace("reused"), handles[4]);
+    }
+    SUBCASE("iterate") {
+        arena.erase(handles[0]);
+        arena.erase(handles[9]);
+        std::size_t count = 0;
+        for(auto it = arena.cbegin(); it != arena.cend(); ++it) {
+            CHECK_EQ(*it, std::to_string(it.index()));
+            count += 1;
+        }
+        CHECK_EQ(count, 8);
+    }
+    SUBCASE("snapshot") {
+        auto first = arena.snapshot();
+        arena.at(handles[1]) = "changed";
+        arena.touch(handles[1]);
+        arena.erase(handles[9]);
+        auto added = arena.emplace("added");
+        CHECK_EQ(first.at(handles[1]), "1");
+        CHECK_EQ(first.at(handles[9]), "9");
+        CHECK_FALSE_MESSAGE(first.contains(arena.handle(added)), "Snapshot sees an element added after it was taken");
+        CHECK_EQ(first.size(), 10);
+
+        auto second = arena.snapshot();
+        CHECK_EQ(second.at(handles[1]), "changed");
+        CHECK_EQ(second.at(added), "added");
+        CHECK(second.contains(arena.handle(added)));
+        CHECK_EQ(second.size(), 10);
+        CHECK_MESSAGE(&first[handles[5]] == &second[handles[5]], "Snapshot copied a chunk that was not modified");
+        CHECK_NE(&first[handles[1]], &second[handles[1]]);
+
+        std::size_t count = 0;
+        for(auto it = second.begin(); it != second.end(); ++it) {
+            CHECK_EQ(*it, arena[it.index()]);
+            count += 1;
+        }
+        CHECK_EQ(count, 10);
+    }
+}
+
+TEST_CASE("Arena handle resolution benchmark" * doctest::skip()) {
+    //Compare resolving wire endpoints through generational handles against locking weak pointers
+    constexpr std::size_t ELEMENTS = 100000;
+    constexpr std::size_t LOOKUPS = 1000000;
+    struct Elem { std::uint64_t val; };
+
+    std::shared_ptr<Arena<Elem>> arena{new Arena<Elem>{}};
+    std::vector<ArenaHandle<Elem>> handles{};
+    //Each element gets its own allocation and control block, as graph elements did before they moved into arenas
+    std::vector<std::shared_ptr<Elem>> owners{};
+    std::vector<std::weak_ptr<Elem>> weaks{};
+    for(std::size_t i = 0; i < ELEMENTS; ++i) {
+        auto pos = arena->emplace(Elem{i});
+        handles.push_back(arena->handle(pos));
+        owners.emplace_back(new Elem{i});
+        weaks.emplace_back(owners.back());
+    }
+
+    std::mt19937 rng{1280};
+    std::uniform_int_distribution<std::size_t> dist{0, ELEMENTS - 1};
+    std::vector<std::size_t> order(LOOKUPS);
+    for(auto& idx : order) {
+        idx = dist(rng);
+    }
+
+    auto [weak_sum, weak_us] = testing::timed([&]() {
+        std::uint64_t sum = 0;
+        for(std::size_t idx : order) {
+            if(auto elem = weaks[idx].lock()) {
+                sum += elem->val;
+            }
+        }
+        return sum;
+    });
+    auto [handle_sum, handle_us] = testing::timed([&]() {
+        std::uint64_t sum = 0;
+        for(std::size_t idx : order) {
+            if(const Elem *elem = std::as_const(*arena).get(handles[idx])) {
+                sum += elem->val;
+            }
+        }
+        return sum;
+    });
+
+    CHECK_EQ(weak_sum, handle_sum);
+    MESSAGE("weak_ptr lock: " << weak_us << "us, generational handle: " << handle_us << "us");
+}
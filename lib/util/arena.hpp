@@ -0,0 +1,394 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <variant>
+#include <vector>
+#include <assert.h>
+
+/**
+ * \brief Handle to an element of an `Arena<T>` that records the generation of the slot it refers to, so that a handle
+ * to an erased element is detected by a single compare instead of silently referring to the slot's next occupant
+ */
+template<typename T>
+struct ArenaHandle {
+    /** \brief Index of the slot in the arena */
+    std::uint32_t index{std::numeric_limits<std::uint32_t>::max()};
+    /** \brief Number of times the slot had been erased when this handle was created */
+    std::uint32_t generation{0};
+
+    constexpr inline bool operator==(ArenaHandle const& other) const noexcept = default;
+};
+
+/**
+ * \brief `FreeList`-style container that stores its elements in fixed-size chunks, so that elements are
+ * never moved once placed. Elements are addressed by a compact 32-bit handle that stays valid until the
+ * element is erased, and iteration is a linear scan over densely packed slots
+ *
+ * An element that is still referenced from outside the arena can be retired instead of erased. A retired element
+ * is no longer part of the arena but stays constructed in its slot until it is released, so that the slot is not
+ * handed to a new element while the old one is in use.
+ *
+ * Immutable snapshots of an arena can be taken with `snapshot`. Each snapshot holds read-only copies of the
+ * chunks, and a chunk that has not been modified since the previous snapshot is shared with it instead of being
+ * copied again. Elements modified in place must be reported with `touch` for this to work. An element type that
+ * links back into the structure holding the arena can define a `freeze` method, which is called on every element
+ * copied into a snapshot to cut those links
+ * \tparam T Type of element to store
+ * \tparam CHUNK_SIZE Number of slots allocated at once, must be a power of two
+ */
+template<typename T, std::size_t CHUNK_SIZE = 256>
+class Arena {
+    static_assert((CHUNK_SIZE & (CHUNK_SIZE - 1)) == 0, "Arena chunk size must be a power of two");
+public:
+    using value = T;
+    using reference = T&;
+    using const_reference = T const&;
+    using size_type = std::uint32_t;
+
+    /** \brief A handle value reserved for indicating an invalid handle */
+    static constexpr const size_type npos = std::numeric_limits<size_type>::max();
+
+private:
+    /** \brief Marker stored in a free slot that points to the next free slot */
+    struct Next { size_type next; };
+
+    /** \brief Slots hold either a live element or a link in the list of free slots */
+    using Slot = std::variant<Next, T>;
+
+    /** \brief A single block of slots, allocated all at once and never reallocated */
+    struct Chunk {
+        std::array<Slot, CHUNK_SIZE> slots;
+        /** \brief Number of times each slot has been erased or retired */
+        std::array<size_type, CHUNK_SIZE> generations{};
+        /** \brief If each slot holds a retired element that has not been released yet */
+        std::array<bool, CHUNK_SIZE> retired{};
+    };
+
+    inline constexpr Slot& slot(size_type pos) {
+        assert(pos < this->m_len);
+        return this->m_chunks[pos / CHUNK_SIZE]->slots[pos % CHUNK_SIZE];
+    }
+    inline constexpr Slot const& slot(size_type pos) const {
+        assert(pos < this->m_len);
+        return this->m_chunks[pos / CHUNK_SIZE]->slots[pos % CHUNK_SIZE];
+    }
+    inline constexpr size_type generation(size_type pos) const {
+        assert(pos < this->m_len);
+        return this->m_chunks[pos / CHUNK_SIZE]->generations[pos % CHUNK_SIZE];
+    }
+    inline constexpr bool& retired_flag(size_type pos) {
+        assert(pos < this->m_len);
+        return this->m_chunks[pos / CHUNK_SIZE]->retired[pos % CHUNK_SIZE];
+    }
+
+public:
+    class Snapshot;
+
+    Arena() = default;
+    Arena(Arena&& other) = default;
+    Arena& operator=(Arena&& other) = default;
+
+    /** \brief Check if the given handle refers to a live element of this `Arena` */
+    inline constexpr bool contains(size_type pos) const noexcept {
+        return pos < this->m_len && std::holds_alternative<T>(this->slot(pos)) && !this->retired(pos);
+    }
+
+    /** \brief Check if the slot at the given position holds a retired element that has not been released */
+    inline constexpr bool retired(size_type pos) const noexcept {
+        return pos < this->m_len && this->m_chunks[pos / CHUNK_SIZE]->retired[pos % CHUNK_SIZE];
+    }
+
+    /** \brief Check if the given generational handle still refers to the element it was created for */
+    inline constexpr bool contains(ArenaHandle<T> handle) const noexcept {
+        return this->contains(handle.index) && this->generation(handle.index) == handle.generation;
+    }
+
+    /** \brief Get a generational handle to the live element at the given position */
+    inline constexpr ArenaHandle<T> handle(size_type pos) const noexcept {
+        assert(this->contains(pos));
+        return ArenaHandle<T>{.index = pos, .generation = this->generation(pos)};
+    }
+
+    /**
+     * \brief Resolve a generational handle
+     * \return A pointer to the element, or nullptr if the element the handle was created for has been erased
+     */
+    inline constexpr T* get(ArenaHandle<T> handle) noexcept {
+        return this->contains(handle) ? &std::get<T>(this->slot(handle.index)) : nullptr;
+    }
+    inline constexpr T const* get(ArenaHandle<T> handle) const noexcept {
+        return this->contains(handle) ? &std::get<T>(this->slot(handle.index)) : nullptr;
+    }
+
+    /**
+     * \brief Get the element with the given handle, if the element has already been erased this is UB
+     */
+    inline constexpr reference at(size_type pos) { return std::get<T>(this->slot(pos)); }
+    inline constexpr const_reference at(size_type pos) const { return std::get<T>(this->slot(pos)); }
+    inline constexpr reference operator[](size_type pos) { return this->at(pos); }
+    inline constexpr const_reference operator[](size_type pos) const { return this->at(pos); }
+
+    /** \brief Get the number of live elements in this `Arena` */
+    inline constexpr size_type size() const noexcept { return this->m_count; }
+    /** \brief Check if this `Arena` contains no live elements */
+    inline constexpr bool empty() const noexcept { return this->m_count == 0; }
+    /** \brief Get the number of slots in use or on the free list, one past the highest handle ever returned */
+    inline constexpr size_type slots() const noexcept { return this->m_len; }
+    /** \brief Get the number of slots that can be filled before another chunk must be allocated */
+    inline constexpr std::size_t capacity() const noexcept { return this->m_chunks.size() * CHUNK_SIZE; }
+
+    /**
+     * \brief Allocate enough chunks up front to hold `n` elements without further allocation
+     */
+    void reserve(std::size_t n) {
+        if(n > npos) {
+            throw std::length_error{"Arena cannot hold more elements than its handle type can address"};
+        }
+        while(this->capacity() < n) {
+            this->m_chunks.push_back(std::make_unique<Chunk>());
+            this->m_frozen.emplace_back();
+        }
+    }
+
+    /**
+     * \brief Construct an instance of `T` in place from the given arguments, reusing a free slot if one exists
+     * \return Handle of the added element
+     */
+    template<typename... Args>
+    requires(std::constructible_from<T, Args...>)
+    size_type emplace(Args&&... args) {
+        //The free list and length only advance once `T` is constructed, so a throwing constructor loses no slot
+        if(this->m_free != npos) {
+            const size_type pos = this->m_free;
+            const Next free = std::get<Next>(this->slot(pos));
+            try {
+                this->slot(pos).template emplace<T>(std::forward<Args>(args)...);
+            } catch(...) {
+                this->slot(pos).template emplace<Next>(free);
+                throw;
+            }
+            this->m_free = free.next;
+            this->touch(pos);
+            this->m_count += 1;
+            return pos;
+        }
+
+        if(this->m_len == npos) {
+            throw std::length_error{"Arena handle space exhausted"};
+        }
+        this->reserve(static_cast<std::size_t>(this->m_len) + 1);
+        const size_type pos = this->m_len;
+        this->m_chunks[pos / CHUNK_SIZE]->slots[pos % CHUNK_SIZE].template emplace<T>(std::forward<Args>(args)...);
+        this->m_len += 1;
+        this->touch(pos);
+        this->m_count += 1;
+        return pos;
+    }
+
+    /**
+     * \brief Destroy the element with the given handle, making the slot available for reuse
+     * \throws std::runtime_error if the element was already erased
+     */
+    void erase(size_type pos) {
+        if(!this->contains(pos)) {
+            throw std::runtime_error{"Attempt to erase element from Arena twice"};
+        }
+        this->slot(pos).template emplace<Next>(Next{this->m_free});
+        this->m_chunks[pos / CHUNK_SIZE]->generations[pos % CHUNK_SIZE] += 1;
+        this->touch(pos);
+        this->m_free = pos;
+        this->m_count -= 1;
+    }
+
+    /**
+     * \brief Remove the element with the given handle from the arena without destroying it. The element stays at
+     * the same address but is skipped by iteration, and handles to it no longer resolve. The slot is not reused
+     * until `release` is called
+     * \throws std::runtime_error if the element was already erased or retired
+     */
+    void retire(size_type pos) {
+        if(!this->contains(pos)) {
+            throw std::runtime_error{"Attempt to retire element from Arena that is not live"};
+        }
+        this->retired_flag(pos) = true;
+        this->m_chunks[pos / CHUNK_SIZE]->generations[pos % CHUNK_SIZE] += 1;
+        this->touch(pos);
+        this->m_count -= 1;
+    }
+
+    /**
+     * \brief Destroy a retired element, making its slot available for reuse
+     * \throws std::runtime_error if the slot does not hold a retired element
+     */
+    void release(size_type pos) {
+        if(!this->retired(pos)) {
+            throw std::runtime_error{"Attempt to release element from Arena that was not retired"};
+        }
+        this->slot(pos).template emplace<Next>(Next{this->m_free});
+        this->retired_flag(pos) = false;
+        this->touch(pos);
+        this->m_free = pos;
+    }
+
+    /**
+     * \brief Record that the element at the given position was modified in place, so that the next snapshot
+     * copies it again instead of sharing the copy made by an earlier snapshot
+     */
+    inline void touch(size_type pos) noexcept {
+        assert(pos < this->m_len);
+        this->m_frozen[pos / CHUNK_SIZE].reset();
+    }
+
+    /**
+     * \brief Take an immutable snapshot of this arena. Only the chunks touched since the previous snapshot are
+     * copied, the rest are shared with snapshots that are still alive
+     */
+    Snapshot snapshot() {
+        Snapshot snap{};
+        snap.m_chunks.reserve(this->m_chunks.size());
+        for(std::size_t i = 0; i < this->m_chunks.size(); ++i) {
+            std::shared_ptr<const Chunk> chunk = this->m_frozen[i].lock();
+            if(chunk == nullptr) {
+                auto copy = std::make_shared<Chunk>(*this->m_chunks[i]);
+                if constexpr(requires(T& elem) { elem.freeze(); }) {
+                    for(Slot& slot : copy->slots) {
+                        if(T *elem = std::get_if<T>(&slot)) {
+                            elem->freeze();
+                        }
+                    }
+                }
+                chunk = std::move(copy);
+                this->m_frozen[i] = chunk;
+            }
+            snap.m_chunks.push_back(std::move(chunk));
+        }
+        snap.m_len = this->m_len;
+        snap.m_count = this->m_count;
+        return snap;
+    }
+
+    /**
+     * \brief Iterator over all live elements of an `Arena` or snapshot in handle order
+     * \tparam Owner Type of the container iterated over, const qualified for a const iterator
+     */
+    template<typename Owner>
+    struct IteratorBase {
+    public:
+        static constexpr const bool CONST = std::is_const_v<Owner>;
+        using arena_type = Owner;
+        using iterator_category = std::forward_iterator_tag;
+        using difference_type = std::ptrdiff_t;
+        using value_type = T;
+        using pointer = std::conditional_t<CONST, T const*, T*>;
+        using reference = std::conditional_t<CONST, T const&, T&>;
+
+        constexpr IteratorBase() = default;
+        constexpr IteratorBase(arena_type *arena, size_type pos) : m_arena{arena}, m_pos{pos} { this->skip(); }
+
+        constexpr reference operator*() const { return this->m_arena->at(this->m_pos); }
+        constexpr pointer operator->() const { return std::addressof(this->m_arena->at(this->m_pos)); }
+        constexpr IteratorBase& operator++() {
+            this->m_pos += 1;
+            this->skip();
+            return *this;
+        }
+        constexpr IteratorBase operator++(int) {
+            IteratorBase tmp{*this};
+            ++(*this);
+            return tmp;
+        }
+
+        constexpr inline bool operator==(IteratorBase const& other) const noexcept { return this->m_pos == other.m_pos; }
+        constexpr inline bool operator!=(IteratorBase const& other) const noexcept { return this->m_pos != other.m_pos; }
+
+        /** \brief Get the handle of the element this iterator points to */
+        inline constexpr size_type index() const noexcept { return this->m_pos; }
+    private:
+        arena_type *m_arena{nullptr};
+        size_type m_pos{0};
+
+        /** \brief Advance to the next live element, or to the end of the used slots */
+        constexpr void skip() {
+            while(this->m_pos < this->m_arena->slots() && !this->m_arena->contains(this->m_pos)) {
+                this->m_pos += 1;
+            }
+        }
+    };
+
+    using iterator = IteratorBase<Arena>;
+    using const_iterator = IteratorBase<Arena const>;
+
+    inline constexpr iterator begin() noexcept { return iterator{this, 0}; }
+    inline constexpr iterator end() noexcept { return iterator{this, this->m_len}; }
+    inline constexpr const_iterator begin() const noexcept { return const_iterator{this, 0}; }
+    inline constexpr const_iterator end() const noexcept { return const_iterator{this, this->m_len}; }
+    inline constexpr const_iterator cbegin() const noexcept { return this->begin(); }
+    inline constexpr const_iterator cend() const noexcept { return this->end(); }
+
+    /**
+     * \brief Read-only copy of an `Arena` made by `Arena::snapshot`. Snapshots never change after they are made, so
+     * any number of threads may read one while the arena it was taken from is being modified
+     */
+    class Snapshot {
+    public:
+        /** \brief Create a snapshot of an empty arena */
+        Snapshot() = default;
+
+        inline constexpr bool contains(size_type pos) const noexcept {
+            return pos < this->m_len && std::holds_alternative<T>(this->slot(pos)) && !this->m_chunks[pos / CHUNK_SIZE]->retired[pos % CHUNK_SIZE];
+        }
+        inline constexpr bool contains(ArenaHandle<T> handle) const noexcept {
+            return this->contains(handle.index) && this->m_chunks[handle.index / CHUNK_SIZE]->generations[handle.index % CHUNK_SIZE] == handle.generation;
+        }
+        /** \brief Resolve a generational handle, returning nullptr if the element had been erased when the snapshot was taken */
+        inline constexpr T const* get(ArenaHandle<T> handle) const noexcept {
+            return this->contains(handle) ? &std::get<T>(this->slot(handle.index)) : nullptr;
+        }
+        /** \brief Get the element with the given handle, if the element had been erased this is UB */
+        inline constexpr const_reference at(size_type pos) const { return std::get<T>(this->slot(pos)); }
+        inline constexpr const_reference operator[](size_type pos) const { return this->at(pos); }
+
+        inline constexpr size_type size() const noexcept { return this->m_count; }
+        inline constexpr bool empty() const noexcept { return this->m_count == 0; }
+        inline constexpr size_type slots() const noexcept { return this->m_len; }
+
+        using const_iterator = IteratorBase<Snapshot const>;
+        inline constexpr const_iterator begin() const noexcept { return const_iterator{this, 0}; }
+        inline constexpr const_iterator end() const noexcept { return const_iterator{this, this->m_len}; }
+    private:
+        std::vector<std::shared_ptr<const Chunk>> m_chunks{};
+        size_type m_len{0};
+        size_type m_count{0};
+
+        inline constexpr Slot const& slot(size_type pos) const {
+            assert(pos < this->m_len);
+            return this->m_chunks[pos / CHUNK_SIZE]->slots[pos % CHUNK_SIZE];
+        }
+
+        friend class Arena;
+    };
+
+
+    ~Arena() = default;
+private:
+    /** \brief Fixed-size blocks of slots, the chunks themselves never move */
+    std::vector<std::unique_ptr<Chunk>> m_chunks{};
+    /**
+     * \brief Copy of each chunk made by the last snapshot, reset whenever the chunk is modified. Held weakly so that
+     * a copy is freed along with the last snapshot using it
+     */
+    std::vector<std::weak_ptr<const Chunk>> m_frozen{};
+    /** \brief Number of slots that have ever been handed out */
+    size_type m_len{0};
+    /** \brief Number of live elements */
+    size_type m_count{0};
+    /** \brief Handle of the first free slot */
+    size_type m_free{npos};
+};
@@ -0,0 +1,24 @@
+#include "bytes.hpp"
+#include <doctest.h>
+#include <array>
+
+TEST_CASE("ByteWriter") {
+    struct Pod { std::uint8_t tag; float val; };
+    std::vector<std::byte> buf{};
+    ByteWriter writer{buf};
+    writer.write(Pod{.tag = 3, .val = 1.5f});
+    writer.write(std::string_view{"bytes"});
+    const std::array<std::int32_t, 3> vals{-1, 0, 7};
+    writer.write(std::span<const std::int32_t>{vals});
+    writer.write(std::string_view{});
+
+    ByteReader reader{buf};
+    Pod pod = reader.read<Pod>();
+    CHECK_EQ(pod.tag, 3);
+    CHECK_EQ(pod.val, 1.5f);
+    CHECK_EQ(reader.read_string(), "bytes");
+    CHECK_EQ(reader.read_array<std::int32_t>(), std::vector<std::int32_t>{-1, 0, 7});
+    CHECK(reader.read_string().empty());
+    CHECK(reader.done());
+    CHECK_THROWS_AS(reader.read<std::uint8_t>(), std::out_of_range);
+}
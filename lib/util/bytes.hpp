@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+/**
+ * \brief Appends trivially copyable values, strings, and arrays to a byte buffer in their in-memory
+ * representation, the buffer is only meant to be read back by a `ByteReader` in the same process
+ */
+class ByteWriter {
+public:
+    /** \brief Create a writer that appends to the given buffer */
+    explicit ByteWriter(std::vector<std::byte>& out) : m_out{out} {}
+
+    /** \brief Append the bytes of a single value */
+    template<typename T>
+    requires(std::is_trivially_copyable_v<T>)
+    inline void write(T const& val) {
+        const std::size_t pos = this->m_out.size();
+        this->m_out.resize(pos + sizeof(T));
+        std::memcpy(this->m_out.data() + pos, &val, sizeof(T));
+    }
+
+    /** \brief Append a length-prefixed array of values */
+    template<typename T>
+    requires(std::is_trivially_copyable_v<T>)
+    inline void write(std::span<const T> vals) {
+        this->write(length(vals.size()));
+        const std::size_t pos = this->m_out.size();
+        this->m_out.resize(pos + vals.size_bytes());
+        if(!vals.empty()) {
+            std::memcpy(this->m_out.data() + pos, vals.data(), vals.size_bytes());
+        }
+    }
+
+    /** \brief Append a length-prefixed string */
+    inline void write(std::string_view str) { this->write(std::span<const char>{str.data(), str.size()}); }
+private:
+    std::vector<std::byte>& m_out;
+
+    /** \throws std::length_error if an array is too long for its length prefix */
+    static inline std::uint32_t length(std::size_t len) {
+        if(len > std::numeric_limits<std::uint32_t>::max()) {
+            throw std::length_error{"Array is too long to be written to a byte buffer"};
+        }
+        return static_cast<std::uint32_t>(len);
+    }
+};
+
+/** \brief Reads values back out of a buffer written by `ByteWriter`, in the order they were written */
+class ByteReader {
+public:
+    explicit ByteReader(std::span<const std::byte> in) : m_in{in} {}
+
+    /**
+     * \brief Read a single value
+     * \throws std::out_of_range if the buffer ends before the value does
+     */
+    template<typename T>
+    requires(std::is_trivially_copyable_v<T> && std::is_default_constructible_v<T>)
+    inline T read() {
+        T val{};
+        std::memcpy(&val, this->take(sizeof(T)), sizeof(T));
+        return val;
+    }
+
+    /** \brief Read a length-prefixed array of values written with `ByteWriter::write(std::span)` */
+    template<typename T>
+    requires(std::is_trivially_copyable_v<T>)
+    inline std::vector<T> read_array() {
+        const std::uint32_t len = this->read<std::uint32_t>();
+        std::vector<T> vals(len);
+        if(len != 0) {
+            std::memcpy(vals.data(), this->take(len * sizeof(T)), len * sizeof(T));
+        }
+        return vals;
+    }
+
+    /** \brief Read a length-prefixed string, the returned view points into the buffer being read */
+    inline std::string_view read_string() {
+        const std::uint32_t len = this->read<std::uint32_t>();
+        return std::string_view{reinterpret_cast<const char*>(this->take(len)), len};
+    }
+
+    /** \brief Get the offset of the next byte to be read */
+    inline constexpr std::size_t pos() const noexcept { return this->m_pos; }
+    /** \brief Check if every byte of the buffer has been read */
+    inline constexpr bool done() const noexcept { return this->m_pos == this->m_in.size(); }
+private:
+    std::span<const std::byte> m_in;
+    std::size_t m_pos{0};
+
+    inline std::byte const* take(std::size_t len) {
+        if(this->m_in.size() - this->m_pos < len) {
+            throw std::out_of_range{"Attempt to read past the end of a byte buffer"};
+        }
+        std::byte const *data = this->m_in.data() + this->m_pos;
+        this->m_pos += len;
+        return data;
+    }
+};
@@ -0,0 +1,21 @@
+#include "disjoint.hpp"
+#include <doctest.h>
+
+TEST_CASE("DisjointSet") {
+    DisjointSet sets{8};
+    CHECK_EQ(sets.sets(), 8);
+
+    CHECK(sets.unite(0, 1));
+    CHECK(sets.unite(2, 3));
+    CHECK(sets.unite(1, 3));
+    CHECK_FALSE_MESSAGE(sets.unite(0, 2), "Uniting two members of the same set should not merge anything");
+    CHECK(sets.same(0, 3));
+    CHECK_FALSE(sets.same(0, 4));
+    CHECK_EQ(sets.set_size(2), 4);
+    CHECK_EQ(sets.sets(), 5);
+
+    auto added = sets.add();
+    CHECK_EQ(added, 8);
+    CHECK_EQ(sets.set_size(added), 1);
+    CHECK_EQ(std::as_const(sets).find(0), sets.find(3));
+}
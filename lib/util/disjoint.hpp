@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include <assert.h>
+
+/**
+ * \brief Union-find structure over the dense range of elements `[0, size())`, merging sets by size and halving
+ * paths on every lookup so that any sequence of operations runs in near-linear time
+ */
+class DisjointSet {
+public:
+    using size_type = std::uint32_t;
+
+    /** \brief Create an empty set of sets */
+    DisjointSet() = default;
+
+    /** \brief Create `n` singleton sets, one per element */
+    explicit DisjointSet(size_type n) : m_parent(n), m_size(n, 1), m_sets{n} {
+        std::iota(this->m_parent.begin(), this->m_parent.end(), size_type{0});
+    }
+
+    /**
+     * \brief Add a new element in its own singleton set
+     * \return The index of the added element
+     * \throws std::length_error if the element index would overflow `size_type`
+     */
+    inline size_type add() {
+        if(this->m_parent.size() >= std::numeric_limits<size_type>::max()) {
+            throw std::length_error{"DisjointSet cannot hold more elements than its index type can address"};
+        }
+        const size_type idx = static_cast<size_type>(this->m_parent.size());
+        this->m_parent.push_back(idx);
+        this->m_size.push_back(1);
+        this->m_sets += 1;
+        return idx;
+    }
+
+    /** \brief Get the representative element of the set that `x` belongs to, compressing the path walked */
+    inline size_type find(size_type x) noexcept {
+        assert(x < this->m_parent.size());
+        while(this->m_parent[x] != x) {
+            this->m_parent[x] = this->m_parent[this->m_parent[x]];
+            x = this->m_parent[x];
+        }
+        return x;
+    }
+
+    /** \brief Get the representative element of the set that `x` belongs to without modifying the structure */
+    inline size_type find(size_type x) const noexcept {
+        assert(x < this->m_parent.size());
+        while(this->m_parent[x] != x) {
+            x = this->m_parent[x];
+        }
+        return x;
+    }
+
+    /**
+     * \brief Merge the sets containing `a` and `b`
+     * \return false if `a` and `b` were already members of the same set
+     */
+    inline bool unite(size_type a, size_type b) noexcept {
+        a = this->find(a);
+        b = this->find(b);
+        if(a == b) {
+            return false;
+        }
+        if(this->m_size[a] < this->m_size[b]) {
+            std::swap(a, b);
+        }
+        this->m_parent[b] = a;
+        this->m_size[a] += this->m_size[b];
+        this->m_sets -= 1;
+        return true;
+    }
+
+    /** \brief Check if `a` and `b` are members of the same set */
+    inline bool same(size_type a, size_type b) noexcept { return this->find(a) == this->find(b); }
+
+    /** \brief Get the number of elements in the set containing `x` */
+    inline size_type set_size(size_type x) noexcept { return this->m_size[this->find(x)]; }
+
+    /** \brief Get the number of elements in all sets */
+    inline size_type size() const noexcept { return static_cast<size_type>(this->m_parent.size()); }
+    /** \brief Get the number of distinct sets */
+    inline size_type sets() const noexcept { return this->m_sets; }
+private:
+    /** \brief Parent of each element, roots are their own parent */
+    std::vector<size_type> m_parent{};
+    /** \brief Number of elements in the set rooted at each element, only meaningful for roots */
+    std::vector<size_type> m_size{};
+    /** \brief Number of distinct sets */
+    size_type m_sets{0};
+};
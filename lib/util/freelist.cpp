@@ -10,4 +10,15 @@ TEST_CASE("FreeList") {
     auto placed = list.emplace(12);
     CHECK_MESSAGE(placed == first, "List does not emplace items in empty slots");
     CHECK(list.at(1) == 14);
+
+    SUBCASE("iterate") {
+        list.erase(placed);
+        list.emplace(20);
+        std::vector<int> seen{};
+        for(auto it = list.cbegin(); it != list.cend(); ++it) {
+            CHECK_EQ(*it, list.at(it.index()));
+            seen.push_back(*it);
+        }
+        CHECK_MESSAGE(seen.size() == 2, "FreeList iteration does not visit every occupied slot exactly once");
+    }
 }
@@ -73,6 +73,9 @@ public:
      * \brief Get the number of elements in this `FreeList`, *not* the size including free slots
      */
     inline constexpr size_type size() const { return this->m_vec.size() - this->free_slots(); }
+
+    /** \brief Get the number of slots in this list including free slots, every valid index is less than this */
+    inline constexpr size_type slots() const noexcept { return this->m_vec.size(); }
     
     /**
      * \brief Construct an instance of `T` in place from the given arguments
@@ -85,7 +88,7 @@ public:
     size_type emplace(Args&&... args) {
         if(this->free != npos) {
             size_t free_pos = this->free;
-            assert(free_pos < this->size());
+            assert(free_pos < this->m_vec.size());
             this->free = std::get<Next>(this->m_vec[this->free]).next;
             //new (&this->m_vec[free_pos]) T(std::forward<Args>(args)...);
             this->m_vec[free_pos].template emplace<T>(std::forward<Args>(args)...);
@@ -129,24 +132,17 @@ public:
             return this->m_iter - other.m_iter;
         }
 
-        constexpr Iterator(Iter const& iter, Iter const& end, size_type idx = 0) : m_iter{iter}, m_end{end}, m_idx{idx} {}
+        constexpr Iterator(Iter const& iter, Iter const& end, size_type idx = 0) : m_iter{iter}, m_end{end}, m_idx{idx} { this->skip(); }
         constexpr reference operator*() const { return std::get<T>(*this->m_iter); }
         constexpr pointer operator->() const { return std::addressof(std::get<T>(*this->m_iter)); }
         constexpr Iterator& operator++() {
-            Iter current = this->m_iter;
-            while(current != this->m_end && std::visit(_detail::Visitor {
-                    [](T const &) { return false; },
-                    [](auto const) { return true; }
-                }, *current
-            )) {
-                    current++;
-                    this->m_idx += 1;
-            }
-            this->m_iter = current;
+            this->m_iter++;
+            this->m_idx += 1;
+            this->skip();
             return *this;
         }
-        constexpr Iterator& operator++(int) const {
-            Iterator tmp{this->m_iter, this->m_end};
+        constexpr Iterator operator++(int) {
+            Iterator tmp{*this};
             ++(*this);
             return tmp;
         }
@@ -162,6 +158,14 @@ public:
         Iter m_iter;
         Iter m_end;
         size_type m_idx;
+
+        /** \brief Advance past any free slots until an occupied slot or the end is reached */
+        constexpr void skip() {
+            while(this->m_iter != this->m_end && std::holds_alternative<Next>(*this->m_iter)) {
+                this->m_iter++;
+                this->m_idx += 1;
+            }
+        }
     };
 
 
@@ -180,24 +184,17 @@ public:
             return this->m_iter - other.m_iter;
         }
 
-        constexpr ConstIterator(Iter const& iter, Iter const& end, size_type idx = 0) : m_iter{iter}, m_end{end}, m_idx{idx} {}
+        constexpr ConstIterator(Iter const& iter, Iter const& end, size_type idx = 0) : m_iter{iter}, m_end{end}, m_idx{idx} { this->skip(); }
         constexpr reference operator*() const { return std::get<T>(*this->m_iter); }
         constexpr pointer operator->() const { return std::addressof(std::get<T>(*this->m_iter)); }
         constexpr ConstIterator& operator++() {
-            Iter current = this->m_iter;
-            while(current != this->m_end && std::visit(_detail::Visitor {
-                    [](T const&) -> bool { return false; },
-                    [](auto const) -> bool { return true; }
-                }, *current
-            )) {
-                    current++;
-                    this->m_idx += 1;
-            }
-            this->m_iter = current;
+            this->m_iter++;
+            this->m_idx += 1;
+            this->skip();
             return *this;
         }
-        constexpr ConstIterator& operator++(int) const {
-            ConstIterator tmp{this->m_iter, this->m_end};
+        constexpr ConstIterator operator++(int) {
+            ConstIterator tmp{*this};
             ++(*this);
             return tmp;
         }
@@ -214,17 +211,25 @@ public:
         Iter m_iter;
         Iter m_end;
         size_type m_idx;
+
+        /** \brief Advance past any free slots until an occupied slot or the end is reached */
+        constexpr void skip() {
+            while(this->m_iter != this->m_end && std::holds_alternative<Next>(*this->m_iter)) {
+                this->m_iter++;
+                this->m_idx += 1;
+            }
+        }
     };
 
     using iterator = Iterator;
     using const_iterator = ConstIterator;
 
     inline constexpr iterator begin() noexcept { return Iterator{this->m_vec.begin(), this->m_vec.end()}; }
-    inline constexpr iterator end() noexcept { return Iterator{this->m_vec.end(), this->m_vec.end()}; }
+    inline constexpr iterator end() noexcept { return Iterator{this->m_vec.end(), this->m_vec.end(), static_cast<size_type>(this->m_vec.size())}; }
     inline constexpr const_iterator begin() const noexcept { return ConstIterator{this->m_vec.cbegin(), this->m_vec.cend()}; }
-    inline constexpr const_iterator end() const noexcept { return ConstIterator{this->m_vec.cend(), this->m_vec.cend()}; }
+    inline constexpr const_iterator end() const noexcept { return ConstIterator{this->m_vec.cend(), this->m_vec.cend(), static_cast<size_type>(this->m_vec.size())}; }
     inline constexpr const_iterator cbegin() const noexcept { return ConstIterator{this->m_vec.cbegin(), this->m_vec.cend()}; }
-    inline constexpr const_iterator cend() const noexcept { return ConstIterator{this->m_vec.cend(), this->m_vec.cend()}; }
+    inline constexpr const_iterator cend() const noexcept { return ConstIterator{this->m_vec.cend(), this->m_vec.cend(), static_cast<size_type>(this->m_vec.size())}; }
 
 
     ~FreeList() = default;
@@ -0,0 +1,165 @@
+#include "intern.hpp"
+#include <array>
+#include <atomic>
+#include <bit>
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <thread>
+#include <vector>
+#include <doctest.h>
+
+namespace {
+
+/**
+ * \brief Global table of interned strings, strings are stored in a `std::deque` so that views into them
+ * are never invalidated by later insertions.
+ *
+ * The view of each symbol's string is also stored in a chunk table for lookups by index that take no lock. Chunk
+ * `i` holds `2^(FIRST_CHUNK_BITS + i)` views and is never moved or freed once allocated, and the array of chunk
+ * pointers has a fixed size, so a reader only needs the chunk's pointer to find the view of a symbol it was given
+ */
+struct SymbolTable {
+    static constexpr const std::size_t FIRST_CHUNK_BITS = 10;
+    /** \brief Enough chunks to address every index below `Symbol::NONE` */
+    static constexpr const std::size_t CHUNKS = std::numeric_limits<Symbol::size_type>::digits + 1 - FIRST_CHUNK_BITS;
+
+    std::shared_mutex lock{};
+    std::deque<std::string> strings{};
+    std::unordered_map<std::string_view, Symbol::size_type> index{};
+    std::array<std::atomic<std::string_view*>, CHUNKS> chunks{};
+
+    SymbolTable() {
+        this->push(std::string_view{});
+    }
+
+    ~SymbolTable() {
+        for(auto& chunk : this->chunks) {
+            delete[] chunk.load(std::memory_order_relaxed);
+        }
+    }
+
+    static SymbolTable& get() {
+        static SymbolTable TABLE{};
+        return TABLE;
+    }
+
+    /** \brief Get the chunk holding the view for a symbol index and the position of the view in that chunk */
+    static inline std::pair<std::size_t, std::size_t> locate(Symbol::size_type idx) noexcept {
+        const std::uint64_t biased = static_cast<std::uint64_t>(idx) + (std::uint64_t{1} << FIRST_CHUNK_BITS);
+        const std::size_t chunk = static_cast<std::size_t>(std::bit_width(biased)) - 1 - FIRST_CHUNK_BITS;
+        return {chunk, static_cast<std::size_t>(biased - (std::uint64_t{1} << (chunk + FIRST_CHUNK_BITS)))};
+    }
+
+    /** \brief Add a string with the next index, the write lock must be held */
+    Symbol::size_type push(std::string_view str) {
+        const Symbol::size_type idx = static_cast<Symbol::size_type>(this->strings.size());
+        const auto [chunk, pos] = locate(idx);
+        std::string_view *views = this->chunks[chunk].load(std::memory_order_relaxed);
+        if(views == nullptr) {
+            views = new std::string_view[std::size_t{1} << (chunk + FIRST_CHUNK_BITS)];
+            this->chunks[chunk].store(views, std::memory_order_release);
+        }
+        const std::string_view stored = this->strings.emplace_back(str);
+        views[pos] = stored;
+        this->index.emplace(stored, idx);
+        return idx;
+    }
+
+    /** \brief Get the string of an index returned by `push` without locking */
+    inline std::string_view at(Symbol::size_type idx) const noexcept {
+        const auto [chunk, pos] = locate(idx);
+        return this->chunks[chunk].load(std::memory_order_acquire)[pos];
+    }
+};
+
+}
+
+Symbol Symbol::intern(const std::string_view str) {
+    SymbolTable& table = SymbolTable::get();
+    {
+        std::shared_lock read{table.lock};
+        auto found = table.index.find(str);
+        if(found != table.index.end()) {
+            return Symbol{found->second};
+        }
+    }
+
+    std::unique_lock write{table.lock};
+    //Another thread may have interned the string between releasing the read lock and acquiring the write lock
+    auto found = table.index.find(str);
+    if(found != table.index.end()) {
+        return Symbol{found->second};
+    }
+    if(table.strings.size() >= NONE) {
+        throw std::length_error{"Symbol table is full"};
+    }
+    return Symbol{table.push(str)};
+}
+
+Optional<Symbol> Symbol::find(const std::string_view str) {
+    SymbolTable& table = SymbolTable::get();
+    std::shared_lock read{table.lock};
+    auto found = table.index.find(str);
+    if(found == table.index.end()) {
+        return {};
+    }
+    return Symbol{found->second};
+}
+
+std::string_view Symbol::str() const {
+    if(this->is_none()) {
+        return std::string_view{};
+    }
+    //The symbol was returned by `intern` after its view was stored, so its chunk and view are already visible
+    return SymbolTable::get().at(this->m_idx);
+}
+
+TEST_CASE("Symbol") {
+    Symbol first = Symbol::intern("symbol.test");
+    CHECK_EQ(first, Symbol::intern(std::string{"symbol"} + ".test"));
+    CHECK_NE(first, Symbol::intern("symbol.other"));
+    CHECK_EQ(first.str(), "symbol.test");
+    CHECK_EQ(Symbol::intern("").str(), "");
+    CHECK(Symbol{}.is_none());
+    CHECK(Symbol::find("symbol.test") == first);
+    CHECK_FALSE(Symbol::find("symbol.never-interned").has_value());
+
+    Symbol from_json = json("symbol.test").get<Symbol>();
+    CHECK_EQ(from_json, first);
+
+    SUBCASE("chunks") {
+        //Intern enough strings to fill several chunks, earlier views must stay valid as later chunks are added
+        std::vector<Symbol> syms{};
+        for(int i = 0; i < 5000; ++i) {
+            syms.push_back(Symbol::intern("symbol.chunk." + std::to_string(i)));
+        }
+        const std::string_view first_view = syms.front().str();
+        for(int i = 0; i < 5000; ++i) {
+            CHECK_EQ(syms[i].str(), "symbol.chunk." + std::to_string(i));
+        }
+        CHECK_EQ(first_view.data(), syms.front().str().data());
+    }
+    SUBCASE("concurrent") {
+        //Strings are resolved without locking while other threads keep adding symbols
+        std::atomic<bool> resolved{true};
+        std::vector<std::thread> threads{};
+        for(int t = 0; t < 4; ++t) {
+            threads.emplace_back([t, first, &resolved]() {
+                for(int i = 0; i < 2000; ++i) {
+                    const std::string str = "symbol.thread." + std::to_string(t) + "." + std::to_string(i);
+                    if(Symbol::intern(str).str() != str || first.str() != "symbol.test") {
+                        resolved = false;
+                    }
+                }
+            });
+        }
+        for(auto& thread : threads) {
+            thread.join();
+        }
+        CHECK(resolved);
+    }
+}
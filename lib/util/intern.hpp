@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <string>
+#include <string_view>
+
+#include "util/optional.hpp"
+
+/**
+ * \brief A string that has been interned in the global symbol table, so that every distinct string is stored
+ * exactly once and compares / hashes as a single integer. The string data of a symbol lives for the duration
+ * of the program and is guranteed to be NULL-terminated
+ * \implements ser::StringSerializable
+ * \implements Noneable
+ */
+class Symbol {
+public:
+    using size_type = std::uint32_t;
+
+    /** \brief Create an invalid symbol, as needed by `Noneable` so that an empty `Optional<Symbol>` can be default-constructed */
+    constexpr Symbol() noexcept : m_idx{NONE} {}
+
+    /**
+     * \brief Get the symbol for the given string, adding it to the symbol table if it has not been seen before
+     * \throws std::length_error if the symbol table is full
+     */
+    static Symbol intern(const std::string_view str);
+
+    /**
+     * \brief Look up the symbol for the given string without adding it to the symbol table
+     * \return An empty `Optional` if the string was never interned
+     */
+    static Optional<Symbol> find(const std::string_view str);
+
+    /**
+     * \brief Get the interned string that this symbol refers to, or an empty string if this symbol is invalid. Does
+     * not lock the symbol table, so it is cheap enough to call in sort comparators and hash functions
+     */
+    std::string_view str() const;
+
+    /** \brief Get the raw index of this symbol in the symbol table */
+    inline constexpr size_type index() const noexcept { return this->m_idx; }
+
+    inline constexpr bool operator==(const Symbol& other) const noexcept = default;
+
+    /** \brief Convert this symbol to an owned string */
+    inline std::string to_string() const { return std::string{this->str()}; }
+    /** \brief Intern the given string */
+    inline static void from_string(Symbol& self, const std::string_view str) { self = intern(str); }
+
+    /** \brief Implementing `Noneable`, check if this symbol is the invalid symbol */
+    inline constexpr bool is_none() const noexcept { return this->m_idx == NONE; }
+    /** \brief Implementing `Noneable`, make this symbol invalid */
+    inline constexpr void make_none() noexcept { this->m_idx = NONE; }
+private:
+    /** \brief Symbol index reserved for the invalid symbol */
+    static constexpr const size_type NONE = std::numeric_limits<size_type>::max();
+
+    explicit constexpr Symbol(size_type idx) noexcept : m_idx{idx} {}
+
+    /** \brief Index of the string in the global symbol table */
+    size_type m_idx;
+};
+
+static_assert(Noneable<Symbol>);
+static_assert(ser::StringSerializable<Symbol>);
+static_assert(sizeof(Optional<Symbol>) == sizeof(Symbol));
+
+template<>
+struct std::hash<Symbol> {
+    inline std::size_t operator()(const Symbol& sym) const noexcept {
+        return std::hash<Symbol::size_type>{}(sym.index());
+    }
+};
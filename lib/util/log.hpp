@@ -47,12 +47,15 @@ template<> constexpr const char * const lvl_data<LogLevel::Trace>::LVL_STR = "[T
 
 /**
  * \brief Get a thread-safe log buffer that will write messages to the global
- * output stream after all other write calls finish
+ * output stream after all other write calls finish. Messages logged before `init` is called are dropped
  */ 
 template<LogLevel lvl>
 void log(fmt::string_view fmt, fmt::format_args args) {
     if constexpr(lvl != LogLevel::Trace || BuildOpts::should_log_trace()) {
         std::lock_guard lock{_detail::log_lock};
+        if(_detail::log_stream == nullptr) {
+            return;
+        }
         fmt::print(_detail::log_stream.get(), _detail::lvl_data<lvl>::LVL_STR);
         fmt::vprint(_detail::log_stream.get(), fmt, args);
         fmt::print(_detail::log_stream.get(), "\n");
@@ -0,0 +1,111 @@
+#include "mapped.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <utility>
+
+#include <doctest.h>
+#include <fmt/format.h>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define MAPPED_FILE_MMAP 1
+#endif
+
+MappedFile::MappedFile(std::filesystem::path const& path) {
+#if defined(MAPPED_FILE_MMAP)
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if(fd < 0) {
+        throw std::runtime_error{fmt::format("Failed to open {}: {}", path.c_str(), std::strerror(errno))};
+    }
+    struct stat info{};
+    if(::fstat(fd, &info) != 0) {
+        const int err = errno;
+        ::close(fd);
+        throw std::runtime_error{fmt::format("Failed to read the size of {}: {}", path.c_str(), std::strerror(err))};
+    }
+
+    this->m_size = static_cast<std::size_t>(info.st_size);
+    //An empty file cannot be mapped, but has no contents to read either
+    if(this->m_size != 0) {
+        void *data = ::mmap(nullptr, this->m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(data == MAP_FAILED) {
+            const int err = errno;
+            ::close(fd);
+            throw std::runtime_error{fmt::format("Failed to map {}: {}", path.c_str(), std::strerror(err))};
+        }
+        this->m_data = static_cast<std::byte const*>(data);
+    }
+    //The mapping stays valid after the descriptor is closed
+    ::close(fd);
+#else
+    std::ifstream file{path, std::ios::binary | std::ios::ate};
+    if(!file) {
+        throw std::runtime_error{fmt::format("Failed to open {}", path.string())};
+    }
+    this->m_buf.resize(static_cast<std::size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(this->m_buf.data()), static_cast<std::streamsize>(this->m_buf.size()));
+    this->m_data = this->m_buf.data();
+    this->m_size = this->m_buf.size();
+#endif
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept :
+    m_data{std::exchange(other.m_data, nullptr)},
+    m_size{std::exchange(other.m_size, 0)},
+    m_buf{std::move(other.m_buf)} {}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if(this != &other) {
+        this->release();
+        this->m_data = std::exchange(other.m_data, nullptr);
+        this->m_size = std::exchange(other.m_size, 0);
+        this->m_buf = std::move(other.m_buf);
+    }
+    return *this;
+}
+
+MappedFile::~MappedFile() {
+    this->release();
+}
+
+void MappedFile::release() noexcept {
+#if defined(MAPPED_FILE_MMAP)
+    if(this->m_data != nullptr) {
+        ::munmap(const_cast<std::byte*>(this->m_data), this->m_size);
+    }
+#endif
+    this->m_data = nullptr;
+    this->m_size = 0;
+    this->m_buf.clear();
+}
+
+TEST_CASE("MappedFile") {
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "e1280_mapped_test.bin";
+    {
+        std::ofstream out{path, std::ios::binary};
+        out << "mapped contents";
+    }
+
+    MappedFile mapped{path};
+    const std::span<const std::byte> bytes = mapped.bytes();
+    CHECK_EQ(std::string_view{reinterpret_cast<const char*>(bytes.data()), bytes.size()}, "mapped contents");
+
+    MappedFile moved{std::move(mapped)};
+    CHECK(mapped.bytes().empty());
+    CHECK_EQ(moved.bytes().size(), 15);
+
+    {
+        std::ofstream out{path, std::ios::binary | std::ios::trunc};
+    }
+    CHECK(MappedFile{path}.bytes().empty());
+
+    std::filesystem::remove(path);
+    CHECK_THROWS_AS(MappedFile{path}, std::runtime_error);
+}
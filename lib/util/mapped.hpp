@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <span>
+#include <vector>
+
+/**
+ * \brief A whole file mapped read-only into memory, so that its contents can be read in place without being
+ * copied into a buffer first. On platforms without `mmap` the file is read into an owned buffer instead
+ */
+class MappedFile {
+public:
+    /**
+     * \brief Map the file at the given path
+     * \throws std::runtime_error if the file cannot be opened or mapped
+     */
+    explicit MappedFile(std::filesystem::path const& path);
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    MappedFile(MappedFile const&) = delete;
+    MappedFile& operator=(MappedFile const&) = delete;
+
+    ~MappedFile();
+
+    /** \brief Get the contents of the file, valid for as long as this mapping is alive */
+    inline std::span<const std::byte> bytes() const noexcept { return std::span<const std::byte>{this->m_data, this->m_size}; }
+private:
+    std::byte const *m_data{nullptr};
+    std::size_t m_size{0};
+    /** \brief Contents of the file when it could not be mapped, `m_data` points into this buffer */
+    std::vector<std::byte> m_buf{};
+
+    /** \brief Unmap the file if it was mapped */
+    void release() noexcept;
+};
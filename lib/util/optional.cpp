@@ -1,5 +1,6 @@
 #include "optional.hpp"
 #include <doctest.h>
+#include <stdexcept>
 
 struct NoneableMock {
     NoneableMock() = default;
@@ -28,6 +29,15 @@ TEST_CASE("Optional") {
         CHECK_THROWS(opt.unwrap_except(""));
         CHECK_EQ(opt.unwrap_or(5), 5);
     }
+    SUBCASE("unwrap_or_else_throw") {
+        int built = 0;
+        const auto make_error = [&built]() { built += 1; return std::runtime_error{"empty"}; };
+        CHECK_EQ(opt.unwrap_or_else_throw(make_error), 5);
+        CHECK_EQ(built, 0);
+        opt.reset();
+        CHECK_THROWS_AS(opt.unwrap_or_else_throw(make_error), std::runtime_error);
+        CHECK_EQ(built, 1);
+    }
     SUBCASE("has_value") {
         opt.emplace(12);
         CHECK(opt.has_value());
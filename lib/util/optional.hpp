@@ -193,6 +193,34 @@ public:
         else { throw std::forward<Exception>(e); }
     }
 
+    /**
+     * \brief Attempt to unwrap this `Optional`, or throw the exception returned by `make_error`. Unlike
+     * `unwrap_except`, the exception and its message are only built when there is no value, so this is preferred
+     * wherever the lookup is expected to succeed
+     * \param make_error Invoked with no arguments to create the exception to throw if this `Optional` does not
+     * contain a value
+     */
+    template<std::invocable MakeError>
+    constexpr inline T& unwrap_or_else_throw(MakeError&& make_error) & {
+        if(this->has_value()) { return static_cast<Optional&>(*this).unwrap_unchecked(); }
+        else { throw std::invoke(std::forward<MakeError>(make_error)); }
+    }
+    template<std::invocable MakeError>
+    constexpr inline T const& unwrap_or_else_throw(MakeError&& make_error) const& {
+        if(this->has_value()) { return static_cast<Optional const&>(*this).unwrap_unchecked(); }
+        else { throw std::invoke(std::forward<MakeError>(make_error)); }
+    }
+    template<std::invocable MakeError>
+    constexpr inline T&& unwrap_or_else_throw(MakeError&& make_error) && {
+        if(this->has_value()) { return std::move(*this).unwrap_unchecked(); }
+        else { throw std::invoke(std::forward<MakeError>(make_error)); }
+    }
+    template<std::invocable MakeError>
+    constexpr inline T const&& unwrap_or_else_throw(MakeError&& make_error) const&& {
+        if(this->has_value()) { return static_cast<Optional const&&>(std::move(*this)).unwrap_unchecked(); }
+        else { throw std::invoke(std::forward<MakeError>(make_error)); }
+    }
+
    static void from_json(Optional<T>& self, json const& json) requires(ser::JsonSerializable<T>) {
         if(json.is_null()) { self.reset(); }
         else {
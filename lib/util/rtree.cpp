@@ -0,0 +1,97 @@
+#include "rtree.hpp"
+#include <doctest.h>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+TEST_CASE("RTree") {
+    using Tree = RTree<std::uint32_t, 4>;
+    Tree tree{};
+    std::vector<Tree::Box> boxes{};
+    std::mt19937 rng{1280};
+    std::uniform_real_distribution<float> coord{0.f, 100.f};
+    std::uniform_real_distribution<float> extent{0.f, 5.f};
+    for(std::uint32_t i = 0; i < 500; ++i) {
+        const float x = coord(rng);
+        const float y = coord(rng);
+        boxes.push_back(Tree::Box{{x, y}, {x + extent(rng), y + extent(rng)}});
+        tree.insert(boxes.back(), i);
+    }
+    std::vector<bool> present(boxes.size(), true);
+
+    auto sorted = [](std::vector<std::uint32_t> vals) { std::sort(vals.begin(), vals.end()); return vals; };
+    auto check_queries = [&]() {
+        const Tree::Box area{{20.f, 30.f}, {45.f, 50.f}};
+        std::vector<std::uint32_t> intersecting{}, contained{}, at{};
+        std::vector<std::uint32_t> expect_intersecting{}, expect_contained{}, expect_at{};
+        tree.query(area, [&](std::uint32_t val) { intersecting.push_back(val); });
+        tree.contained(area, [&](std::uint32_t val) { contained.push_back(val); });
+        tree.query(33.f, 41.f, [&](std::uint32_t val) { at.push_back(val); });
+        for(std::uint32_t i = 0; i < boxes.size(); ++i) {
+            if(!present[i]) { continue; }
+            if(area.intersects(boxes[i])) { expect_intersecting.push_back(i); }
+            if(area.contains(boxes[i])) { expect_contained.push_back(i); }
+            if(boxes[i].contains(33.f, 41.f)) { expect_at.push_back(i); }
+        }
+        CHECK_EQ(sorted(intersecting), expect_intersecting);
+        CHECK_EQ(sorted(contained), expect_contained);
+        CHECK_EQ(sorted(at), expect_at);
+    };
+
+    CHECK_EQ(tree.size(), 500);
+    check_queries();
+
+    SUBCASE("remove") {
+        for(std::uint32_t i = 0; i < boxes.size(); i += 3) {
+            CHECK(tree.remove(boxes[i], i));
+            present[i] = false;
+        }
+        CHECK_FALSE_MESSAGE(tree.remove(boxes[0], 0), "A removed value was removed a second time");
+        CHECK_FALSE(tree.remove(boxes[2], 1));
+        CHECK_EQ(tree.size(), 333);
+        check_queries();
+
+        for(std::uint32_t i = 0; i < boxes.size(); ++i) {
+            if(present[i]) { CHECK(tree.remove(boxes[i], i)); }
+        }
+        CHECK(tree.empty());
+        CHECK_FALSE(tree.nearest(0.f, 0.f).has_value());
+        tree.insert(Tree::Box::point(1.f, 1.f), 7);
+        CHECK_EQ(tree.nearest(50.f, 50.f), 7u);
+    }
+    SUBCASE("load") {
+        std::vector<std::pair<Tree::Box, std::uint32_t>> entries{};
+        for(std::uint32_t i = 0; i < boxes.size(); ++i) {
+            entries.emplace_back(boxes[i], i);
+        }
+        tree.load(entries);
+        CHECK_EQ(tree.size(), 500);
+        check_queries();
+        for(std::uint32_t i = 0; i < boxes.size(); i += 2) {
+            CHECK(tree.remove(boxes[i], i));
+            present[i] = false;
+        }
+        check_queries();
+        tree.load({});
+        CHECK(tree.empty());
+        tree.load({{Tree::Box::point(2.f, 2.f), 1}, {Tree::Box::point(4.f, 4.f), 2}});
+        CHECK_EQ(tree.nearest(5.f, 5.f), 2u);
+    }
+    SUBCASE("nearest") {
+        std::vector<float> dists{};
+        tree.nearest(50.f, 50.f, [&](std::uint32_t val, float dist) {
+            CHECK_EQ(dist, std::sqrt(boxes[val].distance2(50.f, 50.f)));
+            dists.push_back(dist);
+            return dists.size() < 20;
+        });
+        CHECK_EQ(dists.size(), 20);
+        CHECK_MESSAGE(std::is_sorted(dists.begin(), dists.end()), "Nearest neighbours were not visited in order of distance");
+
+        std::uint32_t closest = 0;
+        for(std::uint32_t i = 1; i < boxes.size(); ++i) {
+            if(boxes[i].distance2(50.f, 50.f) < boxes[closest].distance2(50.f, 50.f)) { closest = i; }
+        }
+        CHECK_EQ(tree.nearest(50.f, 50.f), closest);
+    }
+}
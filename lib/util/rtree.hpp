@@ -0,0 +1,548 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <concepts>
+#include <cstdint>
+#include <limits>
+#include <queue>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "freelist.hpp"
+#include "optional.hpp"
+
+/**
+ * \brief R-tree mapping axis-aligned rectangles to values, answering point, rectangle, and nearest-neighbour
+ * queries by descending only into the subtrees whose bounds can hold a match, so queries on a tree of `n`
+ * values take time logarithmic in `n` plus the number of results.
+ *
+ * Overflowing nodes are divided with Guttman's quadratic split, and nodes that underflow on removal are
+ * dissolved and their values inserted again.
+ * \tparam T Type of value stored with each rectangle, copied freely so it should be a small handle
+ * \tparam MAX_ENTRIES Maximum number of children of each node
+ */
+template<typename T, std::size_t MAX_ENTRIES = 16>
+requires(std::is_trivially_copyable_v<T> && std::equality_comparable<T> && MAX_ENTRIES >= 4)
+class RTree {
+public:
+    using Scalar = float;
+    using size_type = std::uint32_t;
+
+    /** \brief A closed axis-aligned rectangle, `min` must not be greater than `max` on either axis */
+    struct Box {
+        std::array<Scalar, 2> min;
+        std::array<Scalar, 2> max;
+
+        /** \brief Create a zero-size box at the given point */
+        static constexpr inline Box point(Scalar x, Scalar y) noexcept { return Box{{x, y}, {x, y}}; }
+
+        constexpr inline bool operator==(Box const& other) const noexcept = default;
+
+        /** \brief Check if the given point lies inside or on the edge of this box */
+        constexpr inline bool contains(Scalar x, Scalar y) const noexcept {
+            return this->min[0] <= x && x <= this->max[0] && this->min[1] <= y && y <= this->max[1];
+        }
+        /** \brief Check if the given box lies entirely inside this box */
+        constexpr inline bool contains(Box const& other) const noexcept {
+            return this->min[0] <= other.min[0] && other.max[0] <= this->max[0] &&
+                this->min[1] <= other.min[1] && other.max[1] <= this->max[1];
+        }
+        /** \brief Check if this box shares at least one point with the given box */
+        constexpr inline bool intersects(Box const& other) const noexcept {
+            return this->min[0] <= other.max[0] && other.min[0] <= this->max[0] &&
+                this->min[1] <= other.max[1] && other.min[1] <= this->max[1];
+        }
+        /** \brief Get the smallest box containing both this box and the given box */
+        constexpr inline Box merged(Box const& other) const noexcept {
+            return Box{
+                {std::min(this->min[0], other.min[0]), std::min(this->min[1], other.min[1])},
+                {std::max(this->max[0], other.max[0]), std::max(this->max[1], other.max[1])}
+            };
+        }
+        constexpr inline Scalar area() const noexcept { return (this->max[0] - this->min[0]) * (this->max[1] - this->min[1]); }
+        /** \brief Get the squared distance from the given point to the nearest point of this box, 0 if inside */
+        constexpr inline Scalar distance2(Scalar x, Scalar y) const noexcept {
+            const Scalar dx = std::max({this->min[0] - x, Scalar{0}, x - this->max[0]});
+            const Scalar dy = std::max({this->min[1] - y, Scalar{0}, y - this->max[1]});
+            return dx * dx + dy * dy;
+        }
+    };
+
+    /** \brief Minimum number of children of every node other than the root */
+    static constexpr const std::size_t MIN_ENTRIES = std::max<std::size_t>(2, MAX_ENTRIES * 2 / 5);
+
+    /** \brief Create an empty tree */
+    RTree() { this->m_root = this->m_leaves.emplace(); }
+
+    /** \brief Get the number of values stored in this tree */
+    inline constexpr std::size_t size() const noexcept { return this->m_size; }
+    inline constexpr bool empty() const noexcept { return this->m_size == 0; }
+
+    /** \brief Remove every value from this tree */
+    void clear() {
+        this->m_leaves = FreeList<Leaf>{};
+        this->m_branches = FreeList<Branch>{};
+        this->m_root = this->m_leaves.emplace();
+        this->m_height = 0;
+        this->m_size = 0;
+    }
+
+    /**
+     * \brief Replace the contents of this tree with the given values, building the whole tree at once with
+     * Sort-Tile-Recursive packing. The values are sorted into vertical slices by the x coordinate of their
+     * centers and each slice is sorted by y and cut into full leaves, then the same is done to the leaves to
+     * build each level above. The result is shallower and overlaps less than a tree built by inserting the
+     * values one by one, and takes O(n log n) time
+     */
+    void load(std::vector<std::pair<Box, T>> entries) {
+        this->clear();
+        if(entries.empty()) {
+            return;
+        }
+        this->m_size = entries.size();
+        this->m_leaves.erase(this->m_root);
+        auto level = pack(this->m_leaves, std::move(entries));
+        while(level.size() > 1) {
+            level = pack(this->m_branches, std::move(level));
+            this->m_height += 1;
+        }
+        this->m_root = level.front().second;
+    }
+
+    /** \brief Add a value with the given bounds, the same value may be stored more than once */
+    void insert(Box const& box, T const& val) {
+        this->place(box, val);
+        this->m_size += 1;
+    }
+
+    /**
+     * \brief Remove one copy of a value from this tree
+     * \param box The bounds that the value was inserted with, used to find the value
+     * \return false if the value was not found inside `box`
+     */
+    bool remove(Box const& box, T const& val) {
+        std::vector<std::pair<Box, T>> orphans{};
+        if(!this->remove(this->m_root, this->m_height, box, val, orphans)) {
+            return false;
+        }
+        this->m_size -= 1;
+        while(this->m_height > 0 && this->m_branches[this->m_root].len <= 1) {
+            const size_type root = this->m_root;
+            if(this->m_branches[root].len == 0) {
+                this->m_root = this->m_leaves.emplace();
+                this->m_height = 0;
+            } else {
+                this->m_root = this->m_branches[root].items[0];
+                this->m_height -= 1;
+            }
+            this->m_branches.erase(root);
+        }
+        for(const auto& [orphan_box, orphan] : orphans) {
+            this->place(orphan_box, orphan);
+        }
+        return true;
+    }
+
+    /** \brief Invoke `fn` with every value whose box shares at least one point with `box` */
+    template<typename F>
+    requires(std::invocable<F, T const&>)
+    inline void query(Box const& box, F&& fn) const {
+        this->search(this->m_root, this->m_height, [&box](Box const& b) { return box.intersects(b); }, fn);
+    }
+
+    /** \brief Invoke `fn` with every value whose box contains the given point */
+    template<typename F>
+    requires(std::invocable<F, T const&>)
+    inline void query(Scalar x, Scalar y, F&& fn) const {
+        this->search(this->m_root, this->m_height, [x, y](Box const& b) { return b.contains(x, y); }, fn);
+    }
+
+    /** \brief Invoke `fn` with every value whose box lies entirely inside `box` */
+    template<typename F>
+    requires(std::invocable<F, T const&>)
+    void contained(Box const& box, F&& fn) const {
+        this->search(
+            this->m_root,
+            this->m_height,
+            [&box](Box const& b) { return box.intersects(b); },
+            [&box, &fn](T const& val, Box const& b) { if(box.contains(b)) { fn(val); } }
+        );
+    }
+
+    /**
+     * \brief Visit values in order of increasing distance from the given point to their boxes, until `fn` returns
+     * false. Only as much of the tree is searched as is needed to order the visited values.
+     * The tree must not be modified from `fn`
+     * \param fn Invoked with each value and the distance to its box, which is 0 when the box contains the point
+     */
+    template<typename F>
+    requires(std::is_invocable_r_v<bool, F, T const&, Scalar>)
+    void nearest(Scalar x, Scalar y, F&& fn) const {
+        //Entries are either whole nodes, or single values identified by the leaf holding them and their slot
+        struct Candidate {
+            Scalar dist2;
+            size_type node;
+            std::size_t level;
+            size_type slot;
+
+            constexpr inline bool operator>(Candidate const& other) const noexcept { return this->dist2 > other.dist2; }
+        };
+        std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> queue{};
+        queue.push(Candidate{0, this->m_root, this->m_height, NO_SLOT});
+        while(!queue.empty()) {
+            const Candidate next = queue.top();
+            queue.pop();
+            if(next.slot != NO_SLOT) {
+                if(!fn(this->m_leaves[next.node].items[next.slot], std::sqrt(next.dist2))) {
+                    return;
+                }
+            } else if(next.level == 0) {
+                const Leaf& leaf = this->m_leaves[next.node];
+                for(size_type i = 0; i < leaf.len; ++i) {
+                    queue.push(Candidate{leaf.boxes[i].distance2(x, y), next.node, 0, i});
+                }
+            } else {
+                const Branch& branch = this->m_branches[next.node];
+                for(size_type i = 0; i < branch.len; ++i) {
+                    queue.push(Candidate{branch.boxes[i].distance2(x, y), branch.items[i], next.level - 1, NO_SLOT});
+                }
+            }
+        }
+    }
+
+    /** \brief Get the value with the box nearest to the given point, or an empty `Optional` if the tree is empty */
+    Optional<T> nearest(Scalar x, Scalar y) const {
+        Optional<T> found{};
+        this->nearest(x, y, [&found](T const& val, Scalar) { found = val; return false; });
+        return found;
+    }
+private:
+    /** \brief A node holding up to `MAX_ENTRIES` children, each with the bounds of everything under it */
+    template<typename P>
+    struct Node {
+        size_type len{0};
+        std::array<Box, MAX_ENTRIES> boxes;
+        std::array<P, MAX_ENTRIES> items;
+
+        /** \brief Get the bounds of every child of this node, which must not be empty */
+        inline Box bounds() const noexcept {
+            Box box = this->boxes[0];
+            for(size_type i = 1; i < this->len; ++i) {
+                box = box.merged(this->boxes[i]);
+            }
+            return box;
+        }
+        /** \brief Remove the child in the given slot, moving the last child into its place */
+        inline void take(size_type slot) noexcept {
+            this->len -= 1;
+            this->boxes[slot] = this->boxes[this->len];
+            this->items[slot] = this->items[this->len];
+        }
+    };
+    /** \brief A node at level 0, holding values */
+    using Leaf = Node<T>;
+    /** \brief A node above level 0, holding indices of nodes one level below */
+    using Branch = Node<size_type>;
+
+    static constexpr const size_type NO_SLOT = std::numeric_limits<size_type>::max();
+
+    FreeList<Leaf> m_leaves{};
+    FreeList<Branch> m_branches{};
+    /** \brief Index of the root node, which is a leaf when `m_height` is 0 and a branch otherwise */
+    size_type m_root;
+    /** \brief Level of the root node, leaves are at level 0 */
+    std::size_t m_height{0};
+    std::size_t m_size{0};
+
+    inline Box bounds(size_type node, std::size_t level) const noexcept {
+        return level == 0 ? this->m_leaves[node].bounds() : this->m_branches[node].bounds();
+    }
+
+    /** \brief Insert a value without counting it, growing a new root if the old one splits */
+    void place(Box const& box, T const& val) {
+        auto sibling = this->place(this->m_root, this->m_height, box, val);
+        if(sibling.has_value()) {
+            const size_type old = this->m_root;
+            const Box old_box = this->bounds(old, this->m_height);
+            this->m_root = this->m_branches.emplace();
+            Branch& root = this->m_branches[this->m_root];
+            root.len = 2;
+            root.boxes[0] = old_box;
+            root.items[0] = old;
+            root.boxes[1] = sibling.unwrap_unchecked().first;
+            root.items[1] = sibling.unwrap_unchecked().second;
+            this->m_height += 1;
+        }
+    }
+
+    /**
+     * \brief Insert a value under the given node
+     * \return The bounds and index of a new node at the same level if the given node had to be split
+     */
+    Optional<std::pair<Box, size_type>> place(size_type node, std::size_t level, Box const& box, T const& val) {
+        if(level == 0) {
+            return add(this->m_leaves, node, box, val);
+        }
+
+        //Descend into the child whose bounds grow the least, preferring smaller children on ties
+        size_type best = 0;
+        {
+            const Branch& branch = this->m_branches[node];
+            Scalar best_growth = std::numeric_limits<Scalar>::infinity();
+            Scalar best_area = std::numeric_limits<Scalar>::infinity();
+            for(size_type i = 0; i < branch.len; ++i) {
+                const Scalar area = branch.boxes[i].area();
+                const Scalar growth = branch.boxes[i].merged(box).area() - area;
+                if(growth < best_growth || (growth == best_growth && area < best_area)) {
+                    best = i;
+                    best_growth = growth;
+                    best_area = area;
+                }
+            }
+        }
+
+        const size_type child = this->m_branches[node].items[best];
+        auto sibling = this->place(child, level - 1, box, val);
+        //Node storage may have grown during the recursive call, so the branch is fetched again
+        Branch& branch = this->m_branches[node];
+        if(!sibling.has_value()) {
+            branch.boxes[best] = branch.boxes[best].merged(box);
+            return {};
+        }
+        branch.boxes[best] = this->bounds(child, level - 1);
+        return add(this->m_branches, node, sibling.unwrap_unchecked().first, sibling.unwrap_unchecked().second);
+    }
+
+    /**
+     * \brief Add a child to a node, splitting the node if it is full
+     * \return The bounds and index of the new node if the node was split
+     */
+    template<typename P>
+    static Optional<std::pair<Box, size_type>> add(FreeList<Node<P>>& pool, size_type node, Box const& box, P const& item) {
+        if(pool[node].len < MAX_ENTRIES) {
+            Node<P>& target = pool[node];
+            target.boxes[target.len] = box;
+            target.items[target.len] = item;
+            target.len += 1;
+            return {};
+        }
+
+        std::array<Box, MAX_ENTRIES + 1> boxes;
+        std::array<P, MAX_ENTRIES + 1> items;
+        std::copy(pool[node].boxes.begin(), pool[node].boxes.end(), boxes.begin());
+        std::copy(pool[node].items.begin(), pool[node].items.end(), items.begin());
+        boxes[MAX_ENTRIES] = box;
+        items[MAX_ENTRIES] = item;
+
+        //Seed both halves with the pair of children that would waste the most area if kept together
+        std::size_t seed_a = 0;
+        std::size_t seed_b = 1;
+        Scalar worst = -std::numeric_limits<Scalar>::infinity();
+        for(std::size_t i = 0; i < boxes.size(); ++i) {
+            for(std::size_t j = i + 1; j < boxes.size(); ++j) {
+                const Scalar waste = boxes[i].merged(boxes[j]).area() - boxes[i].area() - boxes[j].area();
+                if(waste > worst) {
+                    worst = waste;
+                    seed_a = i;
+                    seed_b = j;
+                }
+            }
+        }
+
+        const size_type sibling = pool.emplace();
+        Node<P>& a = pool[node];
+        Node<P>& b = pool[sibling];
+        std::array<bool, MAX_ENTRIES + 1> assigned{};
+        a.len = 0;
+        auto assign = [&](Node<P>& half, Box& bounds, std::size_t i) {
+            half.boxes[half.len] = boxes[i];
+            half.items[half.len] = items[i];
+            half.len += 1;
+            bounds = bounds.merged(boxes[i]);
+            assigned[i] = true;
+        };
+        Box a_box = boxes[seed_a];
+        Box b_box = boxes[seed_b];
+        assign(a, a_box, seed_a);
+        assign(b, b_box, seed_b);
+
+        for(std::size_t remaining = boxes.size() - 2; remaining > 0; --remaining) {
+            //Once one half needs every remaining child to reach the minimum it takes them all
+            Node<P>& starved = a.len + remaining <= MIN_ENTRIES ? a : b;
+            if(starved.len + remaining <= MIN_ENTRIES) {
+                Box& bounds = &starved == &a ? a_box : b_box;
+                for(std::size_t i = 0; i < boxes.size(); ++i) {
+                    if(!assigned[i]) {
+                        assign(starved, bounds, i);
+                    }
+                }
+                break;
+            }
+
+            //Place the child with the strongest preference for one half first
+            std::size_t pick = 0;
+            Scalar pick_diff = -1;
+            Scalar pick_growth_a = 0;
+            Scalar pick_growth_b = 0;
+            for(std::size_t i = 0; i < boxes.size(); ++i) {
+                if(assigned[i]) {
+                    continue;
+                }
+                const Scalar growth_a = a_box.merged(boxes[i]).area() - a_box.area();
+                const Scalar growth_b = b_box.merged(boxes[i]).area() - b_box.area();
+                const Scalar diff = std::abs(growth_a - growth_b);
+                if(diff > pick_diff) {
+                    pick = i;
+                    pick_diff = diff;
+                    pick_growth_a = growth_a;
+                    pick_growth_b = growth_b;
+                }
+            }
+            const bool to_a = pick_growth_a != pick_growth_b ?
+                pick_growth_a < pick_growth_b :
+                (a_box.area() != b_box.area() ? a_box.area() < b_box.area() : a.len <= b.len);
+            if(to_a) {
+                assign(a, a_box, pick);
+            } else {
+                assign(b, b_box, pick);
+            }
+        }
+
+        return std::make_pair(b_box, sibling);
+    }
+
+    /**
+     * \brief Pack children into new nodes using one level of Sort-Tile-Recursive loading
+     * \return The bounds and index of every node created
+     */
+    template<typename P>
+    static std::vector<std::pair<Box, size_type>> pack(FreeList<Node<P>>& pool, std::vector<std::pair<Box, P>> entries) {
+        //Ties are broken on the other axis so that a row or column of aligned boxes cut by a slice boundary is
+        //split into two contiguous runs rather than interleaved between both slices
+        auto center = [](Box const& box, std::size_t axis) {
+            return std::make_pair(box.min[axis] + box.max[axis], box.min[1 - axis] + box.max[1 - axis]);
+        };
+        const std::size_t nodes = (entries.size() + MAX_ENTRIES - 1) / MAX_ENTRIES;
+        const std::size_t slices = static_cast<std::size_t>(std::ceil(std::sqrt(static_cast<double>(nodes))));
+        const std::size_t slice_len = slices * MAX_ENTRIES;
+
+        std::sort(entries.begin(), entries.end(), [&center](auto const& a, auto const& b) {
+            return center(a.first, 0) < center(b.first, 0);
+        });
+        //Slices hold whole nodes and are sorted independently of each other
+        for(std::size_t start = 0; start < entries.size(); start += slice_len) {
+            std::sort(
+                entries.begin() + start,
+                entries.begin() + std::min(start + slice_len, entries.size()),
+                [&center](auto const& a, auto const& b) { return center(a.first, 1) < center(b.first, 1); }
+            );
+        }
+
+        std::vector<std::pair<Box, size_type>> packed{};
+        packed.reserve(nodes);
+        for(std::size_t start = 0; start < entries.size();) {
+            std::size_t len = std::min(MAX_ENTRIES, entries.size() - start);
+            //Split the last two nodes evenly rather than leaving the last one underfull
+            const std::size_t rest = entries.size() - start - len;
+            if(rest != 0 && rest < MIN_ENTRIES) {
+                len = (len + rest + 1) / 2;
+            }
+            const size_type idx = pool.emplace();
+            Node<P>& node = pool[idx];
+            node.len = static_cast<size_type>(len);
+            for(std::size_t i = 0; i < len; ++i) {
+                node.boxes[i] = entries[start + i].first;
+                node.items[i] = entries[start + i].second;
+            }
+            packed.emplace_back(node.bounds(), idx);
+            start += len;
+        }
+        return packed;
+    }
+
+    /**
+     * \brief Remove a value from under the given node. Children left with too few entries are dissolved, with
+     * every value beneath them appended to `orphans` to be inserted again
+     * \return true if the value was found
+     */
+    bool remove(size_type node, std::size_t level, Box const& box, T const& val, std::vector<std::pair<Box, T>>& orphans) {
+        if(level == 0) {
+            Leaf& leaf = this->m_leaves[node];
+            for(size_type i = 0; i < leaf.len; ++i) {
+                if(leaf.items[i] == val && leaf.boxes[i].contains(box)) {
+                    leaf.take(i);
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        for(size_type i = 0; i < this->m_branches[node].len; ++i) {
+            const Branch& branch = this->m_branches[node];
+            if(!branch.boxes[i].contains(box)) {
+                continue;
+            }
+            const size_type child = branch.items[i];
+            if(!this->remove(child, level - 1, box, val, orphans)) {
+                continue;
+            }
+
+            const size_type len = level == 1 ? this->m_leaves[child].len : this->m_branches[child].len;
+            if(len < MIN_ENTRIES) {
+                this->dissolve(child, level - 1, orphans);
+                this->m_branches[node].take(i);
+            } else {
+                this->m_branches[node].boxes[i] = this->bounds(child, level - 1);
+            }
+            return true;
+        }
+        return false;
+    }
+
+    /** \brief Free a node and every node beneath it, appending their values to `orphans` */
+    void dissolve(size_type node, std::size_t level, std::vector<std::pair<Box, T>>& orphans) {
+        if(level == 0) {
+            const Leaf& leaf = this->m_leaves[node];
+            for(size_type i = 0; i < leaf.len; ++i) {
+                orphans.emplace_back(leaf.boxes[i], leaf.items[i]);
+            }
+            this->m_leaves.erase(node);
+            return;
+        }
+        const Branch& branch = this->m_branches[node];
+        for(size_type i = 0; i < branch.len; ++i) {
+            this->dissolve(branch.items[i], level - 1, orphans);
+        }
+        this->m_branches.erase(node);
+    }
+
+    /**
+     * \brief Invoke `fn` with the values under the given node whose boxes match `pred`, descending only into
+     * children whose bounds match `pred`
+     */
+    template<typename P, typename F>
+    void search(size_type node, std::size_t level, P const& pred, F&& fn) const {
+        if(level == 0) {
+            const Leaf& leaf = this->m_leaves[node];
+            for(size_type i = 0; i < leaf.len; ++i) {
+                if(pred(leaf.boxes[i])) {
+                    if constexpr(std::invocable<F&, T const&, Box const&>) {
+                        fn(leaf.items[i], leaf.boxes[i]);
+                    } else {
+                        fn(leaf.items[i]);
+                    }
+                }
+            }
+            return;
+        }
+        const Branch& branch = this->m_branches[node];
+        for(size_type i = 0; i < branch.len; ++i) {
+            if(pred(branch.boxes[i])) {
+                this->search(branch.items[i], level - 1, pred, fn);
+            }
+        }
+    }
+};
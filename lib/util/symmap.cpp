@@ -0,0 +1,21 @@
+#include "symmap.hpp"
+#include <doctest.h>
+#include <string>
+
+TEST_CASE("SymbolMap") {
+    std::vector<std::pair<Symbol, std::uint32_t>> entries{};
+    for(std::uint32_t i = 0; i < 48; ++i) {
+        entries.emplace_back(Symbol::intern("symmap.port" + std::to_string(i)), i);
+    }
+    SymbolMap<std::uint32_t> map{entries};
+    CHECK_EQ(map.size(), 48);
+    for(const auto& [key, val] : entries) {
+        CHECK(map.find(key) == val);
+    }
+    CHECK_FALSE(map.contains(Symbol::intern("symmap.missing")));
+    CHECK_FALSE(map.contains(Symbol{}));
+    CHECK_FALSE(SymbolMap<std::uint32_t>{}.contains(entries[0].first));
+
+    entries.push_back(entries[0]);
+    CHECK_THROWS(SymbolMap<std::uint32_t>{entries});
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "util/intern.hpp"
+#include "util/optional.hpp"
+
+/**
+ * \brief Immutable open-addressing hash table from interned `Symbol`s to small values, built once and then only
+ * read. Construction searches for a hash seed that places every key in its home slot, so that lookups are
+ * usually a multiply, a shift, and a single compare; if no such seed exists the table falls back to linear probing
+ * \tparam V Type of value stored, should be cheap to copy
+ */
+template<typename V>
+class SymbolMap {
+public:
+    using size_type = std::uint32_t;
+
+    /** \brief Create an empty map that contains no keys */
+    SymbolMap() = default;
+
+    /**
+     * \brief Build a map from the given list of key-value pairs
+     * \throws std::invalid_argument if the same key appears more than once
+     */
+    explicit SymbolMap(std::vector<std::pair<Symbol, V>> const& entries) : m_len{static_cast<size_type>(entries.size())} {
+        if(entries.empty()) {
+            return;
+        }
+        //Keep the load factor at or below 0.5 so that a collision-free seed is easy to find
+        std::size_t capacity = std::bit_ceil(entries.size() * 2);
+        for(std::uint32_t attempt = 0; attempt < MAX_SEEDS; ++attempt) {
+            //Products of odd numbers stay odd, keeping every seed a valid multiplicative hash
+            if(this->try_build(entries, capacity, GOLDEN * (2 * attempt + 1), true)) {
+                return;
+            }
+            //Grow the table once after half of the seeds fail, a sparser table is still cheap for small maps
+            if(attempt == MAX_SEEDS / 2) {
+                capacity *= 2;
+            }
+        }
+        this->try_build(entries, capacity, GOLDEN, false);
+    }
+
+    /**
+     * \brief Look up the value associated with the given key
+     * \return An empty `Optional` if `key` is not present in this map
+     */
+    inline constexpr Optional<V> find(Symbol key) const noexcept {
+        if(this->m_slots.empty() || key.is_none()) {
+            return {};
+        }
+        std::size_t pos = this->home(key);
+        while(true) {
+            const Entry& entry = this->m_slots[pos];
+            if(entry.key == key) {
+                return entry.val;
+            } else if(entry.key.is_none()) {
+                return {};
+            }
+            pos = (pos + 1) & this->m_mask;
+        }
+    }
+
+    /** \brief Check if the given key is present in this map */
+    inline constexpr bool contains(Symbol key) const noexcept { return this->find(key).has_value(); }
+
+    /** \brief Get the number of keys stored in this map */
+    inline constexpr size_type size() const noexcept { return this->m_len; }
+
+    /** \brief Check if every key in this map is stored in its home slot */
+    inline constexpr bool is_perfect() const noexcept { return this->m_perfect; }
+private:
+    /** \brief A single slot of the table, empty slots contain the invalid `Symbol` */
+    struct Entry {
+        Symbol key{};
+        V val{};
+    };
+
+    /** \brief Number of hash seeds tried before falling back to linear probing */
+    static constexpr const std::uint32_t MAX_SEEDS = 64;
+    /** \brief 2^32 divided by the golden ratio, the base multiplier used for Fibonacci hashing */
+    static constexpr const std::uint32_t GOLDEN = 0x9E3779B1u;
+
+    std::vector<Entry> m_slots{};
+    std::uint32_t m_seed{0};
+    std::uint32_t m_shift{0};
+    std::size_t m_mask{0};
+    size_type m_len{0};
+    bool m_perfect{false};
+
+    /** \brief Get the slot that the given key should occupy if there are no collisions */
+    inline constexpr std::size_t home(Symbol key) const noexcept {
+        return static_cast<std::uint32_t>(key.index() * this->m_seed) >> this->m_shift;
+    }
+
+    /**
+     * \brief Attempt to fill the table using the given capacity and seed
+     * \param perfect If true, fail instead of probing when two keys share a home slot
+     * \return false if `perfect` was requested and a collision occurred
+     */
+    bool try_build(std::vector<std::pair<Symbol, V>> const& entries, std::size_t capacity, std::uint32_t seed, bool perfect) {
+        this->m_slots.assign(capacity, Entry{});
+        this->m_mask = capacity - 1;
+        this->m_seed = seed;
+        this->m_shift = 32 - std::countr_zero(capacity);
+        this->m_perfect = true;
+        for(const auto& [key, val] : entries) {
+            if(key.is_none()) {
+                throw std::invalid_argument{"Cannot store an invalid Symbol in a SymbolMap"};
+            }
+            std::size_t pos = this->home(key);
+            while(!this->m_slots[pos].key.is_none()) {
+                if(this->m_slots[pos].key == key) {
+                    throw std::invalid_argument{"Duplicate key in SymbolMap"};
+                }
+                if(perfect) {
+                    return false;
+                }
+                this->m_perfect = false;
+                pos = (pos + 1) & this->m_mask;
+            }
+            this->m_slots[pos] = Entry{key, val};
+        }
+        return true;
+    }
+};
@@ -2,7 +2,7 @@
 
 std::filesystem::path ConnectorLoader::DIR = "./assets/connectors";
 
-Ref<Connector> ConnectorLoader::load(std::string_view id, const json &json_val, LazyResourceStore &store) {
+Ref<Connector> ConnectorLoader::load(Symbol id, const json &json_val, LazyResourceStore &store) {
     (void)store;
     Ref<Connector> component{new Connector{}};
     
@@ -18,16 +18,17 @@ public:
     Connector() = default;
     
     /** \brief Get the string ID of this connector type */
-    inline constexpr const std::string_view id() const { return this->m_id; }
+    inline const std::string_view id() const { return this->m_id.str(); }
+    /** \brief Get the interned ID of this connector type */
+    inline constexpr Symbol symbol() const noexcept { return this->m_id; }
     inline constexpr Optional<std::reference_wrapper<const PurchaseData>> purchase_data() const { return this->m_purchasedata; }
     inline constexpr std::string const& name() const noexcept { return this->m_name; }
 private:
     /** 
-     * \brief User-created ID string of this connector, 
-     * shared with the SharedResources map key and guranteed to be
-     * NULL-terminated
+     * \brief User-created ID of this connector, 
+     * shared with the SharedResources map key
      */
-    std::string_view m_id;
+    Symbol m_id;
     
     /** 
      * \brief Name of this connector type
@@ -42,7 +43,7 @@ private:
 
 class ConnectorLoader : public LazyResourceLoader<Connector> {
 public:
-    Ref<Connector> load(std::string_view id, const json& json_val, LazyResourceStore& store) override;
+    Ref<Connector> load(Symbol id, const json& json_val, LazyResourceStore& store) override;
     std::filesystem::path const& dir() const noexcept override { return DIR; }
 
 private: